@@ -0,0 +1,122 @@
+#pragma once
+#ifndef XED_BENCH_HPP
+#define XED_BENCH_HPP 1
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// tiny self contained harness so the benchmarks build without any dependency.
+// every case is timed in batches until min_time has passed and reported as
+// nanoseconds per operation, as csv (default) or json.
+namespace xed_bench {
+
+template<typename T>
+inline void do_not_optimize(T& value) noexcept {
+#if defined(__GNUC__)
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct result {
+    std::string name;
+    std::string impl;
+    std::size_t length;
+    std::uint64_t iterations;
+    double ns_per_op;
+};
+
+class runner {
+public:
+    enum class format { csv, json };
+
+    runner(int argc, char** argv) {
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--json") == 0)
+                format_ = format::json;
+            else if (std::strcmp(argv[i], "--csv") == 0)
+                format_ = format::csv;
+            else if (std::strncmp(argv[i], "--filter=", 9) == 0)
+                filter_ = argv[i] + 9;
+            else if (std::strncmp(argv[i], "--min-time-ms=", 14) == 0)
+                min_time_ = std::chrono::milliseconds(std::atoi(argv[i] + 14));
+        }
+    }
+
+    ~runner() {
+        print();
+    }
+
+    // `fn` runs one operation per call.
+    template<typename Fn>
+    void run(const char* name, const char* impl, std::size_t length, Fn&& fn) {
+        if (!filter_.empty() && std::string(name).find(filter_) == std::string::npos)
+            return;
+
+        using clock = std::chrono::steady_clock;
+        std::uint64_t batch = 1;
+        std::uint64_t iterations = 0;
+        clock::duration elapsed{};
+
+        fn(); // warm up
+        while (elapsed < min_time_) {
+            const auto start = clock::now();
+            for (std::uint64_t i = 0; i < batch; i++)
+                fn();
+            elapsed += clock::now() - start;
+            iterations += batch;
+            if (batch < (std::uint64_t(1) << 30))
+                batch *= 2;
+        }
+
+        const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        results_.push_back({ name, impl, length, iterations, ns / static_cast<double>(iterations) });
+    }
+
+    // for cases that time themselves, e.g. the multi threaded ones.
+    void record(const char* name, const char* impl, std::size_t length, std::uint64_t iterations, double ns_per_op) {
+        if (!filter_.empty() && std::string(name).find(filter_) == std::string::npos)
+            return;
+
+        results_.push_back({ name, impl, length, iterations, ns_per_op });
+    }
+
+    inline bool enabled(const char* name) const {
+        return filter_.empty() || std::string(name).find(filter_) != std::string::npos;
+    }
+private:
+    void print() const {
+        if (format_ == format::csv) {
+            std::printf("benchmark,impl,length,iterations,ns_per_op\n");
+            for (const auto& r : results_)
+                std::printf("%s,%s,%zu,%llu,%.3f\n", r.name.c_str(), r.impl.c_str(), r.length,
+                    static_cast<unsigned long long>(r.iterations), r.ns_per_op);
+            return;
+        }
+
+        std::printf("{\n  \"benchmarks\": [\n");
+        for (std::size_t i = 0; i < results_.size(); i++) {
+            const auto& r = results_[i];
+            std::printf("    {\"name\": \"%s\", \"impl\": \"%s\", \"length\": %zu, \"iterations\": %llu, \"ns_per_op\": %.3f}%s\n",
+                r.name.c_str(), r.impl.c_str(), r.length, static_cast<unsigned long long>(r.iterations), r.ns_per_op,
+                i + 1 == results_.size() ? "" : ",");
+        }
+        std::printf("  ]\n}\n");
+    }
+private:
+    format format_ = format::csv;
+    std::string filter_;
+    std::chrono::steady_clock::duration min_time_ = std::chrono::milliseconds(20);
+    std::vector<result> results_;
+};
+
+} // namespace xed_bench
+
+#endif // !XED_BENCH_HPP
@@ -0,0 +1,94 @@
+#include <strings.h>
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "case_insensitive.hpp"
+
+// matching header names regardless of case: iequals against lower casing both sides
+// into new strings and against strncasecmp, and ifind against lower casing the text
+// before a find. the length is the length of the strings compared or searched.
+// usage: xed_case_insensitive_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::string make_text(std::size_t length) {
+    const char* words[] = { "Content", "type", "ACCEPT", "encoding", "X", "Forwarded", "for", "-" };
+    std::string text;
+    std::uint32_t seed = 0x9e3779b9u;
+    while (text.size() < length) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        text += words[seed % 8];
+    }
+    text.resize(length);
+    return text;
+}
+
+std::string flip_case(std::string text) {
+    for (auto& ch : text) {
+        if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'))
+            ch ^= 0x20;
+    }
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 4, 14, 32, 256, 4096 };
+    for (const auto length : lengths) {
+        const auto a = make_text(length);
+        const auto b = flip_case(a);
+        const xed::string_view va(a.data(), a.size());
+        const xed::string_view vb(b.data(), b.size());
+        const xed::string sa(va.data(), va.length());
+        const xed::string sb(vb.data(), vb.length());
+
+        runner.run("iequals", "xed", length, [&] {
+            auto equal = xed::iequals(va, vb);
+            xed_bench::do_not_optimize(equal);
+        });
+
+        runner.run("iequals", "to_lowercase", length, [&] {
+            auto equal = xed::to_lowercase(sa) == xed::string_view(xed::to_lowercase(sb));
+            xed_bench::do_not_optimize(equal);
+        });
+
+        runner.run("iequals", "strncasecmp", length, [&] {
+            auto equal = a.size() == b.size() && ::strncasecmp(a.data(), b.data(), a.size()) == 0;
+            xed_bench::do_not_optimize(equal);
+        });
+
+        runner.run("ihash", "xed", length, [&] {
+            auto hash = xed::ihash_string(vb);
+            xed_bench::do_not_optimize(hash);
+        });
+
+        runner.run("ihash", "to_lowercase", length, [&] {
+            auto hash = xed::hash_string(xed::string_view(xed::to_lowercase(sb)));
+            xed_bench::do_not_optimize(hash);
+        });
+
+        if (length < 256)
+            continue;
+
+        // a needle that is only at the very end.
+        auto text = make_text(length);
+        text.replace(text.size() - 12, 12, "NEEDLE-value");
+        const xed::string haystack(text.data(), text.size());
+
+        runner.run("ifind", "xed", length, [&] {
+            auto pos = xed::ifind(haystack, "needle-VALUE");
+            xed_bench::do_not_optimize(pos);
+        });
+
+        runner.run("ifind", "to_lowercase", length, [&] {
+            auto pos = xed::to_lowercase(haystack).find(xed::string_view("needle-value"));
+            xed_bench::do_not_optimize(pos);
+        });
+    }
+    return 0;
+}
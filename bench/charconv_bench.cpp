@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "charconv.hpp"
+
+// writing numbers into a string and reading them back out: append_int and append_float
+// against snprintf and std::to_string, parse_int and parse_float against strtoll and
+// strtod. the length is how many numbers go through per run.
+// usage: xed_charconv_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::vector<std::int64_t> make_ints(std::size_t count) {
+    std::vector<std::int64_t> values;
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (std::size_t i = 0; i < count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        // all digit counts, about as many negative as positive.
+        const auto value = static_cast<std::int64_t>(seed >> (seed % 64));
+        values.push_back(seed & 1 ? -value : value);
+    }
+    return values;
+}
+
+std::vector<double> make_doubles(std::size_t count) {
+    std::vector<double> values;
+    std::uint64_t seed = 0x2545f4914f6cdd1dull;
+    for (std::size_t i = 0; i < count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        values.push_back(static_cast<double>(seed >> 11) / double(1ull << 53) * 1000.0);
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 64, 4096, 1 << 16 };
+    for (const auto length : lengths) {
+        const auto ints = make_ints(length);
+        const auto doubles = make_doubles(length);
+
+        xed::string out;
+        runner.run("format_int", "xed", length, [&] {
+            out.clear();
+            for (const auto value : ints) {
+                xed::append_int(out, value);
+                out += ' ';
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("format_int", "snprintf", length, [&] {
+            out.clear();
+            char buffer[32];
+            for (const auto value : ints) {
+                const auto written = std::snprintf(buffer, sizeof(buffer), "%lld ", static_cast<long long>(value));
+                out += xed::string_view(buffer, static_cast<std::size_t>(written));
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("format_int", "to_string", length, [&] {
+            out.clear();
+            for (const auto value : ints) {
+                const auto text = std::to_string(value);
+                out += xed::string_view(text.data(), text.size());
+                out += ' ';
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("format_double", "xed", length, [&] {
+            out.clear();
+            for (const auto value : doubles) {
+                xed::append_float(out, value);
+                out += ' ';
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("format_double", "snprintf", length, [&] {
+            out.clear();
+            char buffer[40];
+            for (const auto value : doubles) {
+                const auto written = std::snprintf(buffer, sizeof(buffer), "%.17g ", value);
+                out += xed::string_view(buffer, static_cast<std::size_t>(written));
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        xed::string int_text;
+        for (const auto value : ints) {
+            xed::append_int(int_text, value);
+            int_text += ' ';
+        }
+        xed::string double_text;
+        for (const auto value : doubles) {
+            xed::append_float(double_text, value);
+            double_text += ' ';
+        }
+
+        runner.run("parse_int", "xed", length, [&] {
+            std::int64_t sum = 0;
+            const auto text = int_text.data();
+            const auto text_length = int_text.length();
+            for (std::size_t pos = 0; pos < text_length;) {
+                std::int64_t value = 0;
+                const auto result = xed::parse_int(xed::string_view(text + pos, text_length - pos), value);
+                sum += value;
+                pos += result.length + 1;
+            }
+            xed_bench::do_not_optimize(sum);
+        });
+
+        runner.run("parse_int", "strtoll", length, [&] {
+            std::int64_t sum = 0;
+            const char* text = int_text.data();
+            const char* end = text + int_text.length();
+            while (text != end) {
+                char* next = nullptr;
+                sum += std::strtoll(text, &next, 10);
+                text = next + 1;
+            }
+            xed_bench::do_not_optimize(sum);
+        });
+
+        runner.run("parse_double", "xed", length, [&] {
+            double sum = 0;
+            const auto text = double_text.data();
+            const auto text_length = double_text.length();
+            for (std::size_t pos = 0; pos < text_length;) {
+                double value = 0;
+                const auto result = xed::parse_float(xed::string_view(text + pos, text_length - pos), value);
+                sum += value;
+                pos += result.length + 1;
+            }
+            xed_bench::do_not_optimize(sum);
+        });
+
+        runner.run("parse_double", "strtod", length, [&] {
+            double sum = 0;
+            const char* text = double_text.data();
+            const char* end = text + double_text.length();
+            while (text != end) {
+                char* next = nullptr;
+                sum += std::strtod(text, &next);
+                text = next + 1;
+            }
+            xed_bench::do_not_optimize(sum);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "format.hpp"
+
+// one log line, a couple of strings, integers and a double, with xed::format_to against
+// an ostringstream and snprintf. the length is how many lines go into the output per run.
+// usage: xed_format_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+const char* methods[] = { "GET", "POST", "PUT", "DELETE" };
+const char* paths[] = { "/", "/index.html", "/api/v1/users/1234/settings", "/static/css/site.min.css" };
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const xed::string host = "worker-17.internal";
+    const std::string std_host(host.data(), host.length());
+
+    const std::size_t lengths[] = { 1, 64, 4096 };
+    for (const auto length : lengths) {
+        xed::string out;
+        runner.run("log_line", "xed_format_to", length, [&] {
+            out.clear();
+            for (std::size_t i = 0; i < length; i++) {
+                xed::format_to(out, "{} {} {} status={} bytes={} took={:.3}ms\n",
+                    host, methods[i % 4], paths[i % 4], 200 + i % 5, i * 1531, 0.25 * double(i % 97));
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("log_line", "xed_format", length, [&] {
+            out.clear();
+            for (std::size_t i = 0; i < length; i++) {
+                const auto line = xed::format("{} {} {} status={} bytes={} took={:.3}ms\n",
+                    host, methods[i % 4], paths[i % 4], 200 + i % 5, i * 1531, 0.25 * double(i % 97));
+                out += line;
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("log_line", "ostringstream", length, [&] {
+            out.clear();
+            for (std::size_t i = 0; i < length; i++) {
+                std::ostringstream stream;
+                stream.precision(3);
+                stream << std_host << ' ' << methods[i % 4] << ' ' << paths[i % 4] << " status=" << 200 + i % 5
+                    << " bytes=" << i * 1531 << " took=" << 0.25 * double(i % 97) << "ms\n";
+                const auto line = stream.str();
+                out += xed::string_view(line.data(), line.size());
+            }
+            xed_bench::do_not_optimize(out);
+        });
+
+        runner.run("log_line", "snprintf", length, [&] {
+            out.clear();
+            char buffer[256];
+            for (std::size_t i = 0; i < length; i++) {
+                const auto written = std::snprintf(buffer, sizeof(buffer), "%s %s %s status=%zu bytes=%zu took=%.3gms\n",
+                    host.data(), methods[i % 4], paths[i % 4], 200 + i % 5, i * 1531, 0.25 * double(i % 97));
+                out += xed::string_view(buffer, static_cast<std::size_t>(written));
+            }
+            xed_bench::do_not_optimize(out);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "string_view.hpp"
+#include "glob_set.hpp"
+
+// routing a batch of request paths against a table of wildcard rules: one glob_set
+// lookup per path against a hand written glob match per rule, for 10, 100 and 1000
+// rules. the length is the bytes of all the paths.
+// usage: xed_glob_set_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+// the loop a routing layer writes by hand, backtracking to the last star.
+bool glob_match(const std::string& pattern, const std::string& text) {
+    std::size_t p = 0, t = 0, star = std::string::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        }
+        else if (p < pattern.size() && pattern[p] == '[') {
+            auto close = pattern.find(']', p + 2);
+            bool found = false;
+            for (auto i = p + 1; i < close; i++) {
+                if (i + 2 < close && pattern[i + 1] == '-') {
+                    found = found || (text[t] >= pattern[i] && text[t] <= pattern[i + 2]);
+                    i += 2;
+                }
+                else {
+                    found = found || text[t] == pattern[i];
+                }
+            }
+            if (found) {
+                p = close + 1;
+                t++;
+            }
+            else if (star != std::string::npos) {
+                p = star + 1;
+                t = ++resume;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            p++;
+            t++;
+        }
+        else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++resume;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+        p++;
+    return p == pattern.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    const std::size_t counts[] = { 10, 100, 1000 };
+    for (const auto count : counts) {
+        std::vector<std::string> rules;
+        for (std::size_t i = 0; i < count; i++) {
+            const auto id = std::to_string(i);
+            switch (i % 3) {
+            case 0: rules.push_back("/api/v[0-9]/res" + id + "/*"); break;
+            case 1: rules.push_back("/static/res" + id + "/*.css"); break;
+            default: rules.push_back("/users/[0-9]*/res" + id); break;
+            }
+        }
+        rules.push_back("*.php");
+
+        // paths that hit a rule now and then, and near misses otherwise.
+        std::vector<std::string> paths;
+        std::size_t bytes = 0;
+        for (int i = 0; i < 1000; i++) {
+            const auto id = std::to_string(next(seed) % (count * 2));
+            switch (next(seed) % 4) {
+            case 0: paths.push_back("/api/v" + std::to_string(next(seed) % 10) + "/res" + id + "/items/" + std::to_string(next(seed) % 100000)); break;
+            case 1: paths.push_back("/static/res" + id + "/theme/site.css"); break;
+            case 2: paths.push_back("/users/" + std::to_string(next(seed) % 100000) + "/res" + id); break;
+            default: paths.push_back("/index/res" + id + ".html"); break;
+            }
+            bytes += paths.back().size();
+        }
+
+        std::vector<xed::string_view> patterns;
+        for (const auto& rule : rules)
+            patterns.emplace_back(rule.data(), rule.size());
+        const xed::glob_set set(patterns.data(), patterns.size());
+        const auto name = "route_" + std::to_string(count) + "_rules";
+
+        runner.run(name.c_str(), "glob_set", bytes, [&] {
+            std::size_t routed = 0;
+            for (const auto& path : paths)
+                routed += set.find_first(xed::string_view(path.data(), path.size())) != npos;
+            xed_bench::do_not_optimize(routed);
+        });
+
+        runner.run(name.c_str(), "match_per_rule", bytes, [&] {
+            std::size_t routed = 0;
+            for (const auto& path : paths) {
+                for (const auto& rule : rules) {
+                    if (glob_match(rule, path)) {
+                        routed++;
+                        break;
+                    }
+                }
+            }
+            xed_bench::do_not_optimize(routed);
+        });
+    }
+    return 0;
+}
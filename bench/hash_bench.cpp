@@ -0,0 +1,105 @@
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "hash.hpp"
+#include "flat_string_map.hpp"
+
+// xed::hash_bytes against std::hash over a sweep of lengths, and xed::flat_string_map
+// against std::unordered_map over a sweep of sizes, both looked up by view.
+// usage: xed_hash_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+struct std_view_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>()(str); }
+};
+
+std::vector<std::string> make_keys(std::size_t count, const char* prefix) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+        keys.push_back(prefix + std::to_string(i * 2654435761u % 1000003));
+    return keys;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 8, 16, 32, 64, 256, 1024, 4096, 65536 };
+    for (const auto length : lengths) {
+        const std::string text(length, 'h');
+
+        runner.run("hash", "xed", length, [&] {
+            auto hash = xed::hash_bytes(text.data(), text.size());
+            xed_bench::do_not_optimize(hash);
+        });
+
+        runner.run("hash", "std", length, [&] {
+            auto hash = std::hash<std::string_view>()(text);
+            xed_bench::do_not_optimize(hash);
+        });
+    }
+
+    const std::size_t sizes[] = { 100, 10000, 1000000 };
+    for (const auto size : sizes) {
+        const auto keys = make_keys(size, "identifier_");
+        const auto missing = make_keys(size, "identifier#");
+
+        xed::flat_string_map<std::size_t> flat;
+        std::unordered_map<std::string, std::size_t, std_view_hash, std::equal_to<>> map;
+        for (std::size_t i = 0; i < size; i++) {
+            flat.insert(xed::string_view(keys[i].data(), keys[i].size()), i);
+            map.emplace(keys[i], i);
+        }
+
+        std::size_t index = 0;
+        runner.run("lookup_hit", "xed", size, [&] {
+            index = index + 1 == size ? 0 : index + 1;
+            auto value = flat.find(xed::string_view(keys[index].data(), keys[index].size()));
+            xed_bench::do_not_optimize(value);
+        });
+
+        runner.run("lookup_hit", "std", size, [&] {
+            index = index + 1 == size ? 0 : index + 1;
+            auto it = map.find(std::string_view(keys[index]));
+            xed_bench::do_not_optimize(it);
+        });
+
+        runner.run("lookup_miss", "xed", size, [&] {
+            index = index + 1 == size ? 0 : index + 1;
+            auto value = flat.find(xed::string_view(missing[index].data(), missing[index].size()));
+            xed_bench::do_not_optimize(value);
+        });
+
+        runner.run("lookup_miss", "std", size, [&] {
+            index = index + 1 == size ? 0 : index + 1;
+            auto it = map.find(std::string_view(missing[index]));
+            xed_bench::do_not_optimize(it);
+        });
+
+        // one whole table per iteration.
+        if (size <= 10000) {
+            runner.run("build", "xed", size, [&] {
+                xed::flat_string_map<std::size_t> fresh;
+                for (std::size_t i = 0; i < size; i++)
+                    fresh.insert(xed::string_view(keys[i].data(), keys[i].size()), i);
+                xed_bench::do_not_optimize(fresh);
+            });
+
+            runner.run("build", "std", size, [&] {
+                std::unordered_map<std::string, std::size_t, std_view_hash, std::equal_to<>> fresh;
+                for (std::size_t i = 0; i < size; i++)
+                    fresh.emplace(keys[i], i);
+                xed_bench::do_not_optimize(fresh);
+            });
+        }
+    }
+    return 0;
+}
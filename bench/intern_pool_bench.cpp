@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "intern_pool.hpp"
+
+// a parser's identifiers: many tokens, few distinct ones. every token kept as its own
+// xed::string against xed::intern_pool symbols, the memory both take (printed to
+// stderr) and the intern throughput per thread as threads are added.
+// usage: xed_intern_pool_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+// identifiers of 4 to 40 characters, the low ids show up far more often than the high ones.
+std::vector<std::string> make_tokens(std::size_t count, std::size_t distinct) {
+    std::vector<std::string> names;
+    names.reserve(distinct);
+    for (std::size_t i = 0; i < distinct; i++) {
+        std::string name = "id_";
+        name += std::to_string(i);
+        name.append((i * 7) % 37, "abcdefghijklmnopqrstuvwxyz_0123456789"[i % 37]);
+        names.push_back(name);
+    }
+
+    std::vector<std::string> tokens;
+    tokens.reserve(count);
+    std::uint32_t seed = 0x9e3779b9u;
+    for (std::size_t i = 0; i < count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        // squaring a uniform pick skews it towards the front.
+        const auto pick = static_cast<double>(seed) / 4294967296.0;
+        tokens.push_back(names[static_cast<std::size_t>(pick * pick * static_cast<double>(distinct))]);
+    }
+    return tokens;
+}
+
+// heap bytes a string holds on to, nothing while it fits inline.
+std::size_t heap_bytes(const xed::string& s) {
+    return s.is_inline() ? 0 : s.capacity();
+}
+
+// every thread runs fn(thread index) once, timed from a common start.
+template<typename Fn>
+double time_threads(std::size_t threads, Fn fn) {
+    std::atomic<std::size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (std::size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {}
+            fn(t);
+        });
+    }
+
+    while (ready.load() != threads) {}
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers)
+        worker.join();
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    constexpr std::size_t token_count = 1 << 20;
+    const std::size_t distinct_counts[] = { 1000, 100000 };
+    const auto max_threads = std::max<std::size_t>(8, std::thread::hardware_concurrency());
+
+    for (const auto distinct : distinct_counts) {
+        const auto tokens = make_tokens(token_count, distinct);
+
+        if (runner.enabled("memory")) {
+            std::vector<xed::string> strings;
+            strings.reserve(token_count);
+            std::size_t string_bytes = sizeof(xed::string) * token_count;
+            for (const auto& token : tokens) {
+                strings.emplace_back(token.data(), token.size());
+                string_bytes += heap_bytes(strings.back());
+            }
+
+            xed::intern_pool pool;
+            for (const auto& token : tokens) {
+                auto symbol = pool.intern({ token.data(), token.size() });
+                xed_bench::do_not_optimize(symbol);
+            }
+            const auto pool_bytes = sizeof(xed::intern_pool::symbol) * token_count + pool.bytes_used();
+
+            std::fprintf(stderr, "memory: %zu tokens, %zu distinct: strings %zu bytes, symbols + pool %zu bytes, saved %.1f%%\n",
+                token_count, pool.size(), string_bytes, pool_bytes,
+                100.0 - 100.0 * static_cast<double>(pool_bytes) / static_cast<double>(string_bytes));
+        }
+
+        // every thread walks the whole token list from its own offset into one shared pool.
+        for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+            if (runner.enabled("intern")) {
+                xed::intern_pool pool;
+                const auto ns = time_threads(threads, [&](std::size_t t) {
+                    const auto start = t * (token_count / threads);
+                    for (std::size_t i = 0; i < token_count; i++) {
+                        const auto& token = tokens[(start + i) % token_count];
+                        auto symbol = pool.intern({ token.data(), token.size() });
+                        xed_bench::do_not_optimize(symbol);
+                    }
+                });
+                runner.record("intern", ("pool_t" + std::to_string(threads)).c_str(), distinct, token_count * threads, ns / token_count);
+            }
+
+            if (runner.enabled("intern")) {
+                const auto ns = time_threads(threads, [&](std::size_t t) {
+                    const auto start = t * (token_count / threads);
+                    for (std::size_t i = 0; i < token_count; i++) {
+                        const auto& token = tokens[(start + i) % token_count];
+                        xed::string copy(token.data(), token.size());
+                        xed_bench::do_not_optimize(copy);
+                    }
+                });
+                runner.record("intern", ("string_t" + std::to_string(threads)).c_str(), distinct, token_count * threads, ns / token_count);
+            }
+        }
+
+        // equality on symbols is a pointer compare, on strings it reads the characters.
+        xed::intern_pool pool;
+        std::vector<xed::intern_pool::symbol> symbols;
+        std::vector<xed::string> strings;
+        for (std::size_t i = 0; i < 4096; i++) {
+            symbols.push_back(pool.intern({ tokens[i].data(), tokens[i].size() }));
+            strings.emplace_back(tokens[i].data(), tokens[i].size());
+        }
+
+        std::size_t index = 0;
+        runner.run("equals", "symbol", distinct, [&] {
+            index = (index + 1) & 4095;
+            bool equal = symbols[index] == symbols[index ^ 1];
+            xed_bench::do_not_optimize(equal);
+        });
+
+        runner.run("equals", "string", distinct, [&] {
+            index = (index + 1) & 4095;
+            bool equal = strings[index] == xed::string_view(strings[index ^ 1].data(), strings[index ^ 1].length());
+            xed_bench::do_not_optimize(equal);
+        });
+    }
+    return 0;
+}
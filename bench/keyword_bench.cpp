@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "bench.hpp"
+#include "fixed_string.hpp"
+
+// dispatching on a command word: xed::keyword_set, whose perfect hash table is built at
+// compile time, against the chain of compares it replaces and a std::unordered_map.
+// usage: xed_keyword_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+using commands = xed::keyword_set<
+    "GET", "SET", "DEL", "EXISTS", "EXPIRE", "TTL", "INCR", "DECR", "INCRBY", "DECRBY",
+    "APPEND", "STRLEN", "MGET", "MSET", "HGET", "HSET", "HDEL", "HGETALL", "LPUSH", "RPUSH",
+    "LPOP", "RPOP", "LRANGE", "SADD", "SREM", "SMEMBERS", "ZADD", "ZRANGE", "PING", "QUIT">;
+
+std::size_t if_chain(xed::string_view word) noexcept {
+    if (word == "GET") return 0;
+    if (word == "SET") return 1;
+    if (word == "DEL") return 2;
+    if (word == "EXISTS") return 3;
+    if (word == "EXPIRE") return 4;
+    if (word == "TTL") return 5;
+    if (word == "INCR") return 6;
+    if (word == "DECR") return 7;
+    if (word == "INCRBY") return 8;
+    if (word == "DECRBY") return 9;
+    if (word == "APPEND") return 10;
+    if (word == "STRLEN") return 11;
+    if (word == "MGET") return 12;
+    if (word == "MSET") return 13;
+    if (word == "HGET") return 14;
+    if (word == "HSET") return 15;
+    if (word == "HDEL") return 16;
+    if (word == "HGETALL") return 17;
+    if (word == "LPUSH") return 18;
+    if (word == "RPUSH") return 19;
+    if (word == "LPOP") return 20;
+    if (word == "RPOP") return 21;
+    if (word == "LRANGE") return 22;
+    if (word == "SADD") return 23;
+    if (word == "SREM") return 24;
+    if (word == "SMEMBERS") return 25;
+    if (word == "ZADD") return 26;
+    if (word == "ZRANGE") return 27;
+    if (word == "PING") return 28;
+    if (word == "QUIT") return 29;
+    return commands::none;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    std::unordered_map<std::string_view, std::size_t> map;
+    std::vector<std::string> words;
+    for (std::size_t i = 0; i < commands::size(); i++) {
+        const auto key = commands::key(i);
+        map.emplace(std::string_view(key.data(), key.length()), i);
+        words.emplace_back(key.data(), key.length());
+    }
+
+    // a quarter of the words are no command at all.
+    const std::size_t known = words.size();
+    for (std::size_t i = 0; i < known / 3; i++)
+        words.push_back(words[i * 3] + "X");
+
+    // in an order the branch predictor can't learn, the way requests arrive.
+    std::vector<xed::string_view> stream;
+    std::uint32_t seed = 0x9e3779b9u;
+    for (std::size_t i = 0; i < 4096; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        const auto& word = words[seed % words.size()];
+        stream.emplace_back(word.data(), word.size());
+    }
+
+    std::size_t index = 0;
+    runner.run("dispatch", "keyword_set", words.size(), [&] {
+        index = (index + 1) & (stream.size() - 1);
+        auto command = commands::find(stream[index]);
+        xed_bench::do_not_optimize(command);
+    });
+
+    runner.run("dispatch", "if_chain", words.size(), [&] {
+        index = (index + 1) & (stream.size() - 1);
+        auto command = if_chain(stream[index]);
+        xed_bench::do_not_optimize(command);
+    });
+
+    runner.run("dispatch", "std_unordered_map", words.size(), [&] {
+        index = (index + 1) & (stream.size() - 1);
+        const auto it = map.find(std::string_view(stream[index].data(), stream[index].length()));
+        auto command = it == map.end() ? commands::none : it->second;
+        xed_bench::do_not_optimize(command);
+    });
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "mapped_file.hpp"
+
+// opening a file and counting its lines: reading it into a xed::string first against
+// xed::mapped_file, which hands the page cache to the search as it is.
+// usage: xed_mapped_file_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+constexpr const char* path = "xed_mapped_file_bench.txt";
+
+void write_file(std::size_t length) {
+    std::FILE* file = std::fopen(path, "wb");
+    std::string line = "2024-01-01T00:00:00 level=info request handled in 12ms\n";
+    for (std::size_t written = 0; written < length; written += line.size())
+        std::fwrite(line.data(), 1, line.size(), file);
+    std::fclose(file);
+}
+
+xed::string read_file() {
+    std::FILE* file = std::fopen(path, "rb");
+    std::fseek(file, 0, SEEK_END);
+    const auto length = static_cast<std::size_t>(std::ftell(file));
+    std::fseek(file, 0, SEEK_SET);
+
+    xed::string text;
+    text.reserve(length + 1);
+    char buffer[1 << 16];
+    for (std::size_t read; (read = std::fread(buffer, 1, sizeof(buffer), file)) != 0;)
+        text += xed::string_view(buffer, read);
+    std::fclose(file);
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 1 << 16, 1 << 20, 1 << 26 };
+    for (const auto length : lengths) {
+        write_file(length);
+
+        runner.run("count_lines", "read_string", length, [&] {
+            const auto text = read_file();
+            auto lines = text.count('\n');
+            xed_bench::do_not_optimize(lines);
+        });
+
+        runner.run("count_lines", "mapped", length, [&] {
+            const xed::mapped_file file(path);
+            auto lines = file.view().count('\n');
+            xed_bench::do_not_optimize(lines);
+        });
+
+        runner.run("iterate_lines", "mapped", length, [&] {
+            const xed::mapped_file file(path);
+            std::size_t total = 0;
+            for (auto line : file.lines())
+                total += line.length();
+            xed_bench::do_not_optimize(total);
+        });
+    }
+
+    std::remove(path);
+    return 0;
+}
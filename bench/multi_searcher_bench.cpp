@@ -0,0 +1,75 @@
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "string_view.hpp"
+#include "multi_searcher.hpp"
+
+// matching a keyword list against a body of text: one multi_searcher pass against a
+// find loop per keyword, for a handful of keywords (the simd fingerprint where the build
+// has a byte shuffle) and for hundreds (the automaton). the length is the text length.
+// usage: xed_multi_searcher_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+std::string make_word(std::uint64_t& seed) {
+    std::string word;
+    const auto length = 4 + next(seed) % 8;
+    for (std::size_t i = 0; i < length; i++)
+        word += static_cast<char>('a' + next(seed) % 26);
+    return word;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    std::vector<std::string> keywords;
+    for (int i = 0; i < 300; i++)
+        keywords.push_back(make_word(seed));
+
+    const std::size_t lengths[] = { 4096, 1 << 20 };
+    const std::size_t counts[] = { 8, 300 };
+    for (const auto length : lengths) {
+        // words and spaces, with a keyword now and then.
+        std::string text;
+        while (text.size() < length) {
+            text += next(seed) % 64 == 0 ? keywords[next(seed) % keywords.size()] : make_word(seed);
+            text += ' ';
+        }
+        text.resize(length);
+        const xed::string_view view(text.data(), text.size());
+
+        for (const auto count : counts) {
+            std::vector<xed::string_view> patterns;
+            for (std::size_t i = 0; i < count; i++)
+                patterns.emplace_back(keywords[i].data(), keywords[i].size());
+            const xed::multi_searcher searcher(patterns.data(), patterns.size());
+            const auto name = count == 8 ? "match_8_keywords" : "match_300_keywords";
+
+            runner.run(name, searcher.uses_fingerprint() ? "multi_searcher_fingerprint" : "multi_searcher_automaton", length, [&] {
+                std::size_t matches = 0;
+                searcher.for_each_match(view, [&](const xed::multi_match&) { matches++; });
+                xed_bench::do_not_optimize(matches);
+            });
+
+            runner.run(name, "find_per_keyword", length, [&] {
+                std::size_t matches = 0;
+                for (const auto& pattern : patterns) {
+                    for (auto pos = view.find(pattern); pos != npos; pos = view.find(pattern, pos + 1))
+                        matches++;
+                }
+                xed_bench::do_not_optimize(matches);
+            });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "bench.hpp"
+#include "string_view.hpp"
+#include "parallel_search.hpp"
+
+// scaling of parallel_find, parallel_find_all and parallel_count from one thread to
+// every core, against the single threaded string_view find and count. the text is
+// random lower case letters with a needle that only occurs at the very end for find
+// and a short common one for count and find_all. the length is the text in bytes.
+// usage: xed_parallel_search_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>] [--mb=<n>]
+
+namespace {
+
+std::string make_text(std::size_t length) {
+    std::string text(length, ' ');
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (auto& ch : text) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        ch = static_cast<char>('a' + seed % 26);
+    }
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    std::size_t mb = 512;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--mb=", 5) == 0)
+            mb = std::strtoull(argv[i] + 5, nullptr, 10);
+    }
+
+    auto text = make_text(mb << 20);
+    text.replace(text.size() - 16, 16, "NEEDLE-AT-END-01");
+    const xed::string_view view(text.data(), text.size());
+    const xed::string_view rare("NEEDLE-AT-END-01");
+    const xed::string_view common("qz");
+
+    runner.run("find", "string_view", view.length(), [&] {
+        auto pos = view.find(rare);
+        xed_bench::do_not_optimize(pos);
+    });
+
+    runner.run("count", "string_view", view.length(), [&] {
+        auto count = view.count(common);
+        xed_bench::do_not_optimize(count);
+    });
+
+    const auto cores = std::thread::hardware_concurrency() != 0 ? std::thread::hardware_concurrency() : 1;
+    for (unsigned threads = 1;; threads = threads * 2 < cores ? threads * 2 : cores) {
+        const auto impl = "threads_" + std::to_string(threads);
+
+        runner.run("find", impl.c_str(), view.length(), [&] {
+            auto pos = xed::parallel_find(view, rare, threads);
+            xed_bench::do_not_optimize(pos);
+        });
+
+        runner.run("count", impl.c_str(), view.length(), [&] {
+            auto count = xed::parallel_count(view, common, threads);
+            xed_bench::do_not_optimize(count);
+        });
+
+        runner.run("find_all", impl.c_str(), view.length(), [&] {
+            auto positions = xed::parallel_find_all(view, common, threads);
+            xed_bench::do_not_optimize(positions);
+        });
+
+        if (threads == cores)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "rope.hpp"
+
+// edit latency of xed::rope against xed::string as the document grows.
+// usage: xed_rope_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::string make_document(std::size_t length) {
+    std::string text(length, ' ');
+    for (std::size_t i = 0; i < length; i++)
+        text[i] = "lorem ipsum dolor sit amet\n"[i % 27];
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 1 << 16, 1 << 20, 1 << 24 };
+    for (const auto length : lengths) {
+        const auto text = make_document(length);
+        const xed::string_view view(text.data(), text.size());
+
+        xed::rope<char> rope(view);
+        xed::string string(text.data(), text.size());
+
+        // insert and erase the same piece so the document keeps its size.
+        std::size_t position = 0;
+        runner.run("edit_middle", "rope", length, [&] {
+            position = (position + 7919) % (length / 2) + length / 4;
+            rope.insert(position, "typing");
+            rope.erase(position, 6);
+            xed_bench::do_not_optimize(rope);
+        });
+
+        runner.run("edit_middle", "string", length, [&] {
+            position = (position + 7919) % (length / 2) + length / 4;
+            string.insert(position, "typing");
+            string.erase(position, 6);
+            xed_bench::do_not_optimize(string);
+        });
+
+        runner.run("index", "rope", length, [&] {
+            position = (position + 7919) % length;
+            auto ch = rope[position];
+            xed_bench::do_not_optimize(ch);
+        });
+
+        runner.run("flatten", "rope", length, [&] {
+            auto flat = rope.str();
+            xed_bench::do_not_optimize(flat);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "shared_string.hpp"
+
+// fan-out of one payload to many threads: xed::shared_string copies against deep
+// xed::string copies, and what the shared reference count costs once every thread
+// bangs on the same cache line.
+// usage: xed_shared_string_bench [--csv|--json] [--filter=<name>]
+
+namespace {
+
+constexpr std::uint64_t copies_per_thread = 1 << 20;
+
+// every thread runs fn(thread index) copies_per_thread times, timed from a common start.
+template<typename Fn>
+double time_threads(std::size_t threads, Fn fn) {
+    std::atomic<std::size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (std::size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {}
+            for (std::uint64_t i = 0; i < copies_per_thread; i++)
+                fn(t);
+        });
+    }
+
+    while (ready.load() != threads) {}
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers)
+        worker.join();
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const auto max_threads = std::max<std::size_t>(8, std::thread::hardware_concurrency());
+    const std::size_t lengths[] = { 16, 256, 4096, 65536 };
+
+    for (const auto length : lengths) {
+        const std::string payload(length, 'p');
+        const xed::shared_string shared(xed::string_view(payload.data(), payload.size()));
+        const xed::string deep(payload.data(), payload.size());
+
+        for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+            // ns per copy as seen by one thread, flat means no contention.
+            if (runner.enabled("copy_same_source")) {
+                const auto ns = time_threads(threads, [&](std::size_t) {
+                    xed::shared_string copy = shared;
+                    xed_bench::do_not_optimize(copy);
+                });
+                runner.record("copy_same_source", ("shared_t" + std::to_string(threads)).c_str(), length, copies_per_thread * threads, ns / copies_per_thread);
+            }
+
+            if (runner.enabled("copy_same_source")) {
+                const auto ns = time_threads(threads, [&](std::size_t) {
+                    xed::string copy = deep;
+                    xed_bench::do_not_optimize(copy);
+                });
+                runner.record("copy_same_source", ("deep_t" + std::to_string(threads)).c_str(), length, copies_per_thread * threads, ns / copies_per_thread);
+            }
+
+            // the uncontended baseline, each thread owns a handle to its own payload.
+            if (runner.enabled("copy_own_source")) {
+                std::vector<xed::shared_string> sources;
+                for (std::size_t t = 0; t < threads; t++)
+                    sources.emplace_back(xed::string_view(payload.data(), payload.size()));
+
+                const auto ns = time_threads(threads, [&](std::size_t t) {
+                    xed::shared_string copy = sources[t];
+                    xed_bench::do_not_optimize(copy);
+                });
+                runner.record("copy_own_source", ("shared_t" + std::to_string(threads)).c_str(), length, copies_per_thread * threads, ns / copies_per_thread);
+            }
+        }
+    }
+    return 0;
+}
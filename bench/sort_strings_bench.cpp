@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "sort_strings.hpp"
+
+// sorting a large array of keys that look like urls, long shared prefixes and all:
+// std::sort with operator< against sort_strings on one thread and on every core. every
+// operation sorts a fresh copy of the same keys, "copy" is that copy on its own. the
+// length is the number of keys. 100M keys need well over 10 GB, so they only run when asked
+// for with --max-keys=100000000.
+// usage: xed_sort_strings_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>] [--max-keys=<n>]
+
+namespace {
+
+std::vector<xed::string> make_keys(std::size_t count) {
+    const char* paths[] = { "user/", "item/", "static/img/", "api/v2/orders/" };
+    std::vector<xed::string> keys;
+    keys.reserve(count);
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (std::size_t i = 0; i < count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::string key = "https://example.com/";
+        key += paths[seed % 4];
+        key += std::to_string((seed >> 8) % (count / 4 + 1));
+        if (seed & 0x10000)
+            key += "/edit";
+        keys.emplace_back(key.data(), key.size());
+    }
+    return keys;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    std::size_t max_keys = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--max-keys=", 11) == 0)
+            max_keys = std::strtoull(argv[i] + 11, nullptr, 10);
+    }
+
+    const std::size_t counts[] = { 1000000, 10000000, 100000000 };
+    for (const auto count : counts) {
+        if (count > max_keys)
+            break;
+
+        const auto keys = make_keys(count);
+        std::vector<xed::string> work;
+
+        runner.run("sort", "copy", count, [&] {
+            work = keys;
+            xed_bench::do_not_optimize(work);
+        });
+
+        runner.run("sort", "std_sort", count, [&] {
+            work = keys;
+            std::sort(work.begin(), work.end(), [](const xed::string& a, const xed::string& b) { return a < b; });
+            xed_bench::do_not_optimize(work);
+        });
+
+        runner.run("sort", "xed_1_thread", count, [&] {
+            work = keys;
+            xed::sort_strings(work.data(), work.data() + work.size(), 1);
+            xed_bench::do_not_optimize(work);
+        });
+
+        if (std::thread::hardware_concurrency() > 1) {
+            runner.run("sort", "xed", count, [&] {
+                work = keys;
+                xed::sort_strings(work.data(), work.data() + work.size());
+                xed_bench::do_not_optimize(work);
+            });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "split.hpp"
+
+// splitting log lines: xed::split views against the find and substr loop it replaces,
+// on xed::string and on std::string.
+// usage: xed_split_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+// space separated fields of 1 to 12 characters, with the odd double space.
+std::string make_line(std::size_t length) {
+    std::string line;
+    std::uint32_t seed = 0x9e3779b9u;
+    while (line.size() < length) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        line.append(1 + seed % 12, static_cast<char>('a' + seed % 26));
+        line += seed % 16 == 0 ? "  " : " ";
+    }
+    line.resize(length);
+    return line;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 64, 256, 1024, 4096, 65536 };
+    for (const auto length : lengths) {
+        const auto line = make_line(length);
+        const xed::string_view view(line.data(), line.size());
+        const xed::string string(line.data(), line.size());
+
+        runner.run("split_char", "xed_split", length, [&] {
+            std::size_t total = 0;
+            for (auto field : xed::split(view, ' '))
+                total += field.length();
+            xed_bench::do_not_optimize(total);
+        });
+
+        runner.run("split_char", "xed_substr", length, [&] {
+            std::size_t total = 0;
+            std::size_t start = 0;
+            for (auto pos = string.find(' '); ; pos = string.find(' ', start)) {
+                auto field = string.substr(start, (pos == npos ? string.length() : pos) - start);
+                total += field.length();
+                if (pos == npos)
+                    break;
+                start = pos + 1;
+            }
+            xed_bench::do_not_optimize(total);
+        });
+
+        runner.run("split_char", "std_substr", length, [&] {
+            std::size_t total = 0;
+            std::size_t start = 0;
+            for (auto pos = line.find(' '); ; pos = line.find(' ', start)) {
+                auto field = line.substr(start, pos == std::string::npos ? std::string::npos : pos - start);
+                total += field.size();
+                if (pos == std::string::npos)
+                    break;
+                start = pos + 1;
+            }
+            xed_bench::do_not_optimize(total);
+        });
+
+        runner.run("split_skip_empty", "xed_split", length, [&] {
+            std::size_t total = 0;
+            for (auto field : xed::split(view, ' ', { true }))
+                total += field.length();
+            xed_bench::do_not_optimize(total);
+        });
+
+        runner.run("split_any_of", "xed_split", length, [&] {
+            std::size_t total = 0;
+            for (auto field : xed::split(view, xed::any_of(" \t,;")))
+                total += field.length();
+            xed_bench::do_not_optimize(total);
+        });
+
+        runner.run("split_string", "xed_split", length, [&] {
+            std::size_t total = 0;
+            for (auto field : xed::split(view, "  "))
+                total += field.length();
+            xed_bench::do_not_optimize(total);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+
+// xed::basic_string against std::string over a sweep of lengths.
+// usage: xed_string_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+struct xed_ops {
+    using string = xed::string;
+    static constexpr const char* name = "xed";
+
+    static string make(const char* str, std::size_t length) { return { str, length }; }
+    static string make(const char* str) { return str; }
+    static void append(string& s, const char* str, std::size_t length) { s += xed::string_view(str, length); }
+    static std::size_t find(const string& s, char ch) { return s.find(ch); }
+    static std::size_t find(const string& s, const char* str, std::size_t length) { return s.find(xed::string_view(str, length)); }
+    static void replace(string& s, const char* from, std::size_t from_length, const char* to, std::size_t to_length) {
+        s.replace(xed::string_view(from, from_length), xed::string_view(to, to_length));
+    }
+    static void replace_all(string& s, const char* from, std::size_t from_length, const char* to, std::size_t to_length) {
+        s.replace_all(xed::string_view(from, from_length), xed::string_view(to, to_length));
+    }
+    static void insert(string& s, std::size_t pos, const char* str, std::size_t length) { s.insert(pos, xed::string_view(str, length)); }
+    static void erase(string& s, std::size_t pos, std::size_t length) { s.erase(pos, length); }
+    static string substr(const string& s, std::size_t pos, std::size_t length) { return s.substr(pos, length); }
+    static string to_lowercase(const string& s) { return xed::to_lowercase(s); }
+};
+
+struct std_ops {
+    using string = std::string;
+    static constexpr const char* name = "std";
+
+    static string make(const char* str, std::size_t length) { return { str, length }; }
+    static string make(const char* str) { return str; }
+    static void append(string& s, const char* str, std::size_t length) { s.append(str, length); }
+    static std::size_t find(const string& s, char ch) { return s.find(ch); }
+    static std::size_t find(const string& s, const char* str, std::size_t length) { return s.find(str, 0, length); }
+    static void replace(string& s, const char* from, std::size_t from_length, const char* to, std::size_t to_length) {
+        const auto pos = s.find(from, 0, from_length);
+        if (pos != string::npos)
+            s.replace(pos, from_length, to, to_length);
+    }
+    // the usual find and append loop into a fresh string.
+    static void replace_all(string& s, const char* from, std::size_t from_length, const char* to, std::size_t to_length) {
+        string out;
+        std::size_t read = 0;
+        for (auto pos = s.find(from, 0, from_length); pos != string::npos; pos = s.find(from, read, from_length)) {
+            out.append(s, read, pos - read).append(to, to_length);
+            read = pos + from_length;
+        }
+        out.append(s, read, string::npos);
+        s.swap(out);
+    }
+    static void insert(string& s, std::size_t pos, const char* str, std::size_t length) { s.insert(std::min(pos, s.size()), str, length); }
+    static void erase(string& s, std::size_t pos, std::size_t length) { s.erase(pos, length); }
+    static string substr(const string& s, std::size_t pos, std::size_t length) { return s.substr(pos, length); }
+    static string to_lowercase(const string& s) {
+        string ret = s;
+        std::transform(ret.begin(), ret.end(), ret.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ret;
+    }
+};
+
+// mixed case text without the characters the searches look for.
+std::string make_text(std::size_t length) {
+    std::string text(length, ' ');
+    for (std::size_t i = 0; i < length; i++)
+        text[i] = "AbCdEfGhIjKlMnOpQrStUvW"[i % 23];
+    return text;
+}
+
+template<typename Ops>
+void run_cases(xed_bench::runner& runner, std::size_t length) {
+    using string = typename Ops::string;
+    const auto text = make_text(length);
+
+    runner.run("construct_literal", Ops::name, length, [&] {
+        auto s = Ops::make(text.c_str());
+        xed_bench::do_not_optimize(s);
+    });
+
+    runner.run("append_loop", Ops::name, length, [&] {
+        string s = Ops::make("", 0);
+        for (std::size_t i = 0; i < length; i += 8)
+            Ops::append(s, "12345678", 8);
+        xed_bench::do_not_optimize(s);
+    });
+
+    const auto quarter = Ops::make(text.data(), length / 4);
+    runner.run("concat4", Ops::name, length, [&] {
+        string s = quarter + quarter + quarter + quarter;
+        xed_bench::do_not_optimize(s);
+    });
+
+    // needles sit in the last bytes so a hit scans as far as a miss does.
+    auto tagged = text;
+    if (length >= 8)
+        tagged.replace(length - 8, 8, "xyz#uvw!");
+    const auto haystack = Ops::make(tagged.data(), tagged.size());
+
+    runner.run("find_char_hit", Ops::name, length, [&] {
+        auto pos = Ops::find(haystack, '!');
+        xed_bench::do_not_optimize(pos);
+    });
+
+    runner.run("find_char_miss", Ops::name, length, [&] {
+        auto pos = Ops::find(haystack, '@');
+        xed_bench::do_not_optimize(pos);
+    });
+
+    runner.run("find_substr_hit", Ops::name, length, [&] {
+        auto pos = Ops::find(haystack, "xyz#uvw!", 8);
+        xed_bench::do_not_optimize(pos);
+    });
+
+    runner.run("find_substr_miss", Ops::name, length, [&] {
+        auto pos = Ops::find(haystack, "AbCdEfGh@", 9);
+        xed_bench::do_not_optimize(pos);
+    });
+
+    // grow then shrink back so every iteration sees the same string.
+    auto replaced = Ops::make(text.data(), text.size());
+    runner.run("replace", Ops::name, length, [&] {
+        Ops::replace(replaced, "AbCd", 4, "[AbCd]", 6);
+        Ops::replace(replaced, "[AbCd]", 6, "AbCd", 4);
+        xed_bench::do_not_optimize(replaced);
+    });
+
+    runner.run("replace_all_grow", Ops::name, length, [&] {
+        auto s = Ops::make(text.data(), text.size());
+        Ops::replace_all(s, "AbCd", 4, "[AbCd]", 6);
+        xed_bench::do_not_optimize(s);
+    });
+
+    runner.run("replace_all_shrink", Ops::name, length, [&] {
+        auto s = Ops::make(text.data(), text.size());
+        Ops::replace_all(s, "AbCd", 4, "x", 1);
+        xed_bench::do_not_optimize(s);
+    });
+
+    const std::size_t positions[] = { 0, length / 2, length };
+    const char* position_names[][2] = {
+        { "insert_front", "erase_front" },
+        { "insert_middle", "erase_middle" },
+        { "insert_back", "erase_back" },
+    };
+    for (std::size_t i = 0; i < 3; i++) {
+        const auto pos = positions[i];
+        auto edited = Ops::make(text.data(), text.size());
+
+        runner.run(position_names[i][0], Ops::name, length, [&] {
+            Ops::insert(edited, pos, "1234", 4);
+            Ops::erase(edited, pos, 4);
+            xed_bench::do_not_optimize(edited);
+        });
+
+        // erase first, so the front and middle cases don't need 4 spare characters.
+        runner.run(position_names[i][1], Ops::name, length, [&] {
+            const auto at = pos >= 4 ? pos - 4 : pos;
+            Ops::erase(edited, at, 4);
+            Ops::insert(edited, at, "1234", 4);
+            xed_bench::do_not_optimize(edited);
+        });
+    }
+
+    const auto source = Ops::make(text.data(), text.size());
+    runner.run("substr", Ops::name, length, [&] {
+        auto s = Ops::substr(source, length / 4, length / 2);
+        xed_bench::do_not_optimize(s);
+    });
+
+    runner.run("to_lowercase", Ops::name, length, [&] {
+        auto s = Ops::to_lowercase(source);
+        xed_bench::do_not_optimize(s);
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 8, 16, 23, 24, 64, 256, 1024, 4096, 65536 };
+    for (const auto length : lengths) {
+        run_cases<xed_ops>(runner, length);
+        run_cases<std_ops>(runner, length);
+    }
+    return 0;
+}
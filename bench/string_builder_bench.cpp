@@ -0,0 +1,72 @@
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "format.hpp"
+#include "string_builder.hpp"
+
+// putting a response together out of a few dozen header lines and a body: basic_string
+// with += against string_builder, which references the body instead of copying it. the
+// length is the size of the body.
+// usage: xed_string_builder_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+constexpr int header_count = 24;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const std::size_t lengths[] = { 1024, 65536, 1 << 20, 1 << 24 };
+    for (const auto length : lengths) {
+        const std::string body(length, 'b');
+        const xed::string_view body_view(body.data(), body.size());
+
+        runner.run("build_response", "string", length, [&] {
+            xed::string response;
+            response += xed::string_view("HTTP/1.1 200 OK\r\n", 17);
+            for (int i = 0; i < header_count; i++)
+                xed::format_to(response, "X-Header-{}: some header value {}\r\n", i, i * 7);
+            response += xed::string_view("\r\n", 2);
+            response += body_view;
+            xed_bench::do_not_optimize(response);
+        });
+
+        runner.run("build_response", "builder_segments", length, [&] {
+            xed::string_builder response;
+            response += xed::string_view("HTTP/1.1 200 OK\r\n", 17);
+            for (int i = 0; i < header_count; i++)
+                xed::format_to(response, "X-Header-{}: some header value {}\r\n", i, i * 7);
+            response += xed::string_view("\r\n", 2);
+            response.append_ref(body_view);
+            auto count = response.segment_count();
+            xed_bench::do_not_optimize(count);
+        });
+
+        runner.run("build_response", "builder_to_string", length, [&] {
+            xed::string_builder response;
+            response += xed::string_view("HTTP/1.1 200 OK\r\n", 17);
+            for (int i = 0; i < header_count; i++)
+                xed::format_to(response, "X-Header-{}: some header value {}\r\n", i, i * 7);
+            response += xed::string_view("\r\n", 2);
+            response.append_ref(body_view);
+            auto str = response.to_string();
+            xed_bench::do_not_optimize(str);
+        });
+
+        // one builder for many responses, the chunks stay allocated.
+        xed::string_builder reused;
+        runner.run("build_response", "builder_reused", length, [&] {
+            reused.clear();
+            reused += xed::string_view("HTTP/1.1 200 OK\r\n", 17);
+            for (int i = 0; i < header_count; i++)
+                xed::format_to(reused, "X-Header-{}: some header value {}\r\n", i, i * 7);
+            reused += xed::string_view("\r\n", 2);
+            reused.append_ref(body_view);
+            auto count = reused.segment_count();
+            xed_bench::do_not_optimize(count);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <string>
+#include "bench.hpp"
+#include "basic_string.hpp"
+#include "utf.hpp"
+
+// utf-8 validation and utf-8 to utf-16 transcoding, the vector paths against the plain
+// sequence at a time decoder, over ascii, mostly latin and cjk text.
+// usage: xed_utf_bench [--csv|--json] [--filter=<name>] [--min-time-ms=<n>]
+
+namespace {
+
+std::string make_text(std::size_t length, int kind) {
+    // 1, 2 and 3 byte characters.
+    const char* pieces[] = { "a", "e", " ", "\xc3\xa9", "\xe4\xb8\xad", "\xe6\x96\x87" };
+    std::string text;
+    std::uint32_t seed = 0x9e3779b9u;
+    while (text.size() < length) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        const auto pick = kind == 0 ? seed % 3
+            : kind == 1 ? (seed % 16 == 0 ? 3 : seed % 3)
+            : 4 + seed % 2;
+        text += pieces[pick];
+    }
+    // whole characters only.
+    while (text.size() > length || (!text.empty() && (static_cast<unsigned char>(text.back()) & 0xc0) == 0xc0))
+        text.pop_back();
+    while (!xed::is_valid_utf8(xed::string_view(text.data(), text.size())))
+        text.pop_back();
+    return text;
+}
+
+// what a straightforward decoder does, one sequence at a time.
+std::size_t scalar_to_utf16(const std::string& text, char16_t* out) {
+    auto data = reinterpret_cast<const xed::details::byte_type*>(text.data());
+    const auto end = data + text.size();
+    auto write = out;
+    while (data != end) {
+        if (xed::details::utf8_sequence_length(data, static_cast<std::size_t>(end - data)) == 0)
+            return npos;
+        write = xed::details::encode_utf16(xed::details::decode_utf8(data), write);
+    }
+    return static_cast<std::size_t>(write - out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    xed_bench::runner runner(argc, argv);
+
+    const char* kinds[] = { "ascii", "latin", "cjk" };
+    const std::size_t lengths[] = { 64, 1024, 65536, 1 << 20 };
+    for (int kind = 0; kind < 3; kind++) {
+        for (const auto length : lengths) {
+            const auto text = make_text(length, kind);
+            const xed::string_view view(text.data(), text.size());
+            const auto bytes = reinterpret_cast<const xed::details::byte_type*>(text.data());
+
+            const std::string validate = std::string("validate_") + kinds[kind];
+            runner.run(validate.c_str(), "xed", length, [&] {
+                auto valid = xed::is_valid_utf8(view);
+                xed_bench::do_not_optimize(valid);
+            });
+
+            runner.run(validate.c_str(), "scalar", length, [&] {
+                auto invalid = xed::details::find_invalid_utf8_scalar(bytes, text.size());
+                xed_bench::do_not_optimize(invalid);
+            });
+
+            const std::string transcode = std::string("to_utf16_") + kinds[kind];
+            xed::u16string out;
+            runner.run(transcode.c_str(), "xed", length, [&] {
+                xed::to_utf16(view, out);
+                xed_bench::do_not_optimize(out);
+            });
+
+            xed::u16string buffer;
+            buffer.resize_for_overwrite(text.size());
+            runner.run(transcode.c_str(), "scalar", length, [&] {
+                auto written = scalar_to_utf16(text, buffer.data());
+                xed_bench::do_not_optimize(written);
+            });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+#pragma once
+#ifndef XED_ALLOCATOR_HPP
+#define XED_ALLOCATOR_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "xutility.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+// what basic_string used before it took an allocator, new[] and delete[].
+template<typename T>
+class allocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer_type = value_type*;
+
+    constexpr allocator() noexcept = default;
+
+    template<typename U>
+    constexpr allocator(const allocator<U>&) noexcept {}
+
+    inline NODISCARD pointer_type allocate(size_type count) {
+        return new value_type[count];
+    }
+
+    inline void deallocate(pointer_type ptr, size_type) noexcept {
+        delete[] ptr;
+    }
+
+    template<typename U>
+    constexpr inline NODISCARD bool operator==(const allocator<U>&) const noexcept { return true; }
+    template<typename U>
+    constexpr inline NODISCARD bool operator!=(const allocator<U>&) const noexcept { return false; }
+};
+
+// bump allocator for memory that dies all at once, e.g. every string built while
+// handling one request. deallocate only gives memory back when it was the last
+// thing handed out, everything else is reclaimed by release() or the destructor.
+// the last block can also grow in place with try_grow, so a string being appended to
+// keeps its buffer for as long as the chunk has room and only leaves one behind when
+// it moves on to the next chunk.
+class monotonic_arena {
+public:
+    using size_type = std::size_t;
+
+    constexpr static size_type default_chunk_size = 4096;
+    constexpr static size_type max_chunk_size = 1 << 20;
+
+    explicit monotonic_arena(size_type chunk_size = default_chunk_size) noexcept
+        : next_chunk_size_(chunk_size) {
+    }
+
+    // hands out `buffer` first and only touches the heap once it is used up.
+    monotonic_arena(void* buffer, size_type size, size_type chunk_size = default_chunk_size) noexcept
+        : current_(static_cast<byte_type*>(buffer))
+        , end_(current_ + size)
+        , initial_buffer_(current_)
+        , initial_size_(size)
+        , next_chunk_size_(chunk_size) {
+    }
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() noexcept {
+        free_chunks();
+    }
+
+    inline NODISCARD void* allocate(size_type bytes, size_type alignment = alignof(std::max_align_t)) {
+        auto ptr = align_up(current_, alignment);
+        if (ptr == nullptr || ptr > end_ || bytes > static_cast<size_type>(end_ - ptr)) {
+            add_chunk(bytes + alignment);
+            ptr = align_up(current_, alignment);
+        }
+
+        current_ = ptr + bytes;
+        bytes_allocated_ += bytes;
+        return ptr;
+    }
+
+    inline void deallocate(void* ptr, size_type bytes) noexcept {
+        if (static_cast<byte_type*>(ptr) + bytes == current_) {
+            current_ = static_cast<byte_type*>(ptr);
+            bytes_allocated_ -= bytes;
+        }
+    }
+
+    // makes the last block handed out `new_bytes` long where it is, when its chunk has
+    // the room. returns false and changes nothing otherwise.
+    inline NODISCARD bool try_grow(void* ptr, size_type old_bytes, size_type new_bytes) noexcept {
+        const auto block = static_cast<byte_type*>(ptr);
+        if (block + old_bytes != current_ || new_bytes - old_bytes > static_cast<size_type>(end_ - current_))
+            return false;
+
+        current_ = block + new_bytes;
+        bytes_allocated_ += new_bytes - old_bytes;
+        return true;
+    }
+
+    // frees every chunk at once, the arena is reusable afterwards.
+    inline void release() noexcept {
+        free_chunks();
+        current_ = initial_buffer_;
+        end_ = initial_buffer_ + initial_size_;
+        bytes_allocated_ = 0;
+    }
+
+    inline NODISCARD size_type bytes_allocated() const noexcept { return bytes_allocated_; }
+private:
+    using byte_type = unsigned char;
+
+    struct chunk_header {
+        chunk_header* next_;
+    };
+
+    static inline NODISCARD byte_type* align_up(byte_type* ptr, size_type alignment) noexcept {
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return reinterpret_cast<byte_type*>((address + alignment - 1) & ~(alignment - 1));
+    }
+
+    // a block bigger than the usual chunk gets one twice its size, so the string that
+    // asked for it can keep growing in place for a while.
+    inline void add_chunk(size_type min_size) {
+        const auto size = (min_size > next_chunk_size_ ? 2 * min_size : next_chunk_size_) + sizeof(chunk_header);
+        auto chunk = static_cast<chunk_header*>(::operator new(size));
+
+        chunk->next_ = chunks_;
+        chunks_ = chunk;
+        current_ = reinterpret_cast<byte_type*>(chunk + 1);
+        end_ = reinterpret_cast<byte_type*>(chunk) + size;
+
+        if (next_chunk_size_ < max_chunk_size)
+            next_chunk_size_ *= 2;
+    }
+
+    inline void free_chunks() noexcept {
+        while (chunks_ != nullptr)
+            ::operator delete(exchange(chunks_, chunks_->next_));
+    }
+private:
+    chunk_header* chunks_ = nullptr;
+    byte_type* current_ = nullptr;
+    byte_type* end_ = nullptr;
+    byte_type* initial_buffer_ = nullptr;
+    size_type initial_size_ = 0;
+    size_type next_chunk_size_;
+    size_type bytes_allocated_ = 0;
+};
+
+template<typename T>
+class arena_allocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using pointer_type = value_type*;
+
+    arena_allocator(monotonic_arena& arena) noexcept
+        : arena_(&arena) {
+    }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept
+        : arena_(other.arena()) {
+    }
+
+    inline NODISCARD pointer_type allocate(size_type count) {
+        return static_cast<pointer_type>(arena_->allocate(sizeof(value_type) * count, alignof(value_type)));
+    }
+
+    inline void deallocate(pointer_type ptr, size_type count) noexcept {
+        arena_->deallocate(ptr, sizeof(value_type) * count);
+    }
+
+    inline NODISCARD bool try_grow(pointer_type ptr, size_type old_count, size_type new_count) noexcept {
+        return arena_->try_grow(ptr, sizeof(value_type) * old_count, sizeof(value_type) * new_count);
+    }
+
+    inline NODISCARD monotonic_arena* arena() const noexcept { return arena_; }
+
+    template<typename U>
+    inline NODISCARD bool operator==(const arena_allocator<U>& other) const noexcept { return arena_ == other.arena(); }
+    template<typename U>
+    inline NODISCARD bool operator!=(const arena_allocator<U>& other) const noexcept { return arena_ != other.arena(); }
+private:
+    monotonic_arena* arena_;
+};
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_ALLOCATOR_HPP
@@ -2,14 +2,17 @@
 #ifndef XED_BASIC_STRING_HPP
 #define XED_BASIC_STRING_HPP 1
 
+#include <bit>
+#include <concepts>
 #include <cstdint>
 #include <cstring>
 #include "xutility.hpp"
 #include "string_view.hpp"
+#include "allocator.hpp"
+#include "string_stats.hpp"
 #include "has_attributes.hpp"
 #include <iosfwd>
 
-static constexpr std::size_t npos = -1;
 namespace xed {
 namespace details {
 template<typename CharType>
@@ -81,13 +84,118 @@ public:
 private:
     value_type* ptr_;
 };
-} // namespace details
+
+// memcpy and memmove of `count` characters, counted when XED_STRING_STATS is on.
 template<typename CharType>
+inline void copy_chars(CharType* out, const CharType* from, std::size_t count) noexcept {
+    std::memcpy(out, from, sizeof(CharType) * count);
+    string_stats_copied(sizeof(CharType) * count);
+}
+
+template<typename CharType>
+inline void move_chars(CharType* out, const CharType* from, std::size_t count) noexcept {
+    std::memmove(out, from, sizeof(CharType) * count);
+    string_stats_copied(sizeof(CharType) * count);
+}
+} // namespace details
+
+template<typename CharType, typename Allocator>
+class basic_string;
+
+// hysteresis for basic_string::shrink_to_fit, a string that keeps growing and shrinking
+// around the same size shouldn't pay for a reallocation every time it gets a bit shorter.
+struct shrink_policy {
+    std::size_t min_unused = 0;
+    std::size_t max_unused_percent = 0;
+};
+
+// what `a + b + c` evaluates to. it only records the pieces, as views, and the
+// result is allocated once, at full length, when it turns into a basic_string.
+// the views point into the operands, so don't keep one around with `auto`.
+template<typename CharType, typename Allocator, typename Left>
+class basic_string_concat {
+public:
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using pointer_type = value_type*;
+    using string_view = basic_string_view<value_type>;
+    using string_type = basic_string<value_type, Allocator>;
+    using allocator_type = Allocator;
+
+    basic_string_concat(const Left& left, string_view right, const allocator_type& alloc) noexcept
+        : left_(left)
+        , right_(right)
+        , allocator_(alloc) {
+    }
+
+    inline NODISCARD basic_string_concat<value_type, allocator_type, basic_string_concat> operator+(string_view other) const noexcept {
+        return { *this, other, allocator_ };
+    }
+
+    inline NODISCARD operator string_type() const {
+        return string_type(*this);
+    }
+
+    inline NODISCARD string_type str() const {
+        return string_type(*this);
+    }
+
+    inline NODISCARD size_type length() const noexcept {
+        return piece_length(left_) + right_.length();
+    }
+
+    // writes every piece, without a terminator, and returns one past the end.
+    inline pointer_type write(pointer_type out) const noexcept {
+        out = piece_write(left_, out);
+        details::copy_chars(out, right_.data(), right_.length());
+        return out + right_.length();
+    }
+
+    inline NODISCARD bool operator==(string_view other) const noexcept {
+        return length() == other.length() && piece_equal(*this, other.data());
+    }
+
+    inline NODISCARD bool operator!=(string_view other) const noexcept {
+        return !(*this == other);
+    }
+
+    inline allocator_type get_allocator() const noexcept { return allocator_; }
+private:
+    template<typename, typename, typename>
+    friend class basic_string_concat;
+
+    static inline NODISCARD size_type piece_length(string_view piece) noexcept { return piece.length(); }
+    template<typename Piece>
+    static inline NODISCARD size_type piece_length(const Piece& piece) noexcept { return piece.length(); }
+
+    static inline pointer_type piece_write(string_view piece, pointer_type out) noexcept {
+        details::copy_chars(out, piece.data(), piece.length());
+        return out + piece.length();
+    }
+    template<typename Piece>
+    static inline pointer_type piece_write(const Piece& piece, pointer_type out) noexcept { return piece.write(out); }
+
+    // compares `piece` against the characters at `other`, which has room for all of it.
+    static inline NODISCARD bool piece_equal(string_view piece, const value_type* other) noexcept {
+        return std::memcmp(piece.data(), other, sizeof(value_type) * piece.length()) == 0;
+    }
+    template<typename Piece>
+    static inline NODISCARD bool piece_equal(const Piece& piece, const value_type* other) noexcept {
+        return piece_equal(piece.left_, other) && piece_equal(piece.right_, other + piece_length(piece.left_));
+    }
+private:
+    Left left_;
+    string_view right_;
+    NO_UNIQUE_ADDRESS allocator_type allocator_;
+};
+
+template<typename CharType, typename Allocator = allocator<CharType>>
 class basic_string {
 public:
     using this_type = basic_string;
     using size_type = std::size_t;
     using value_type = CharType;
+    using allocator_type = Allocator;
     using char_type = value_type;
     using pointer_type = value_type*;
     using reference_type = value_type&;
@@ -95,48 +203,60 @@ public:
     using const_pointer_type = const value_type*;
     using const_reference_type = const value_type&;
     using iterator = pointer_type;
-    using const_iterator = const pointer_type;
+    using const_iterator = const_pointer_type;
     using reverse_iterator = details::basic_string_reverse_iterator<char_type>;
     using const_reverse_iterator = details::basic_string_reverse_iterator<const char_type>;
+
+    // longest string that is stored inline, inside the object itself.
+    static constexpr size_type sso_capacity = (sizeof(pointer_type) + 2 * sizeof(size_type)) / sizeof(value_type) - 1;
 public:
-    basic_string()
-        : capacity_(1)
-        , length_(0)
-        , data_(new value_type('\0')) {
+    basic_string() noexcept {
+        set_inline_length(0);
+    }
+
+    explicit basic_string(const allocator_type& alloc) noexcept
+        : allocator_(alloc) {
+        set_inline_length(0);
     }
 
-    basic_string(const_pointer_type string, size_t length)
-        : capacity_(length + 1)
-        , length_(length)
-        , data_(new value_type[capacity_]) {
-        std::memcpy(data_, string, sizeof(value_type) * (length_ + 1));
+    basic_string(const_pointer_type string, size_t length, const allocator_type& alloc = allocator_type())
+        : allocator_(alloc) {
+        pointer_type buffer = prepare(length);
+        details::copy_chars(buffer, string, length);
+        buffer[length] = '\0';
     }
 
-    basic_string(pointer_type string, size_t length,std::nullptr_t)
-        : capacity_(length + 1)
-        , length_(length)
-        , data_(string) {
+    // takes ownership of `string`, which has to come from allocate(length + 1) of the allocator.
+    basic_string(pointer_type string, size_t length,std::nullptr_t, const allocator_type& alloc = allocator_type())
+        : allocator_(alloc) {
+        heap_.data_ = string;
+        heap_.length_ = length;
+        set_heap_capacity(length + 1);
+        details::string_stats_allocated(sizeof(value_type) * (length + 1));
     }
 
-    basic_string(const_pointer_type string)
-        : capacity_(std::strlen(string) + 1)
-        , length_(capacity_ - 1)
-        , data_(new value_type[capacity_]) {
-        std::memcpy(data_, string, sizeof(value_type) * (length_ + 1));
+    basic_string(const_pointer_type string, const allocator_type& alloc = allocator_type())
+        : basic_string(string, std::strlen(string), alloc) {
     }
 
     basic_string(const basic_string& other)
-        : capacity_(other.capacity_)
-        , length_(other.length_) {
-        delete[] data_;
-        data_ = new value_type[other.capacity_];
-        std::memcpy(data_, other.data_, sizeof(value_type) * (length_ + 1));
+        : basic_string(other.data(), other.length(), other.allocator_) {
+    }
+
+    template<typename Left>
+    basic_string(const basic_string_concat<value_type, allocator_type, Left>& concat)
+        : allocator_(concat.get_allocator()) {
+        const auto len = concat.length();
+        pointer_type buffer = prepare(len);
+        concat.write(buffer);
+        buffer[len] = '\0';
     }
 
     basic_string(basic_string&& other) noexcept
-        : capacity_(other.capacity_)
-        , length_(other.length_)
-        , data_(exchange(other.data_, nullptr)) {
+        : allocator_(other.allocator_) {
+        // both layouts live inside the object, so stealing is a plain byte copy.
+        std::memcpy(static_cast<void*>(&heap_), &other.heap_, sizeof(heap_));
+        other.set_inline_length(0);
     }
 
     basic_string& operator=(const basic_string& other) {
@@ -152,56 +272,51 @@ public:
     }
 
     ~basic_string() noexcept {
-        delete[] data_;
+        details::string_stats_destroyed(length(), is_inline() ? 0 : heap_capacity());
+        if (!is_inline())
+            deallocate_buffer(heap_.data_, heap_capacity());
     }
 
     void swap(basic_string& other) noexcept {
-        const auto data_swapper = other.data_;
-        const auto length_swapper = other.length_;
-        const auto capacity_swapper = other.capacity_;
-
-        other.data_ = data_;
-        other.length_ = length_;
-        other.capacity_ = capacity_;
-
-
-        data_ = data_swapper;
-        length_ = length_swapper;
-        capacity_ = capacity_swapper;
+        unsigned char swapper[sizeof(heap_)];
+        allocator_type allocator_swapper = other.allocator_;
+        other.allocator_ = allocator_;
+        allocator_ = allocator_swapper;
 
+        std::memcpy(swapper, &other.heap_, sizeof(heap_));
+        std::memcpy(static_cast<void*>(&other.heap_), &heap_, sizeof(heap_));
+        std::memcpy(static_cast<void*>(&heap_), swapper, sizeof(heap_));
     }
 
     reference_type operator[](size_type index) noexcept {
-        return data_[index];
+        return data()[index];
     }
 
     const reference_type operator[](size_type index) const noexcept {
-        return data_[index];
+        return data()[index];
     }
 
-    inline NODISCARD operator string_view() const noexcept { 
-        return { data_ ,length_ };
+    inline NODISCARD operator string_view() const noexcept {
+        return { data() ,length() };
     }
 
     inline NODISCARD bool operator==(const_pointer_type other) const noexcept {
-        return
-            data_[0] == other[0]
-            && std::strncmp(data_, other.data(), sizeof(value_type) * length_) == 0;
+        return *this == string_view(other);
     }
 
     inline NODISCARD bool operator==(string_view other) const noexcept {
+        const auto len = length();
         return
-            length_ == other.length()
-            && data_[0] == other[0]
-            && std::memcmp(data_, other.data(), sizeof(value_type) * length_) == 0;
+            len == other.length()
+            && std::memcmp(data(), other.data(), sizeof(value_type) * len) == 0;
     }
 
     inline NODISCARD bool operator<(string_view other) const noexcept {
-        return std::memcmp(data_, other.data(), sizeof(value_type) * length_) == 1;
+        return compare(other) < 0;
     }
 
     inline NODISCARD bool operator>(string_view other) const noexcept {
-        return std::memcmp(data_, other.data(), sizeof(value_type) * length_) == -1;
+        return compare(other) > 0;
     }
 
     inline NODISCARD bool operator!=(const_pointer_type other) const noexcept {
@@ -213,11 +328,11 @@ public:
     }
 
     inline NODISCARD bool operator<(const_pointer_type other) const noexcept {
-        return std::strncmp(data_, other.data(), sizeof(value_type) * length_) == 1;
+        return compare(string_view(other)) < 0;
     }
 
     inline NODISCARD bool operator>(const_pointer_type other) const noexcept {
-        return std::strncmp(data_, other.data(), sizeof(value_type) * length_) == -1;
+        return compare(string_view(other)) > 0;
     }
 
     inline NODISCARD bool operator<=(const_pointer_type other) const noexcept {
@@ -241,232 +356,555 @@ public:
     bool operator<=(std::nullptr_t) const = delete;
     bool operator>=(std::nullptr_t) const = delete;
 
-    inline NODISCARD basic_string operator+(string_view other) const {
-        const auto sum = length_ + other.length();
-        pointer_type ret_string = new value_type[sum];
+    inline NODISCARD basic_string_concat<value_type, allocator_type, string_view> operator+(string_view other) const& noexcept {
+        return { *this, other, allocator_ };
+    }
+
+    // the left side is a temporary anyway, so grow its buffer instead of making a new one.
+    inline NODISCARD basic_string operator+(string_view other) && {
+        *this += other;
+        return move(*this);
+    }
+
+    template<typename Left>
+    inline NODISCARD basic_string operator+(const basic_string_concat<value_type, allocator_type, Left>& concat) && {
+        *this += concat;
+        return move(*this);
+    }
+
+    template<typename Left>
+    inline basic_string& operator+=(const basic_string_concat<value_type, allocator_type, Left>& concat) {
+        const auto len = length();
+        const auto sum = len + concat.length();
 
-        std::memcpy(ret_string, data_, length_ * sizeof(value_type));
+        if (sum >= capacity()) {
+            // the pieces can point into this string, so the old buffer goes last.
+            const auto new_capacity = calc_growth(sum);
+            pointer_type buffer = allocate_buffer(new_capacity);
+            details::copy_chars(buffer, data(), len);
+            concat.write(buffer + len);
+            buffer[sum] = '\0';
+            adopt_buffer(buffer, sum, new_capacity);
+            return *this;
+        }
 
-        std::memcpy(ret_string + length_, other.data(), other.length() * sizeof(value_type));
+        concat.write(data() + len);
 
-        ret_string[sum] = '\0';
-        return { ret_string , sum };
+        set_length(sum);
+        return *this;
     }
 
     inline basic_string& operator+=(string_view other) {
-        const auto sum = length_ + other.length();
+        const auto len = length();
+        const auto sum = len + other.length();
+        const_pointer_type from = other.data();
+
+        if (sum >= capacity()) {
+            const_pointer_type old_data = data();
+            if (from >= old_data && from <= old_data + len) {
+                // `other` is a piece of this string, it moves along with the rest.
+                const auto offset = from - old_data;
+                reallocate(calc_growth(sum));
+                from = data() + offset;
+            }
+            else {
+                reallocate(calc_growth(sum));
+            }
+        }
+
+        details::copy_chars(data() + len, from, other.length());
+
+        set_length(sum);
+        return *this;
+    }
+
+    // a single character. without this `s += ' '` would go through string_view's
+    // character constructor, which points at its own parameter.
+    inline basic_string& operator+=(value_type ch) {
+        const auto len = length();
+        if (len + 1 >= capacity()) {
+            reallocate(calc_growth(len + 1));
+        }
 
-        if (sum >= capacity_) {
+        data()[len] = ch;
+        set_length(len + 1);
+        return *this;
+    }
+
+    // makes room for up to `max_amount` more characters, growing the way appends do, and
+    // lets `writer` put them straight in place. writer(pointer_type) returns how many it
+    // actually wrote.
+    template<typename Writer>
+    inline basic_string& append_for_overwrite(size_type max_amount, Writer&& writer) {
+        const auto len = length();
+        const auto sum = len + max_amount;
+
+        if (sum >= capacity()) {
             reallocate(calc_growth(sum));
         }
 
-        std::memcpy(data_ + length_, other.data(), other.length() * sizeof(value_type));
+        const size_type written = writer(data() + len);
 
-        data_[sum] = '\0';
+        set_length(len + written);
         return *this;
     }
 
-    inline NODISCARD size_type length()   const noexcept { return length_; }
-    inline NODISCARD size_type capacity() const noexcept { return capacity_; }
+    inline NODISCARD size_type length()   const noexcept { return is_inline() ? inline_length() : heap_.length_; }
+    inline NODISCARD size_type capacity() const noexcept { return is_inline() ? sso_capacity + 1 : heap_capacity(); }
     inline NODISCARD size_type max_size() const noexcept { return INT_LEAST32_MAX; }
-    inline NODISCARD pointer_type data()  const noexcept { return data_; }
+    inline NODISCARD pointer_type data()  const noexcept {
+        return is_inline() ? const_cast<pointer_type>(inline_) : heap_.data_;
+    }
+    inline NODISCARD bool is_inline() const noexcept {
+        return (reinterpret_cast<const unsigned char*>(&heap_)[sizeof(heap_) - 1] & heap_flag_byte_) == 0;
+    }
     inline NODISCARD size_type find(string_view str, size_type from_index = 0) const noexcept {
-        const auto diff = length_ - str.length();
-        if (length_ < str.length())
-            return npos;
-
-        for (size_type i = from_index; i < diff; i++) {
-            if (std::memcmp(data_ + i, str.data(), sizeof(value_type) * str.length()) == 0) {
-                return i;
-            }
-        }
-        return npos;
+        return string_view(*this).find(str, from_index);
     }
 
     inline NODISCARD size_type find(value_type ch, size_type from_index = 0) const noexcept {
-        size_type length = length_ - 1;
-        for (size_type i = from_index; i < length; i++) {
-            if (data_[i] == ch) {
-                return i;
-            }
-        }
-        return npos;
+        return string_view(*this).find(ch, from_index);
+    }
+
+    inline NODISCARD size_type rfind(string_view str, size_type from_index = npos) const noexcept {
+        return string_view(*this).rfind(str, from_index);
     }
 
-    inline NODISCARD bool is_empty() const noexcept { return length_ == 0; }
+    inline NODISCARD size_type rfind(value_type ch, size_type from_index = npos) const noexcept {
+        return string_view(*this).rfind(ch, from_index);
+    }
 
-    inline basic_string& replace(string_view str, string_view with) {
-        const auto pos = find(str);
-        if (pos == npos)
-            return *this;
+    inline NODISCARD size_type find_first_of(string_view set, size_type from_index = 0) const noexcept {
+        return string_view(*this).find_first_of(set, from_index);
+    }
+
+    inline NODISCARD size_type count(string_view str) const noexcept {
+        return string_view(*this).count(str);
+    }
+
+    inline NODISCARD size_type count(value_type ch) const noexcept {
+        return string_view(*this).count(ch);
+    }
+
+    inline NODISCARD bool is_empty() const noexcept { return length() == 0; }
 
-        if (str.length() == with.length()) {
-            std::memcpy(data_ + pos, with.data(), sizeof(value_type) * with.length());
+    // replaces every non overlapping match, left to right, with one scan of the string.
+    // shrinking replacements compact in place, growing ones move the pieces to their
+    // final offsets in one go, in place when the capacity allows it or into a single
+    // new buffer otherwise.
+    inline basic_string& replace_all(string_view from, string_view to) {
+        if (from.length() == 0)
             return *this;
-        }
 
-        if ((with.length() + length_) >= capacity_) {
-            reallocate(calc_growth(std::max(with.length(),length_)));
+        if (overlaps(from) || overlaps(to)) {
+            // both passes write over the string while still reading `from` and `to`.
+            const basic_string from_copy(from.data(), from.length(), allocator_);
+            const basic_string to_copy(to.data(), to.length(), allocator_);
+            return replace_all(from_copy, to_copy);
         }
 
-        const auto jump_pos = pos + with.length();
+        if (to.length() <= from.length()) {
+            replace_all_in_place(from, to);
+            return *this;
+        }
 
+        const auto len = length();
+        const_pointer_type data = this->data();
 
-        if (str.length() > with.length()) {
-            const auto diff = str.length() - with.length();
-            erase(jump_pos, diff);
+        constexpr size_type max_positions = 64;
+        size_type positions[max_positions];
+        size_type count = 0;
+        for (auto pos = find_from(data, len, from, 0); pos != npos; pos = find_from(data, len, from, pos + from.length())) {
+            if (count < max_positions)
+                positions[count] = pos;
+            count++;
+        }
 
-            std::memcpy(data_ + pos, with.data(), sizeof(value_type) * with.length());
+        if (count == 0)
+            return *this;
 
+        const auto new_len = len + count * (to.length() - from.length());
+
+        if (count <= max_positions && new_len < capacity()) {
+            // back to front, every piece moves right so nothing unread gets overwritten.
+            pointer_type out = this->data();
+            auto read_end = len;
+            auto write_end = new_len;
+            for (auto i = count; i != 0; i--) {
+                const auto tail = positions[i - 1] + from.length();
+                write_end -= read_end - tail;
+                details::move_chars(out + write_end, out + tail, read_end - tail);
+                write_end -= to.length();
+                details::copy_chars(out + write_end, to.data(), to.length());
+                read_end = positions[i - 1];
+            }
+            set_length(new_len);
+            return *this;
         }
-        else {
-            const auto diff = with.length() - str.length();
-            const auto offset = (length_ - diff) -1;
 
-            for (auto i = length_; i != offset; i--)
-                data_[i + diff] = data_[i];
+        pointer_type buffer = allocate_buffer(new_len + 1);
+        size_type read = 0;
+        size_type write = 0;
+        const auto stored = count < max_positions ? count : max_positions;
+        for (size_type i = 0; i < stored || count > max_positions; i++) {
+            // past the stored positions keep searching where the last match ended.
+            const auto pos = i < stored ? positions[i] : find_from(data, len, from, read);
+            if (pos == npos)
+                break;
+
+            details::copy_chars(buffer + write, data + read, pos - read);
+            write += pos - read;
+            details::copy_chars(buffer + write, to.data(), to.length());
+            write += to.length();
+            read = pos + from.length();
+        }
+        details::copy_chars(buffer + write, data + read, len - read);
+        buffer[new_len] = '\0';
 
-            std::memcpy(data_ + pos, with.data(), sizeof(value_type) * with.length());
+        adopt_buffer(buffer, new_len, new_len + 1);
+        return *this;
+    }
 
-            length_ += (with.length() - str.length());
-            data_[length_] = '\0';
+    // every `from` character becomes `to`, the length stays the same.
+    inline basic_string& replace_all(value_type from, value_type to) noexcept {
+        pointer_type data = this->data();
+        const auto len = length();
+        for (size_type i = 0; i < len; i++) {
+            if (data[i] == from)
+                data[i] = to;
         }
         return *this;
     }
 
-    void insert(size_type offset, string_view str) {
-        if (offset > length_)
-            offset = length_;
+    inline basic_string& replace(string_view str, string_view with) {
+        const auto pos = find(str);
+        if (pos == npos)
+            return *this;
+
+        return splice(pos, str.length(), with);
+    }
+
+    // replaces the `amount` characters at `offset` with `with`. the tail moves once,
+    // with memmove, and when the result doesn't fit the prefix, `with` and the tail
+    // are copied straight into the new buffer instead.
+    basic_string& splice(size_type offset, size_type amount, string_view with) {
+        const auto len = length();
+        if (offset > len)
+            offset = len;
 
-        const auto sum = str.length() + length_;
+        if (amount > (len - offset))
+            amount = (len - offset);
 
-        if (sum >= capacity_)
-            reallocate(calc_growth(sum));
+        const auto new_len = len - amount + with.length();
+        const auto tail = offset + amount;
+
+        if (new_len >= capacity()) {
+            const auto new_capacity = calc_growth(new_len);
+            const_pointer_type data = this->data();
+            pointer_type buffer = allocate_buffer(new_capacity);
+
+            details::copy_chars(buffer, data, offset);
+            details::copy_chars(buffer + offset, with.data(), with.length());
+            details::copy_chars(buffer + offset + with.length(), data + tail, len - tail);
+            buffer[new_len] = '\0';
 
+            adopt_buffer(buffer, new_len, new_capacity);
+            return *this;
+        }
 
-        //std::memmove(
-        //    data_ + sum,
-        //    data_ + (sum - str.length()),
-        //    sizeof(value_type) * offset
-        //);
-        for (auto i = sum; i != offset; i--)
-            data_[i] = data_[i - str.length()];
+        pointer_type data = this->data();
+        if (overlaps(with)) {
+            // `with` is a piece of this string and the move below could overwrite it.
+            const basic_string copy(with.data(), with.length(), allocator_);
+            return splice(offset, amount, copy);
+        }
 
-        for (auto i = offset; i != offset + str.length(); i++)
-            data_[i] = str[i - offset];
+        details::move_chars(data + offset + with.length(), data + tail, len - tail);
+        details::copy_chars(data + offset, with.data(), with.length());
+        set_length(new_len);
+        return *this;
+    }
 
-        //std::memmove(
-        //    data_ + offset,
-        //    data_,
-        //    sizeof(value_type) * (offset + str.length())
-        //);
-        length_ = sum;
-        data_[length_] = '\0';
+    basic_string& insert(size_type offset, string_view str) {
+        return splice(offset, 0, str);
     }
 
-    void erase(size_type offset, size_type amount = 1) {
-        if (length_ == 0 || amount == 0)
-            return;
+    basic_string& insert(size_type offset, value_type ch) {
+        return splice(offset, 0, string_view(&ch, 1));
+    }
 
-        if (offset > length_)
-            offset = length_;
+    // never gives memory back, see shrink_to_fit.
+    basic_string& erase(size_type offset, size_type amount = 1) {
+        return splice(offset, amount, string_view(data(), 0));
+    }
 
-        if (amount > ((length_ - offset) + 1))
-            amount = (length_ - offset);
+    // reallocates to fit the current length, but only when the spare room is more than
+    // both policy.min_unused characters and policy.max_unused_percent of the capacity.
+    // the default policy always shrinks. strings that stay inline have nothing to give back.
+    void shrink_to_fit(shrink_policy policy = {}) {
+        if (is_inline())
+            return;
 
-        for (auto i = offset; i < length_; i++)
-            data_[i] = data_[i + amount];
+        const auto cap = capacity();
+        const auto unused = cap - (length() + 1);
+        if (unused <= policy.min_unused || unused * 100 <= cap * policy.max_unused_percent)
+            return;
 
-        length_ -= amount;
-        data_[length_] = '\0';
-        if (length_ > (capacity_ / 2))
-            reallocate(length_ + 1);
+        reallocate(length() + 1);
     }
 
     void clear() noexcept {
-        length_ = 0;
+        set_length(0);
     }
 
     basic_string substr(size_type index, size_type amount = -1) const {
-        if (index >= length_)
-            return { "" ,0 };
-
-        if (amount > (length_ - index))
-            amount = length_ - index;
+        const auto len = length();
+        if (index >= len)
+            return basic_string(allocator_);
 
-        pointer_type ret_string = new value_type[amount + 1];
+        if (amount > (len - index))
+            amount = len - index;
 
-        std::memcpy(ret_string, data_ + index, sizeof(value_type) * amount + 1);
+        return { data() + index,amount,allocator_ };
+    }
 
-        return { ret_string,amount };
+    inline void reserve(size_type amount) {
+        if (amount > capacity())
+            reallocate(amount);
     }
 
-    inline void reserve(size_type amount) { reallocate(amount); }
+    // makes the string `length` characters long, keeping the ones it has. the characters
+    // past the old length are left as they happen to be, for the caller to write.
+    inline void resize_for_overwrite(size_type length) {
+        if (length >= capacity())
+            reallocate(length + 1);
+        set_length(length);
+    }
 
-    inline NODISCARD iterator begin() noexcept { return data_ + 0; }
-    inline NODISCARD iterator end() noexcept { return data_ + length_ + 1; }
-    inline NODISCARD const_iterator begin() const noexcept { return data_ + 0; }
-    inline NODISCARD const_iterator end() const noexcept { return data_ + length_ + 1; }
-    inline NODISCARD reverse_iterator rbegin() noexcept { return (data_ + length_)-1; }
-    inline NODISCARD reverse_iterator rend() noexcept { return data_ - 1; }
+    inline NODISCARD iterator begin() noexcept { return data() + 0; }
+    inline NODISCARD iterator end() noexcept { return data() + length() + 1; }
+    inline NODISCARD const_iterator begin() const noexcept { return data() + 0; }
+    inline NODISCARD const_iterator end() const noexcept { return data() + length() + 1; }
+    inline NODISCARD reverse_iterator rbegin() noexcept { return (data() + length())-1; }
+    inline NODISCARD reverse_iterator rend() noexcept { return data() - 1; }
 
-    inline NODISCARD const_reverse_iterator rbegin() const noexcept { return (data_ + length_) - 1; }
-    inline NODISCARD const_reverse_iterator rend() const noexcept { return data_ - 1; }
+    inline NODISCARD const_reverse_iterator rbegin() const noexcept { return (data() + length()) - 1; }
+    inline NODISCARD const_reverse_iterator rend() const noexcept { return data() - 1; }
 
     inline NODISCARD const_reverse_iterator crbegin() const noexcept { return rbegin(); }
     inline NODISCARD const_reverse_iterator crend() const noexcept { return rend(); }
 
     inline NODISCARD const_iterator cbegin() const noexcept { return begin(); }
     inline NODISCARD const_iterator cend() const noexcept { return end(); }
-    
-    inline NODISCARD reference_type back() noexcept { return data_[0]; }
-    inline NODISCARD reference_type front() noexcept { return data_[length_ - 1]; }
-    inline NODISCARD const_reference_type back() const noexcept { return data_[0]; }
-    inline NODISCARD const_reference_type front() const noexcept { return data_[length_ - 1]; }
+
+    inline NODISCARD reference_type back() noexcept { return data()[0]; }
+    inline NODISCARD reference_type front() noexcept { return data()[length() - 1]; }
+    inline NODISCARD const_reference_type back() const noexcept { return data()[0]; }
+    inline NODISCARD const_reference_type front() const noexcept { return data()[length() - 1]; }
 
     inline void push_front(string_view str) {
         insert(0, str);
     }
+    inline void push_front(value_type ch) {
+        insert(0, ch);
+    }
     inline void push_back(string_view str) {
         insert(-1, str);
     }
+    inline void push_back(value_type ch) {
+        *this += ch;
+    }
 
     inline void pop_front() {
-        erase(-1, 1);
+        erase(0, 1);
     }
 
     inline void pop_back() {
-        erase(0, 1);
+        if (!is_empty())
+            erase(length() - 1, 1);
     }
 
-    inline int compare(string_view str) const noexcept {
-        return std::strncmp(data_,str.data(), length_);
+    // lexicographic over the characters as unsigned values, a prefix is less than the
+    // longer string. negative, zero or positive like strcmp.
+    inline NODISCARD int compare(string_view str) const noexcept {
+        return details::compare_chars(data(), length(), str.data(), str.length());
     }
+
+    inline NODISCARD allocator_type get_allocator() const noexcept { return allocator_; }
 private:
-    size_type capacity_;
-    size_type length_;
-    pointer_type data_;
+    // heap layout. when the string is inline the same bytes hold the characters and
+    // the last character slot holds (sso_capacity - length), which doubles as the
+    // terminator once the buffer is full. the heap flag lives in the byte that slot
+    // never sets, the top bit of capacity_ on little endian and the low bit on big endian.
+    struct heap_type {
+        pointer_type data_;
+        size_type length_;
+        size_type capacity_;
+    };
+
+    union {
+        heap_type heap_;
+        value_type inline_[sso_capacity + 1];
+    };
+    NO_UNIQUE_ADDRESS allocator_type allocator_;
+
+    static_assert(sizeof(heap_type) == sizeof(value_type) * (sso_capacity + 1), "inline buffer must overlay the heap layout exactly");
+
+    static constexpr bool little_endian_ = std::endian::native == std::endian::little;
+    static constexpr unsigned inline_shift_ = little_endian_ ? 0 : 1;
+    static constexpr unsigned char heap_flag_byte_ = little_endian_ ? 0x80 : 0x01;
+    static constexpr size_type heap_flag_ = little_endian_ ? ~(~size_type(0) >> 1) : size_type(1);
 private:
+    inline NODISCARD size_type inline_length() const noexcept {
+        return sso_capacity - (static_cast<size_type>(inline_[sso_capacity]) >> inline_shift_);
+    }
+
+    inline void set_inline_length(size_type length) noexcept {
+        inline_[sso_capacity] = static_cast<value_type>((sso_capacity - length) << inline_shift_);
+        inline_[length] = '\0';
+    }
+
+    inline NODISCARD size_type heap_capacity() const noexcept {
+        return little_endian_ ? heap_.capacity_ & ~heap_flag_ : heap_.capacity_ >> 1;
+    }
+
+    inline void set_heap_capacity(size_type capacity) noexcept {
+        heap_.capacity_ = little_endian_ ? capacity | heap_flag_ : (capacity << 1) | heap_flag_;
+    }
+
+    inline void set_length(size_type length) noexcept {
+        if (is_inline()) {
+            set_inline_length(length);
+            return;
+        }
+        heap_.length_ = length;
+        heap_.data_[length] = '\0';
+    }
+
+    // sets up an empty string for `length` characters and returns where they go.
+    // the caller writes the characters and the terminator.
+    inline NODISCARD pointer_type prepare(size_type length) {
+        if (length <= sso_capacity) {
+            set_inline_length(length);
+            return inline_;
+        }
+        heap_.data_ = allocate_buffer(length + 1);
+        heap_.length_ = length;
+        set_heap_capacity(length + 1);
+        return heap_.data_;
+    }
+
+    // whether `str` shares characters with this string.
+    inline NODISCARD bool overlaps(string_view str) const noexcept {
+        const_pointer_type data = this->data();
+        return str.data() + str.length() > data && str.data() < data + length();
+    }
+
+    // the not longer half of replace_all. the write cursor never passes the read
+    // cursor, so the rest of the string can be searched while it is being rewritten.
+    inline void replace_all_in_place(string_view from, string_view to) noexcept {
+        const auto len = length();
+        auto pos = find(from);
+        if (pos == npos)
+            return;
+
+        pointer_type data = this->data();
+        auto write = pos;
+        while (pos != npos) {
+            details::copy_chars(data + write, to.data(), to.length());
+            write += to.length();
+
+            const auto read = pos + from.length();
+            pos = find_from(data, len, from, read);
+            const auto end = pos == npos ? len : pos;
+            details::move_chars(data + write, data + read, end - read);
+            write += end - read;
+        }
+        set_length(write);
+    }
+
+    static inline NODISCARD size_type find_from(const_pointer_type data, size_type length, string_view str, size_type from_index) noexcept {
+        const auto pos = details::find_substring(data + from_index, length - from_index, str.data(), str.length());
+        return pos == npos ? npos : pos + from_index;
+    }
+
+    // allocator_ with the XED_STRING_STATS hooks, every heap buffer goes through these.
+    inline NODISCARD pointer_type allocate_buffer(size_type capacity) {
+        pointer_type buffer = allocator_.allocate(capacity);
+        details::string_stats_allocated(sizeof(value_type) * capacity);
+        return buffer;
+    }
+
+    inline void deallocate_buffer(pointer_type buffer, size_type capacity) noexcept {
+        details::string_stats_deallocated();
+        allocator_.deallocate(buffer, capacity);
+    }
+
+    // swaps in a heap buffer that came from allocate_buffer, freeing the current one.
+    inline void adopt_buffer(pointer_type buffer, size_type length, size_type capacity) noexcept {
+        details::string_stats_reallocated();
+        if (!is_inline())
+            deallocate_buffer(heap_.data_, heap_capacity());
+
+        heap_.data_ = buffer;
+        heap_.length_ = length;
+        set_heap_capacity(capacity);
+    }
+
     inline void reallocate(size_type new_capacity) {
-        // i use the arg insead of member so when new throws the capacity stays the same!
-        pointer_type buffer = new value_type[new_capacity];
-        capacity_ = new_capacity;
+        const auto len = length();
+        if (new_capacity <= len)
+            new_capacity = len + 1;
+
+        if (new_capacity <= sso_capacity + 1) {
+            if (is_inline())
+                return;
+
+            pointer_type old_data = heap_.data_;
+            const auto old_capacity = heap_capacity();
+            details::copy_chars(inline_, old_data, len);
+            set_inline_length(len);
+            deallocate_buffer(old_data, old_capacity);
+            details::string_stats_reallocated();
+            return;
+        }
 
-        std::memcpy(buffer, data_, sizeof(value_type) * (length_ + 1));
+        // allocators that can, like arena_allocator, grow the buffer where it is.
+        if constexpr (requires(allocator_type& a, pointer_type p, size_type n) { { a.try_grow(p, n, n) } -> std::same_as<bool>; }) {
+            if (!is_inline() && new_capacity > heap_capacity() && allocator_.try_grow(heap_.data_, heap_capacity(), new_capacity)) {
+                set_heap_capacity(new_capacity);
+                return;
+            }
+        }
 
-        delete[] data_;
+        // i use the arg insead of member so when new throws the capacity stays the same!
+        pointer_type buffer = allocate_buffer(new_capacity);
+        details::string_stats_reallocated();
 
-        data_ = buffer;
+        if (is_inline()) {
+            // the whole inline buffer is a fixed size copy and always holds the terminator.
+            details::copy_chars(buffer, inline_, sso_capacity + 1);
+        }
+        else {
+            details::copy_chars(buffer, heap_.data_, len + 1);
+            deallocate_buffer(heap_.data_, heap_capacity());
+        }
 
+        heap_.data_ = buffer;
+        heap_.length_ = len;
+        set_heap_capacity(new_capacity);
     }
-    constexpr inline NODISCARD size_type calc_growth(size_type extra_size = 0) const noexcept {
-        return ((capacity_ * 3) / 2) + extra_size;
+    inline NODISCARD size_type calc_growth(size_type required_length = 0) const noexcept {
+        details::string_stats_grew();
+        const auto grown = (capacity() * 3) / 2;
+        return grown > required_length ? grown : required_length + 1;
     }
 
 };
 
-template<typename CharType>
-std::ostream& operator<<(std::ostream& o, const xed::basic_string<CharType>& s) {
+
+template<typename CharType, typename Allocator>
+std::ostream& operator<<(std::ostream& o, const xed::basic_string<CharType, Allocator>& s) {
     for (const auto c : s)
         o << c;
     return o;
@@ -478,28 +916,70 @@ using u8string  = basic_string<char8_t>;
 using u16string = basic_string<char16_t>;
 using u32string = basic_string<char32_t>;
 
-string to_lowercase(const string& str) {
-    constexpr static char CHAR_TO_LOWERCASE_LOOKUP_TABLE[256] = { -128,-127,-126,-125,-124,-123,-122,-121,-120,-119,-118,-117,-116,-115,-114,-113,-112,-111,-110,-109,-108,-107,-106,-105,-104,-103,-102,-101,-100,-99,-98,-97,-96,-95,-94,-93,-92,-91,-90,-89,-88,-87,-86,-85,-84,-83,-82,-81,-80,-79,-78,-77,-76,-75,-74,-73,-72,-71,-70,-69,-68,-67,-66,-65,-64,-63,-62,-61,-60,-59,-58,-57,-56,-55,-54,-53,-52,-51,-50,-49,-48,-47,-46,-45,-44,-43,-42,-41,-40,-39,-38,-37,-36,-35,-34,-33,-32,-31,-30,-29,-28,-27,-26,-25,-24,-23,-22,-21,-20,-19,-18,-17,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,64,97,98,99,100,101,102,103,104,105,106,107,108,109,110,111,112,113,114,115,116,117,118,119,120,121,122,91,92,93,94,95,96,97,98,99,100,101,102,103,104,105,106,107,108,109,110,111,112,113,114,115,116,117,118,119,120,121,122,123,124,125,126,127 };
+// strings that live in a monotonic_arena, all of them go away with arena.release().
+template<typename CharType>
+using arena_basic_string = basic_string<CharType, arena_allocator<CharType>>;
+
+using arena_string = arena_basic_string<char>;
+
+namespace details {
+// flips bit 5 of every byte in [first, first + 25], the ascii letters of one case.
+// the range test is the usual bias trick: after adding (0x80 - first) the letters
+// are exactly the bytes that compare signed-less than 0x80 + 26.
+inline void ascii_flip_case(const byte_type* src, byte_type* dst, std::size_t length, byte_type first) noexcept {
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    const auto bias = simd_block::splat(static_cast<byte_type>(0x80 - first));
+    const auto limit = simd_block::splat(static_cast<byte_type>(0x80 + 26));
+    const auto flip = simd_block::splat(0x20);
+    for (; i + simd_block::size <= length; i += simd_block::size) {
+        const auto block = simd_block::load(src + i);
+        const auto in_range = simd_block::less(simd_block::add(block, bias), limit);
+        simd_block::store(dst + i, simd_block::bit_xor(block, simd_block::bit_and(in_range, flip)));
+    }
+#endif
+    for (; i < length; i++) {
+        const byte_type ch = src[i];
+        const bool is_letter = static_cast<byte_type>(ch - first) < 26;
+        dst[i] = static_cast<byte_type>(ch ^ (is_letter << 5));
+    }
+}
+} // namespace details
+
+// the caller's buffer needs room for str.length() characters, no terminator is
+// written. returns one past the last character written.
+inline char* to_lowercase(string_view str, char* out) noexcept {
+    details::ascii_flip_case(details::as_bytes(str.data()), reinterpret_cast<details::byte_type*>(out), str.length(), 'A');
+    return out + str.length();
+}
 
-    const auto len = str.length();
-    char* data = new char[len+1];
-    for (auto i = 0ULL; i < len; i++) {
-        data[i] = CHAR_TO_LOWERCASE_LOOKUP_TABLE[str[i] + 128];
-   }
+inline char* to_uppercase(string_view str, char* out) noexcept {
+    details::ascii_flip_case(details::as_bytes(str.data()), reinterpret_cast<details::byte_type*>(out), str.length(), 'a');
+    return out + str.length();
+}
 
-    return { data,len,nullptr };
+template<typename Allocator>
+inline void make_lowercase(basic_string<char, Allocator>& str) noexcept {
+    to_lowercase(str, str.data());
 }
 
-string to_uppercase(const string& str) {
-    constexpr static char CHAR_TO_UPPERCASE_LOOKUP_TABLE[256] = { -128,-127,-126,-125,-124,-123,-122,-121,-120,-119,-118,-117,-116,-115,-114,-113,-112,-111,-110,-109,-108,-107,-106,-105,-104,-103,-102,-101,-100,-99,-98,-97,-96,-95,-94,-93,-92,-91,-90,-89,-88,-87,-86,-85,-84,-83,-82,-81,-80,-79,-78,-77,-76,-75,-74,-73,-72,-71,-70,-69,-68,-67,-66,-65,-64,-63,-62,-61,-60,-59,-58,-57,-56,-55,-54,-53,-52,-51,-50,-49,-48,-47,-46,-45,-44,-43,-42,-41,-40,-39,-38,-37,-36,-35,-34,-33,-32,-31,-30,-29,-28,-27,-26,-25,-24,-23,-22,-21,-20,-19,-18,-17,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,75,76,77,78,79,80,81,82,83,84,85,86,87,88,89,90,91,92,93,94,95,96,65,66,67,68,69,70,71,72,73,74,75,76,77,78,79,80,81,82,83,84,85,86,87,88,89,90,123,124,125,126,127 };
+template<typename Allocator>
+inline void make_uppercase(basic_string<char, Allocator>& str) noexcept {
+    to_uppercase(str, str.data());
+}
 
-    const auto len = str.length();
-    char* data = new char[len + 1];
-    for (auto i = 0ULL; i < len; i++) {
-        data[i] = CHAR_TO_UPPERCASE_LOOKUP_TABLE[str[i] + 128];
-    }
+template<typename Allocator>
+inline NODISCARD basic_string<char, Allocator> to_lowercase(const basic_string<char, Allocator>& str) {
+    basic_string<char, Allocator> ret = str;
+    make_lowercase(ret);
+    return ret;
+}
 
-    return { data,len,nullptr };
+template<typename Allocator>
+inline NODISCARD basic_string<char, Allocator> to_uppercase(const basic_string<char, Allocator>& str) {
+    basic_string<char, Allocator> ret = str;
+    make_uppercase(ret);
+    return ret;
 }
 
 INLINE_NAMESPACE namespace literals {
@@ -0,0 +1,360 @@
+#pragma once
+#ifndef XED_CASE_INSENSITIVE_HPP
+#define XED_CASE_INSENSITIVE_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "xutility.hpp"
+#include "simd.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "hash.hpp"
+#include "has_attributes.hpp"
+
+// comparing and searching with ascii letters folded to lower case on the fly, for
+// header names and the like. nothing gets copied, the folding happens in registers.
+// only 'A' to 'Z' fold, every other character, also outside of ascii, has to match
+// exactly.
+
+namespace xed {
+namespace details {
+
+constexpr NODISCARD byte_type ascii_lower(byte_type ch) noexcept {
+    return static_cast<byte_type>(ch - 'A') < 26 ? static_cast<byte_type>(ch | 0x20) : ch;
+}
+
+template<typename CharType>
+constexpr NODISCARD CharType ascii_lower_char(CharType ch) noexcept {
+    return ch >= CharType('A') && ch <= CharType('Z') ? static_cast<CharType>(ch + ('a' - 'A')) : ch;
+}
+
+// 8 bytes at once: the high bit of a byte ends up set where it is 'A' to 'Z', shifted
+// down it is the 0x20 that makes it lower case. no carry crosses a byte, the top bit is
+// masked off before the adds.
+constexpr NODISCARD std::uint64_t ascii_lower_word(std::uint64_t word) noexcept {
+    constexpr std::uint64_t ones = 0x0101010101010101ull;
+    const auto heptets = word & (0x7f * ones);
+    const auto at_least_a = heptets + ((0x80 - 'A') * ones);
+    const auto past_z = heptets + ((0x7f - 'Z') * ones);
+    const auto upper = at_least_a & ~past_z & ~word & (0x80 * ones);
+    return word | (upper >> 2);
+}
+
+#if XED_HAS_SIMD_BLOCK
+struct ascii_lower_block {
+    simd_block::register_type bias_ = simd_block::splat(static_cast<byte_type>(0x80 - 'A'));
+    simd_block::register_type limit_ = simd_block::splat(static_cast<byte_type>(0x80 + 26));
+    simd_block::register_type bit_ = simd_block::splat(0x20);
+
+    // the same bias trick as ascii_flip_case.
+    inline NODISCARD simd_block::register_type operator()(simd_block::register_type block) const noexcept {
+        const auto in_range = simd_block::less(simd_block::add(block, bias_), limit_);
+        return simd_block::bit_or(block, simd_block::bit_and(in_range, bit_));
+    }
+};
+#endif
+
+// the first offset where the two differ after folding, or `length`.
+inline NODISCARD std::size_t ifind_mismatch_bytes(const byte_type* a, const byte_type* b, std::size_t length) noexcept {
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    if (length >= simd_block::size) {
+        constexpr auto all = static_cast<std::uint32_t>((std::uint64_t(1) << simd_block::size) - 1);
+        const ascii_lower_block lower;
+        for (; i + simd_block::size <= length; i += simd_block::size) {
+            const auto same = simd_block::eq_mask(lower(simd_block::load(a + i)), lower(simd_block::load(b + i)));
+            if (same != all)
+                return i + std::countr_one(same);
+        }
+    }
+#endif
+    for (; i + 8 <= length; i += 8) {
+        std::uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        const auto differ = ascii_lower_word(x) ^ ascii_lower_word(y);
+        if (differ != 0) {
+            if constexpr (std::endian::native == std::endian::little)
+                return i + std::countr_zero(differ) / 8;
+            break;
+        }
+    }
+    for (; i < length; i++) {
+        if (ascii_lower(a[i]) != ascii_lower(b[i]))
+            return i;
+    }
+    return length;
+}
+
+// whether the two are the same after folding. the ends are done with loads that overlap
+// what came before instead of a byte loop, comparing twice doesn't change the answer.
+inline NODISCARD bool iequal_bytes(const byte_type* a, const byte_type* b, std::size_t length) noexcept {
+    const auto word_at = [](const byte_type* ptr, std::size_t offset, std::size_t size) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, ptr + offset, size);
+        return ascii_lower_word(word);
+    };
+
+    if (length < 4) {
+        for (std::size_t i = 0; i < length; i++) {
+            if (ascii_lower(a[i]) != ascii_lower(b[i]))
+                return false;
+        }
+        return true;
+    }
+    if (length <= 8) {
+        return word_at(a, 0, 4) == word_at(b, 0, 4) && word_at(a, length - 4, 4) == word_at(b, length - 4, 4);
+    }
+    if (length <= 16) {
+        return word_at(a, 0, 8) == word_at(b, 0, 8) && word_at(a, length - 8, 8) == word_at(b, length - 8, 8);
+    }
+#if XED_HAS_SIMD_BLOCK
+    if (length >= simd_block::size) {
+        const ascii_lower_block lower;
+        auto differ = simd_block::splat(0);
+        std::size_t i = 0;
+        for (; i + simd_block::size < length; i += simd_block::size)
+            differ = simd_block::bit_or(differ, simd_block::bit_xor(lower(simd_block::load(a + i)), lower(simd_block::load(b + i))));
+        i = length - simd_block::size;
+        differ = simd_block::bit_or(differ, simd_block::bit_xor(lower(simd_block::load(a + i)), lower(simd_block::load(b + i))));
+        return simd_block::eq_mask(differ, simd_block::splat(0)) == static_cast<std::uint32_t>((std::uint64_t(1) << simd_block::size) - 1);
+    }
+#endif
+    std::uint64_t differ = 0;
+    std::size_t i = 0;
+    for (; i + 8 < length; i += 8)
+        differ |= word_at(a, i, 8) ^ word_at(b, i, 8);
+    return (differ | (word_at(a, length - 8, 8) ^ word_at(b, length - 8, 8))) == 0;
+}
+
+// find_bytes with folded compares. a letter of the needle matches a text byte exactly
+// when the byte with 0x20 set is the lower case letter, so the candidates cost one or
+// per block and compare, not a whole fold; bytes that aren't letters compare as is.
+inline NODISCARD std::size_t ifind_bytes(const byte_type* data, std::size_t length, const byte_type* needle, std::size_t needle_length) noexcept {
+    if (needle_length == 0)
+        return 0;
+    if (needle_length > length)
+        return npos;
+
+    const auto last = needle_length - 1;
+    const auto first_byte = ascii_lower(needle[0]);
+    const auto last_byte = ascii_lower(needle[last]);
+    const byte_type first_case = first_byte != needle[0] || ascii_lower(static_cast<byte_type>(first_byte ^ 0x20)) == first_byte ? 0x20 : 0;
+    const byte_type last_case = last_byte != needle[last] || ascii_lower(static_cast<byte_type>(last_byte ^ 0x20)) == last_byte ? 0x20 : 0;
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    const auto first_block = simd_block::splat(first_byte);
+    const auto last_block = simd_block::splat(last_byte);
+    const auto first_fold = simd_block::splat(first_case);
+    const auto last_fold = simd_block::splat(last_case);
+    const auto candidates = [&](std::size_t offset) {
+        return simd_block::bit_and(
+            simd_block::eq(simd_block::bit_or(simd_block::load(data + offset), first_fold), first_block),
+            simd_block::eq(simd_block::bit_or(simd_block::load(data + offset + last), last_fold), last_block));
+    };
+    const auto check = [&](std::size_t offset, std::uint32_t mask) {
+        for (; mask != 0; mask &= mask - 1) {
+            const auto candidate = offset + std::countr_zero(mask);
+            if (last < 2 || iequal_bytes(data + candidate + 1, needle + 1, last - 1))
+                return candidate;
+        }
+        return npos;
+    };
+
+    // two blocks per round like find_bytes, one movemask while there is no candidate.
+    for (; i + last + 2 * simd_block::size <= length; i += 2 * simd_block::size) {
+        const auto a = candidates(i);
+        const auto b = candidates(i + simd_block::size);
+        if (simd_block::mask(simd_block::bit_or(a, b)) == 0)
+            continue;
+
+        auto found = check(i, simd_block::mask(a));
+        if (found == npos)
+            found = check(i + simd_block::size, simd_block::mask(b));
+        if (found != npos)
+            return found;
+    }
+    for (; i + last + simd_block::size <= length; i += simd_block::size) {
+        const auto found = check(i, simd_block::mask(candidates(i)));
+        if (found != npos)
+            return found;
+    }
+#endif
+    for (; i + last < length; i++) {
+        if ((data[i] | first_case) == first_byte && (data[i + last] | last_case) == last_byte
+            && (last < 2 || iequal_bytes(data + i + 1, needle + 1, last - 1)))
+            return i;
+    }
+    return npos;
+}
+
+// generic entry points, the byte kernels for 1 byte characters at run time and plain
+// loops otherwise.
+
+template<typename CharType>
+constexpr NODISCARD std::size_t ifind_mismatch(const CharType* a, const CharType* b, std::size_t length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return ifind_mismatch_bytes(as_bytes(a), as_bytes(b), length);
+    }
+    for (std::size_t i = 0; i < length; i++) {
+        if (ascii_lower_char(a[i]) != ascii_lower_char(b[i]))
+            return i;
+    }
+    return length;
+}
+
+template<typename CharType>
+constexpr NODISCARD bool iequal_chars(const CharType* a, const CharType* b, std::size_t length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return iequal_bytes(as_bytes(a), as_bytes(b), length);
+    }
+    return ifind_mismatch(a, b, length) == length;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t ifind_substring(const CharType* data, std::size_t length, const CharType* needle, std::size_t needle_length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return ifind_bytes(as_bytes(data), length, as_bytes(needle), needle_length);
+    }
+    if (needle_length > length)
+        return npos;
+    for (std::size_t i = 0; i + needle_length <= length; i++) {
+        if (iequal_chars(data + i, needle, needle_length))
+            return i;
+    }
+    return npos;
+}
+
+// hash_reader with every byte folded. wider characters get folded byte by byte too,
+// which folds a little more than ifind_mismatch does; strings that compare equal still
+// hash the same, that is all it needs.
+template<typename CharType>
+struct ihash_reader {
+    static constexpr bool contiguous = false;
+
+    hash_reader<CharType> raw_;
+
+    constexpr NODISCARD byte_type byte(std::size_t offset) const noexcept { return ascii_lower(raw_.byte(offset)); }
+    constexpr NODISCARD std::uint64_t read8(std::size_t offset) const noexcept { return ascii_lower_word(raw_.read8(offset)); }
+    constexpr NODISCARD std::uint64_t read4(std::size_t offset) const noexcept { return ascii_lower_word(raw_.read4(offset)); }
+};
+
+} // namespace details
+
+template<typename CharType>
+constexpr NODISCARD bool iequals(basic_string_view<CharType> a, basic_string_view<CharType> b) noexcept {
+    return a.length() == b.length() && details::iequal_chars(a.data(), b.data(), a.length());
+}
+
+constexpr NODISCARD bool iequals(string_view a, string_view b) noexcept {
+    return iequals<char>(a, b);
+}
+
+// like compare, on the folded characters.
+template<typename CharType>
+constexpr NODISCARD int icompare(basic_string_view<CharType> a, basic_string_view<CharType> b) noexcept {
+    using unsigned_type = std::make_unsigned_t<CharType>;
+    const auto length = a.length() < b.length() ? a.length() : b.length();
+    const auto pos = details::ifind_mismatch(a.data(), b.data(), length);
+    if (pos != length) {
+        const auto x = static_cast<unsigned_type>(details::ascii_lower_char(a[pos]));
+        const auto y = static_cast<unsigned_type>(details::ascii_lower_char(b[pos]));
+        return x < y ? -1 : 1;
+    }
+    return a.length() < b.length() ? -1 : a.length() > b.length() ? 1 : 0;
+}
+
+constexpr NODISCARD int icompare(string_view a, string_view b) noexcept {
+    return icompare<char>(a, b);
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t ifind(basic_string_view<CharType> str, basic_string_view<CharType> needle, std::size_t from_index = 0) noexcept {
+    if (from_index > str.length())
+        return npos;
+
+    const auto pos = details::ifind_substring(str.data() + from_index, str.length() - from_index, needle.data(), needle.length());
+    return pos == npos ? npos : pos + from_index;
+}
+
+constexpr NODISCARD std::size_t ifind(string_view str, string_view needle, std::size_t from_index = 0) noexcept {
+    return ifind<char>(str, needle, from_index);
+}
+
+template<typename CharType>
+constexpr NODISCARD bool istarts_with(basic_string_view<CharType> str, basic_string_view<CharType> prefix) noexcept {
+    return prefix.length() <= str.length() && details::iequal_chars(str.data(), prefix.data(), prefix.length());
+}
+
+constexpr NODISCARD bool istarts_with(string_view str, string_view prefix) noexcept {
+    return istarts_with<char>(str, prefix);
+}
+
+template<typename CharType>
+constexpr NODISCARD bool iends_with(basic_string_view<CharType> str, basic_string_view<CharType> suffix) noexcept {
+    return suffix.length() <= str.length()
+        && details::iequal_chars(str.data() + str.length() - suffix.length(), suffix.data(), suffix.length());
+}
+
+constexpr NODISCARD bool iends_with(string_view str, string_view suffix) noexcept {
+    return iends_with<char>(str, suffix);
+}
+
+// hash_string of the folded characters, without folding them anywhere: "Content-Type"
+// and "content-type" hash the same.
+template<typename CharType>
+constexpr NODISCARD std::uint64_t ihash_string(basic_string_view<CharType> str, std::uint64_t seed = 0) noexcept {
+    return details::hash_any(details::ihash_reader<CharType>{ { str.data() } }, sizeof(CharType) * str.length(), seed);
+}
+
+constexpr NODISCARD std::uint64_t ihash_string(string_view str, std::uint64_t seed = 0) noexcept {
+    return ihash_string<char>(str, seed);
+}
+
+// the pair for hash maps keyed case insensitively,
+//
+//     xed::basic_flat_string_map<int, char, xed::allocator<char>, xed::string_ihash, xed::string_iequal> headers;
+template<typename CharType = char>
+struct basic_string_ihash {
+    using is_transparent = void;
+    using string_view = basic_string_view<CharType>;
+
+    std::uint64_t seed_ = 0;
+
+    inline NODISCARD std::uint64_t operator()(string_view str) const noexcept {
+        return ihash_string(str, seed_);
+    }
+};
+
+template<typename CharType = char>
+struct basic_string_iequal {
+    using is_transparent = void;
+    using string_view = basic_string_view<CharType>;
+
+    inline NODISCARD bool operator()(string_view a, string_view b) const noexcept {
+        return iequals(a, b);
+    }
+};
+
+using string_ihash    = basic_string_ihash<char>;
+using wstring_ihash   = basic_string_ihash<wchar_t>;
+using u8string_ihash  = basic_string_ihash<char8_t>;
+using u16string_ihash = basic_string_ihash<char16_t>;
+using u32string_ihash = basic_string_ihash<char32_t>;
+
+using string_iequal    = basic_string_iequal<char>;
+using wstring_iequal   = basic_string_iequal<wchar_t>;
+using u8string_iequal  = basic_string_iequal<char8_t>;
+using u16string_iequal = basic_string_iequal<char16_t>;
+using u32string_iequal = basic_string_iequal<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_CASE_INSENSITIVE_HPP
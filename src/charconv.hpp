@@ -0,0 +1,279 @@
+#pragma once
+#ifndef XED_CHARCONV_HPP
+#define XED_CHARCONV_HPP 1
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "has_attributes.hpp"
+
+// numbers straight into the spare capacity of a basic_string and back out of a view,
+// without a locale, a format string or a temporary. integers are written two digits
+// at a time from a table, floating point numbers in the shortest form that reads
+// back to the same value.
+
+namespace xed {
+
+enum class parse_error {
+    none,
+    // no number at the start of the input.
+    invalid,
+    // a number, but too big for the type.
+    out_of_range,
+};
+
+// how many characters a parse used, like std::from_chars it takes the longest prefix
+// that makes a number and leaves the rest.
+struct parse_result {
+    std::size_t length = 0;
+    parse_error error = parse_error::none;
+
+    inline NODISCARD explicit operator bool() const noexcept { return error == parse_error::none; }
+};
+
+namespace details {
+
+constexpr char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+constexpr std::uint64_t powers_of_10[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull,
+};
+
+// log10 from the bit width, off by at most one, which the table then settles.
+inline NODISCARD std::size_t count_digits(std::uint64_t value) noexcept {
+    const auto guess = (static_cast<std::size_t>(std::bit_width(value | 1)) * 1233) >> 12;
+    return guess + ((value | 1) >= powers_of_10[guess]);
+}
+
+// writes the digits so they end right before `end`.
+template<typename CharType>
+inline void write_digits(CharType* end, std::uint64_t value) noexcept {
+    while (value >= 100) {
+        const auto pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = static_cast<CharType>(digit_pairs[pair + 1]);
+        *--end = static_cast<CharType>(digit_pairs[pair]);
+    }
+    if (value >= 10) {
+        const auto pair = static_cast<std::size_t>(value) * 2;
+        *--end = static_cast<CharType>(digit_pairs[pair + 1]);
+        *--end = static_cast<CharType>(digit_pairs[pair]);
+    }
+    else {
+        *--end = static_cast<CharType>('0' + value);
+    }
+}
+
+template<typename Int, typename CharType>
+inline NODISCARD std::size_t format_int(CharType* out, Int value) noexcept {
+    using unsigned_type = std::make_unsigned_t<Int>;
+    auto magnitude = static_cast<std::uint64_t>(static_cast<unsigned_type>(value));
+    std::size_t sign = 0;
+    if constexpr (std::is_signed_v<Int>) {
+        if (value < 0) {
+            magnitude = static_cast<std::uint64_t>(static_cast<unsigned_type>(unsigned_type(0) - static_cast<unsigned_type>(value)));
+            *out = static_cast<CharType>('-');
+            sign = 1;
+        }
+    }
+
+    const auto digits = count_digits(magnitude);
+    write_digits(out + sign + digits, magnitude);
+    return sign + digits;
+}
+
+// the shortest round trip form is at most this long, "-2.2250738585072014e-308".
+constexpr std::size_t max_float_chars = 32;
+
+template<typename Float, typename CharType>
+inline NODISCARD std::size_t format_float(CharType* out, Float value) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        auto first = reinterpret_cast<char*>(out);
+        return static_cast<std::size_t>(std::to_chars(first, first + max_float_chars, value).ptr - first);
+    }
+    else {
+        char buffer[max_float_chars];
+        const auto length = static_cast<std::size_t>(std::to_chars(buffer, buffer + max_float_chars, value).ptr - buffer);
+        for (std::size_t i = 0; i < length; i++)
+            out[i] = static_cast<CharType>(buffer[i]);
+        return length;
+    }
+}
+
+// general notation with `precision` significant digits, like printf's %g.
+constexpr int max_float_precision = 99;
+constexpr std::size_t max_float_chars_for(int precision) noexcept { return static_cast<std::size_t>(precision) + 12; }
+
+template<typename Float, typename CharType>
+inline NODISCARD std::size_t format_float(CharType* out, Float value, int precision) noexcept {
+    constexpr auto general = std::chars_format::general;
+    const auto limit = max_float_chars_for(precision);
+    if constexpr (sizeof(CharType) == 1) {
+        auto first = reinterpret_cast<char*>(out);
+        return static_cast<std::size_t>(std::to_chars(first, first + limit, value, general, precision).ptr - first);
+    }
+    else {
+        char buffer[max_float_chars_for(max_float_precision)];
+        const auto length = static_cast<std::size_t>(std::to_chars(buffer, buffer + limit, value, general, precision).ptr - buffer);
+        for (std::size_t i = 0; i < length; i++)
+            out[i] = static_cast<CharType>(buffer[i]);
+        return length;
+    }
+}
+
+template<typename CharType>
+inline NODISCARD unsigned digit_value(CharType c) noexcept {
+    const auto code = static_cast<std::uint32_t>(c);
+    if (code - '0' < 10)
+        return code - '0';
+    if ((code | 0x20) - 'a' < 26)
+        return (code | 0x20) - 'a' + 10;
+    return 36;
+}
+
+template<typename Int, typename CharType>
+inline NODISCARD parse_result parse_int(const CharType* data, std::size_t length, Int& value, unsigned base) noexcept {
+    using unsigned_type = std::make_unsigned_t<Int>;
+
+    if (base < 2 || base > 36)
+        return { 0, parse_error::invalid };
+
+    std::size_t pos = 0;
+    bool negative = false;
+    if constexpr (std::is_signed_v<Int>) {
+        if (length != 0 && data[0] == CharType('-')) {
+            negative = true;
+            pos = 1;
+        }
+    }
+
+    // the largest magnitude the type holds, one more on the negative side.
+    const auto limit = static_cast<unsigned_type>(std::numeric_limits<Int>::max()) + unsigned_type(negative);
+
+    const auto start = pos;
+    unsigned_type magnitude = 0;
+    bool overflow = false;
+    if (base == 10) {
+        for (; pos < length; pos++) {
+            const auto digit = static_cast<std::uint32_t>(data[pos]) - '0';
+            if (digit >= 10)
+                break;
+            overflow |= magnitude > (limit - digit) / 10;
+            magnitude = static_cast<unsigned_type>(magnitude * 10 + digit);
+        }
+    }
+    else {
+        for (; pos < length; pos++) {
+            const auto digit = digit_value(data[pos]);
+            if (digit >= base)
+                break;
+            overflow |= magnitude > (limit - digit) / base;
+            magnitude = static_cast<unsigned_type>(magnitude * base + digit);
+        }
+    }
+
+    if (pos == start)
+        return { 0, parse_error::invalid };
+    if (overflow)
+        return { pos, parse_error::out_of_range };
+
+    value = negative ? static_cast<Int>(unsigned_type(0) - magnitude) : static_cast<Int>(magnitude);
+    return { pos, parse_error::none };
+}
+
+template<typename Float>
+inline NODISCARD parse_result parse_float(const char* data, std::size_t length, Float& value) noexcept {
+    Float parsed = 0;
+    const auto result = std::from_chars(data, data + length, parsed);
+    const auto used = static_cast<std::size_t>(result.ptr - data);
+    if (result.ec == std::errc::invalid_argument)
+        return { 0, parse_error::invalid };
+    if (result.ec == std::errc::result_out_of_range)
+        return { used, parse_error::out_of_range };
+
+    value = parsed;
+    return { used, parse_error::none };
+}
+
+} // namespace details
+
+// decimal, with a '-' in front of negative numbers.
+template<typename Int, typename CharType, typename Allocator>
+inline basic_string<CharType, Allocator>& append_int(basic_string<CharType, Allocator>& str, Int value) {
+    static_assert(std::is_integral_v<Int> && sizeof(Int) <= 8, "append_int takes integers of up to 64 bits");
+    return str.append_for_overwrite(21, [value](CharType* out) { return details::format_int(out, value); });
+}
+
+// the shortest text that reads back to exactly `value`, in fixed or scientific notation,
+// whichever is shorter. infinities and nans come out as "inf", "-inf" and "nan".
+template<typename Float, typename CharType, typename Allocator>
+inline basic_string<CharType, Allocator>& append_float(basic_string<CharType, Allocator>& str, Float value) {
+    static_assert(std::is_floating_point_v<Float>, "append_float takes float, double or long double");
+    return str.append_for_overwrite(details::max_float_chars, [value](CharType* out) { return details::format_float(out, value); });
+}
+
+// an optional '-', for signed types only, and then digits in `base`, 2 to 36, with
+// letters of either case past 9. no whitespace, no '+' and no 0x prefix. `value` is
+// only written on success, any other base is parse_error::invalid.
+template<typename Int, typename CharType>
+inline NODISCARD parse_result parse_int(basic_string_view<CharType> str, Int& value, unsigned base = 10) noexcept {
+    static_assert(std::is_integral_v<Int> && !std::is_same_v<Int, bool>, "parse_int parses into integers");
+    return details::parse_int(str.data(), str.length(), value, base);
+}
+
+template<typename Int>
+inline NODISCARD parse_result parse_int(string_view str, Int& value, unsigned base = 10) noexcept {
+    return parse_int<Int, char>(str, value, base);
+}
+
+// decimal or scientific notation, "inf" and "nan" in any case, always with '.' as the
+// decimal point. wide input longer than 256 characters stops parsing there.
+template<typename Float, typename CharType>
+inline NODISCARD parse_result parse_float(basic_string_view<CharType> str, Float& value) noexcept {
+    static_assert(std::is_floating_point_v<Float>, "parse_float parses into float, double or long double");
+    if constexpr (sizeof(CharType) == 1) {
+        return details::parse_float(reinterpret_cast<const char*>(str.data()), str.length(), value);
+    }
+    else {
+        constexpr std::size_t max_wide = 256;
+        char buffer[max_wide];
+        std::size_t length = 0;
+        for (; length < str.length() && length < max_wide; length++) {
+            const auto code = static_cast<std::uint32_t>(str[length]);
+            if (code >= 0x80)
+                break;
+            buffer[length] = static_cast<char>(code);
+        }
+        return details::parse_float(buffer, length, value);
+    }
+}
+
+template<typename Float>
+inline NODISCARD parse_result parse_float(string_view str, Float& value) noexcept {
+    return parse_float<Float, char>(str, value);
+}
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_CHARCONV_HPP
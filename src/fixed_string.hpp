@@ -0,0 +1,295 @@
+#pragma once
+#ifndef XED_FIXED_STRING_HPP
+#define XED_FIXED_STRING_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include "string_view.hpp"
+#include "hash.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+// a string whose characters are part of its type's value, so it can be a template
+// argument: `template<xed::fixed_string Name> struct tag {};` and then `tag<"GET">`.
+// everything on it works in constant expressions. N doesn't count the terminating null.
+template<std::size_t N, typename CharType = char>
+struct fixed_string {
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+
+    // public, a class has to be structural to be a template argument.
+    value_type data_[N + 1] = {};
+
+    constexpr fixed_string() noexcept = default;
+
+    constexpr fixed_string(const value_type (&str)[N + 1]) noexcept {
+        for (size_type i = 0; i < N; i++)
+            data_[i] = str[i];
+    }
+
+    constexpr inline NODISCARD size_type length() const noexcept { return N; }
+    constexpr inline NODISCARD bool is_empty() const noexcept { return N == 0; }
+    constexpr inline NODISCARD const_pointer_type data() const noexcept { return data_; }
+    constexpr inline NODISCARD const value_type& operator[](size_type index) const noexcept { return data_[index]; }
+
+    constexpr inline NODISCARD string_view view() const noexcept { return { data_, N }; }
+    constexpr inline NODISCARD operator string_view() const noexcept { return view(); }
+
+    // the same value hash_string gives the view at run time.
+    constexpr inline NODISCARD std::uint64_t hash(std::uint64_t seed = 0) const noexcept {
+        return hash_string(view(), seed);
+    }
+
+    template<std::size_t M>
+    constexpr inline NODISCARD bool operator==(const fixed_string<M, value_type>& other) const noexcept {
+        return view() == other.view();
+    }
+
+    constexpr inline NODISCARD bool operator==(string_view other) const noexcept {
+        return view() == other;
+    }
+};
+
+template<typename CharType, std::size_t N>
+fixed_string(const CharType (&)[N]) -> fixed_string<N - 1, CharType>;
+
+namespace details {
+
+template<typename First, typename... Rest>
+struct first_type {
+    using type = First;
+};
+
+// what the slots nobody hashes to point at, it never equals a non empty string.
+template<typename CharType>
+constexpr CharType keyword_blank[1] = {};
+
+// a seed and a power of 2 table size for which no two keys hash to the same slot, and
+// which of the two hashes that took.
+struct keyword_layout {
+    std::uint64_t seed_ = 0;
+    std::size_t bits_ = 0;
+    bool sampled_ = false;
+    bool found_ = false;
+};
+
+// the length and the first and last 8 bytes of a string, which is all there is to a
+// string of up to 16 bytes, and protocol keywords are that short.
+struct keyword_sample {
+    std::uint64_t a_ = 0;
+    std::uint64_t b_ = 0;
+    std::uint64_t length_ = 0;
+
+    constexpr inline NODISCARD bool operator==(const keyword_sample& other) const noexcept {
+        return a_ == other.a_ && b_ == other.b_ && length_ == other.length_;
+    }
+};
+
+constexpr std::size_t keyword_sample_bytes = 16;
+
+template<typename CharType>
+constexpr NODISCARD keyword_sample sample_keyword(basic_string_view<CharType> str) noexcept {
+    const hash_reader<CharType> reader{ str.data() };
+    const auto length = sizeof(CharType) * str.length();
+
+    keyword_sample sample;
+    sample.length_ = length;
+    if (length >= 8) {
+        sample.a_ = reader.read8(0);
+        sample.b_ = reader.read8(length - 8);
+    }
+    else if (length >= 4) {
+        sample.a_ = reader.read4(0);
+        sample.b_ = reader.read4(length - 4);
+    }
+    else if (length > 0) {
+        sample.a_ = (std::uint64_t(reader.byte(0)) << 16) | (std::uint64_t(reader.byte(length >> 1)) << 8) | reader.byte(length - 1);
+    }
+    return sample;
+}
+
+// a lot cheaper than hash_string. sets whose keys it can't tell apart, longer keys that
+// share their ends, get laid out with hash_string instead.
+constexpr NODISCARD std::uint64_t keyword_hash(const keyword_sample& sample, std::uint64_t seed) noexcept {
+    return hash_mix(sample.a_ ^ seed ^ hash_secret[0], sample.b_ ^ sample.length_ ^ hash_secret[1]);
+}
+
+template<typename CharType>
+constexpr NODISCARD std::uint64_t keyword_hash(basic_string_view<CharType> str, const keyword_layout& layout) noexcept {
+    return layout.sampled_ ? keyword_hash(sample_keyword(str), layout.seed_) : hash_string(str, layout.seed_);
+}
+
+template<std::size_t Capacity>
+struct keyword_slots {
+    std::uint16_t index_[Capacity] = {};
+};
+
+template<std::size_t Count>
+struct keyword_samples {
+    keyword_sample sample_[Count] = {};
+};
+
+template<std::size_t Count, typename CharType>
+constexpr NODISCARD keyword_samples<Count> make_keyword_samples(const basic_string_view<CharType>* keys) noexcept {
+    keyword_samples<Count> samples;
+    for (std::size_t i = 0; i < Count; i++)
+        samples.sample_[i] = sample_keyword(keys[i]);
+    return samples;
+}
+
+// whether every key is short enough that comparing samples is comparing the keys.
+template<typename CharType>
+constexpr NODISCARD bool keywords_sampled_whole(const basic_string_view<CharType>* keys, std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; i++) {
+        if (sizeof(CharType) * keys[i].length() > keyword_sample_bytes)
+            return false;
+    }
+    return true;
+}
+
+template<typename CharType>
+constexpr NODISCARD bool keywords_distinct(const basic_string_view<CharType>* keys, std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; i++) {
+        for (std::size_t j = i + 1; j < count; j++) {
+            if (keys[i] == keys[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+// the smallest table first, every size gets a handful of seeds before it doubles. the
+// cheap hash gets tried on every size before falling back to the full one.
+template<typename CharType>
+constexpr NODISCARD keyword_layout find_keyword_layout(const basic_string_view<CharType>* keys, std::size_t count) noexcept {
+    constexpr std::uint64_t max_seed = 64;
+    constexpr std::size_t max_growth = 6;
+
+    const auto first_bits = static_cast<std::size_t>(std::bit_width(std::bit_ceil(count) - 1));
+    for (const bool sampled : { true, false }) {
+        for (auto bits = first_bits; bits <= first_bits + max_growth; bits++) {
+            const std::size_t capacity = std::size_t(1) << bits;
+            auto used = new bool[capacity];
+            for (std::uint64_t seed = 0; seed < max_seed; seed++) {
+                const keyword_layout layout{ seed, bits, sampled, true };
+                for (std::size_t i = 0; i < capacity; i++)
+                    used[i] = false;
+
+                bool collision = false;
+                for (std::size_t i = 0; i < count && !collision; i++) {
+                    const auto slot = keyword_hash(keys[i], layout) & (capacity - 1);
+                    collision = used[slot];
+                    used[slot] = true;
+                }
+
+                if (!collision) {
+                    delete[] used;
+                    return layout;
+                }
+            }
+            delete[] used;
+        }
+    }
+    return {};
+}
+
+template<std::size_t Capacity, typename CharType>
+constexpr NODISCARD keyword_slots<Capacity> make_keyword_slots(const basic_string_view<CharType>* keys, std::size_t count, const keyword_layout& layout) noexcept {
+    keyword_slots<Capacity> slots;
+    for (std::size_t i = 0; i < Capacity; i++)
+        slots.index_[i] = static_cast<std::uint16_t>(count);
+    for (std::size_t i = 0; i < count; i++)
+        slots.index_[keyword_hash(keys[i], layout) & (Capacity - 1)] = static_cast<std::uint16_t>(i);
+    return slots;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t keyword_index(const basic_string_view<CharType>* keys, std::size_t count, basic_string_view<CharType> key) noexcept {
+    for (std::size_t i = 0; i < count; i++) {
+        if (keys[i] == key)
+            return i;
+    }
+    return count;
+}
+
+} // namespace details
+
+// a fixed set of keywords, looked up in a perfect hash table that is laid out at
+// compile time: one hash, one load and one compare whichever keyword it is. meant for
+// dispatching on protocol commands and the like,
+//
+//     using commands = xed::keyword_set<"GET", "SET", "DEL">;
+//     switch (commands::find(word)) {
+//     case commands::index<"GET">: ...
+//     case commands::none: ...
+//     }
+//
+// find gives the position of the keyword in the list, or none.
+template<fixed_string... Keys>
+class keyword_set {
+public:
+    using size_type = std::size_t;
+    using value_type = typename details::first_type<typename decltype(Keys)::value_type..., char>::type;
+    using string_view = basic_string_view<value_type>;
+
+    static constexpr size_type none = sizeof...(Keys);
+
+    static_assert((std::is_same_v<typename decltype(Keys)::value_type, value_type> && ...),
+        "keyword_set keys must all have the same character type");
+    static_assert(none < 0xffff, "keyword_set holds at most 65534 keys");
+private:
+    // one more than there are keys, the last is what empty slots point at.
+    static constexpr string_view keys_[none + 1] = { Keys.view()..., string_view(details::keyword_blank<value_type>, 0) };
+
+    static_assert(details::keywords_distinct(keys_, none), "keyword_set keys must be distinct");
+
+    static constexpr details::keyword_layout layout_ = details::find_keyword_layout(keys_, none);
+
+    static_assert(layout_.found_, "keyword_set found no collision free table for these keys");
+
+    static constexpr size_type mask_ = (size_type(1) << layout_.bits_) - 1;
+    static constexpr auto slots_ = details::make_keyword_slots<mask_ + 1>(keys_, none, layout_);
+
+    // short keys are compared by the sample the hash was taken from, no memcmp.
+    static constexpr bool compare_samples_ = layout_.sampled_ && details::keywords_sampled_whole(keys_, none);
+    static constexpr auto samples_ = details::make_keyword_samples<none + 1>(keys_);
+
+    template<fixed_string Key>
+    static consteval size_type checked_index() noexcept {
+        constexpr auto index = details::keyword_index(keys_, none, Key.view());
+        static_assert(index != none, "keyword_set has no such key");
+        return index;
+    }
+public:
+    static constexpr inline NODISCARD size_type size() noexcept { return none; }
+
+    static constexpr inline NODISCARD string_view key(size_type index) noexcept { return keys_[index]; }
+
+    static constexpr inline NODISCARD size_type find(string_view str) noexcept {
+        if constexpr (compare_samples_) {
+            const auto sample = details::sample_keyword(str);
+            const size_type index = slots_.index_[details::keyword_hash(sample, layout_.seed_) & mask_];
+            return samples_.sample_[index] == sample ? index : none;
+        }
+        else {
+            const size_type index = slots_.index_[details::keyword_hash(str, layout_) & mask_];
+            return keys_[index] == str ? index : none;
+        }
+    }
+
+    static constexpr inline NODISCARD bool contains(string_view str) noexcept { return find(str) != none; }
+
+    // the position of a keyword that has to be in the set, for case labels.
+    template<fixed_string Key>
+    static constexpr size_type index = checked_index<Key>();
+};
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_FIXED_STRING_HPP
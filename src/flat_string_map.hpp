@@ -0,0 +1,406 @@
+#pragma once
+#ifndef XED_FLAT_STRING_MAP_HPP
+#define XED_FLAT_STRING_MAP_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "hash.hpp"
+#include "simd.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+namespace details {
+
+// one control byte per slot: the low 7 bits of the hash while the slot is in use,
+// otherwise one of these two, which both have the top bit set.
+constexpr byte_type ctrl_empty = 0x80;
+constexpr byte_type ctrl_deleted = 0xfe;
+
+// the control bytes of consecutive slots, checked all at once.
+#if defined(XED_HAS_SIMD_BLOCK)
+struct ctrl_group {
+    constexpr static std::size_t size = simd_block::size;
+
+    explicit ctrl_group(const byte_type* ctrl) noexcept : bytes_(simd_block::load(ctrl)) {}
+
+    inline NODISCARD std::uint32_t match(byte_type tag) const noexcept { return simd_block::eq_mask(bytes_, simd_block::splat(tag)); }
+    inline NODISCARD std::uint32_t match_empty() const noexcept { return match(ctrl_empty); }
+    inline NODISCARD std::uint32_t match_free() const noexcept { return simd_block::mask(bytes_); }
+private:
+    simd_block::register_type bytes_;
+};
+#else
+struct ctrl_group {
+    constexpr static std::size_t size = 8;
+
+    explicit ctrl_group(const byte_type* ctrl) noexcept { std::memcpy(bytes_, ctrl, size); }
+
+    inline NODISCARD std::uint32_t match(byte_type tag) const noexcept {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < size; i++)
+            mask |= std::uint32_t(bytes_[i] == tag) << i;
+        return mask;
+    }
+    inline NODISCARD std::uint32_t match_empty() const noexcept { return match(ctrl_empty); }
+    inline NODISCARD std::uint32_t match_free() const noexcept {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < size; i++)
+            mask |= std::uint32_t(bytes_[i] >> 7) << i;
+        return mask;
+    }
+private:
+    byte_type bytes_[size];
+};
+#endif
+
+} // namespace details
+
+// open addressing hash map from basic_string keys to `Value`. the entries sit in one flat
+// array next to a control byte each, a lookup compares a whole group of control bytes
+// with one vector instruction and only touches the entries whose 7 bit tag matched.
+// every lookup takes anything that converts to a string_view, so no temporary string
+// gets built; a basic_hashed_string key reuses its cached hash. Hash and KeyEqual have
+// to agree, string_ihash with string_iequal from case_insensitive.hpp ignores case.
+template<typename Value, typename CharType = char, typename Allocator = allocator<CharType>, typename Hash = basic_string_hash<CharType>,
+    typename KeyEqual = basic_string_equal<CharType>>
+class basic_flat_string_map {
+public:
+    using this_type = basic_flat_string_map;
+    using size_type = std::size_t;
+    using key_type = basic_string<CharType, Allocator>;
+    using mapped_type = Value;
+    using allocator_type = Allocator;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using string_view = basic_string_view<CharType>;
+
+    struct entry {
+        key_type key;
+        mapped_type value;
+    };
+
+    template<typename EntryType>
+    class basic_iterator {
+    public:
+        basic_iterator(const details::byte_type* ctrl, const details::byte_type* end, EntryType* entry) noexcept
+            : ctrl_(ctrl)
+            , end_(end)
+            , entry_(entry) {
+            skip_free();
+        }
+
+        inline NODISCARD EntryType& operator*() const noexcept { return *entry_; }
+        inline NODISCARD EntryType* operator->() const noexcept { return entry_; }
+
+        basic_iterator& operator++() noexcept {
+            ++ctrl_;
+            ++entry_;
+            skip_free();
+            return *this;
+        }
+
+        inline NODISCARD bool operator==(const basic_iterator& other) const noexcept { return ctrl_ == other.ctrl_; }
+        inline NODISCARD bool operator!=(const basic_iterator& other) const noexcept { return ctrl_ != other.ctrl_; }
+    private:
+        inline void skip_free() noexcept {
+            while (ctrl_ != end_ && (*ctrl_ & 0x80) != 0) {
+                ++ctrl_;
+                ++entry_;
+            }
+        }
+    private:
+        const details::byte_type* ctrl_;
+        const details::byte_type* end_;
+        EntryType* entry_;
+    };
+
+    using iterator = basic_iterator<entry>;
+    using const_iterator = basic_iterator<const entry>;
+private:
+    constexpr static size_type group_size = details::ctrl_group::size;
+public:
+    basic_flat_string_map() noexcept = default;
+
+    explicit basic_flat_string_map(const allocator_type& alloc, const hasher& hash = hasher(), const key_equal& equal = key_equal()) noexcept
+        : allocator_(alloc)
+        , hash_(hash)
+        , equal_(equal) {
+    }
+
+    basic_flat_string_map(const basic_flat_string_map& other)
+        : allocator_(other.allocator_)
+        , hash_(other.hash_)
+        , equal_(other.equal_) {
+        reserve(other.size_);
+        for (const auto& e : other)
+            insert(e.key, e.value);
+    }
+
+    basic_flat_string_map(basic_flat_string_map&& other) noexcept
+        : entries_(xed::exchange(other.entries_, nullptr))
+        , ctrl_(xed::exchange(other.ctrl_, nullptr))
+        , capacity_(xed::exchange(other.capacity_, 0))
+        , size_(xed::exchange(other.size_, 0))
+        , growth_left_(xed::exchange(other.growth_left_, 0))
+        , allocator_(other.allocator_)
+        , hash_(other.hash_)
+        , equal_(other.equal_) {
+    }
+
+    basic_flat_string_map& operator=(const basic_flat_string_map& other) {
+        basic_flat_string_map temp(other);
+        this->swap(temp);
+        return *this;
+    }
+
+    basic_flat_string_map& operator=(basic_flat_string_map&& other) noexcept {
+        basic_flat_string_map temp(xed::move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~basic_flat_string_map() noexcept {
+        destroy();
+    }
+
+    void swap(basic_flat_string_map& other) noexcept {
+        entries_ = xed::exchange(other.entries_, entries_);
+        ctrl_ = xed::exchange(other.ctrl_, ctrl_);
+        capacity_ = xed::exchange(other.capacity_, capacity_);
+        size_ = xed::exchange(other.size_, size_);
+        growth_left_ = xed::exchange(other.growth_left_, growth_left_);
+        allocator_ = xed::exchange(other.allocator_, allocator_);
+        hash_ = xed::exchange(other.hash_, hash_);
+        equal_ = xed::exchange(other.equal_, equal_);
+    }
+
+    inline NODISCARD size_type size() const noexcept { return size_; }
+    inline NODISCARD bool is_empty() const noexcept { return size_ == 0; }
+    inline NODISCARD size_type capacity() const noexcept { return capacity_; }
+
+    inline NODISCARD iterator begin() noexcept { return { ctrl_, ctrl_ + capacity_, entries_ }; }
+    inline NODISCARD iterator end() noexcept { return { ctrl_ + capacity_, ctrl_ + capacity_, entries_ + capacity_ }; }
+    inline NODISCARD const_iterator begin() const noexcept { return { ctrl_, ctrl_ + capacity_, entries_ }; }
+    inline NODISCARD const_iterator end() const noexcept { return { ctrl_ + capacity_, ctrl_ + capacity_, entries_ + capacity_ }; }
+
+    // the value for `key`, nullptr when there is none.
+    template<typename Key>
+    inline NODISCARD mapped_type* find(const Key& key) noexcept {
+        const auto index = find_index(string_view(key), hash_(key));
+        return index != npos ? &entries_[index].value : nullptr;
+    }
+
+    template<typename Key>
+    inline NODISCARD const mapped_type* find(const Key& key) const noexcept {
+        return const_cast<this_type*>(this)->find(key);
+    }
+
+    template<typename Key>
+    inline NODISCARD bool contains(const Key& key) const noexcept {
+        return find(key) != nullptr;
+    }
+
+    // adds `key` unless it is there already, returns whether it did.
+    template<typename Key>
+    bool insert(Key&& key, mapped_type value) {
+        const auto hash = hash_(key);
+        if (find_index(string_view(key), hash) != npos)
+            return false;
+
+        emplace_new(make_key(static_cast<Key&&>(key)), xed::move(value), hash);
+        return true;
+    }
+
+    template<typename Key>
+    mapped_type& insert_or_assign(Key&& key, mapped_type value) {
+        const auto hash = hash_(key);
+        const auto index = find_index(string_view(key), hash);
+        if (index != npos)
+            return entries_[index].value = xed::move(value);
+
+        return emplace_new(make_key(static_cast<Key&&>(key)), xed::move(value), hash);
+    }
+
+    // default constructs the value the first time `key` shows up.
+    template<typename Key>
+    mapped_type& operator[](Key&& key) {
+        const auto hash = hash_(key);
+        const auto index = find_index(string_view(key), hash);
+        if (index != npos)
+            return entries_[index].value;
+
+        return emplace_new(make_key(static_cast<Key&&>(key)), mapped_type(), hash);
+    }
+
+    template<typename Key>
+    bool erase(const Key& key) noexcept {
+        const auto index = find_index(string_view(key), hash_(key));
+        if (index == npos)
+            return false;
+
+        entries_[index].~entry();
+        size_--;
+        // when no group_size slots in a row around it were ever all in use, no probe can
+        // have walked past this slot, so it can go back to empty instead of a tombstone.
+        const auto after = details::ctrl_group(ctrl_ + index).match_empty();
+        const auto before = details::ctrl_group(ctrl_ + ((index - group_size) & (capacity_ - 1))).match_empty();
+        const bool was_never_full = after != 0 && before != 0
+            && static_cast<size_type>(std::countr_zero(after) + std::countl_zero(before << (32 - group_size))) < group_size;
+        set_ctrl(index, was_never_full ? details::ctrl_empty : details::ctrl_deleted);
+        if (was_never_full)
+            growth_left_++;
+        return true;
+    }
+
+    void clear() noexcept {
+        destroy();
+        entries_ = nullptr;
+        ctrl_ = nullptr;
+        capacity_ = size_ = growth_left_ = 0;
+    }
+
+    // room for `count` entries without another rehash.
+    void reserve(size_type count) {
+        if (count <= size_ + growth_left_)
+            return;
+
+        size_type capacity = group_size;
+        while (capacity * 7 / 8 < count)
+            capacity *= 2;
+        rehash(capacity);
+    }
+private:
+    // the top bits pick where to start, the low 7 go into the control byte.
+    static inline NODISCARD details::byte_type tag_of(std::uint64_t hash) noexcept {
+        return static_cast<details::byte_type>(hash & 0x7f);
+    }
+
+    inline NODISCARD size_type start_of(std::uint64_t hash) const noexcept {
+        return static_cast<size_type>(hash >> 7) & (capacity_ - 1);
+    }
+
+    NODISCARD size_type find_index(string_view key, std::uint64_t hash) const noexcept {
+        if (capacity_ == 0)
+            return npos;
+
+        const auto tag = tag_of(hash);
+        const auto mask = capacity_ - 1;
+        for (auto position = start_of(hash);; position = (position + group_size) & mask) {
+            const details::ctrl_group group(ctrl_ + position);
+            for (auto matches = group.match(tag); matches != 0; matches &= matches - 1) {
+                const auto index = (position + std::countr_zero(matches)) & mask;
+                if (equal_(string_view(entries_[index].key), key))
+                    return index;
+            }
+            if (group.match_empty() != 0)
+                return npos;
+        }
+    }
+
+    NODISCARD size_type find_free(std::uint64_t hash) const noexcept {
+        const auto mask = capacity_ - 1;
+        for (auto position = start_of(hash);; position = (position + group_size) & mask) {
+            const auto free = details::ctrl_group(ctrl_ + position).match_free();
+            if (free != 0)
+                return (position + std::countr_zero(free)) & mask;
+        }
+    }
+
+    // the first group_size control bytes are repeated past the end, so a group that
+    // starts near the end can still be loaded in one go.
+    inline void set_ctrl(size_type index, details::byte_type value) noexcept {
+        ctrl_[index] = value;
+        ctrl_[((index - group_size) & (capacity_ - 1)) + group_size] = value;
+    }
+
+    inline NODISCARD key_type make_key(key_type&& key) noexcept { return xed::move(key); }
+    template<typename Key>
+    inline NODISCARD key_type make_key(const Key& key) {
+        const string_view view(key);
+        return { view.data(), view.length(), allocator_ };
+    }
+
+    mapped_type& emplace_new(key_type&& key, mapped_type&& value, std::uint64_t hash) {
+        if (growth_left_ == 0)
+            rehash(capacity_ == 0 ? group_size : size_ * 2 >= capacity_ * 7 / 8 ? capacity_ * 2 : capacity_);
+
+        const auto index = find_free(hash);
+        if (ctrl_[index] == details::ctrl_empty)
+            growth_left_--;
+
+        auto e = new (&entries_[index]) entry{ xed::move(key), xed::move(value) };
+        set_ctrl(index, tag_of(hash));
+        size_++;
+        return e->value;
+    }
+
+    // moves everything into a table of `capacity` slots, which also drops the tombstones.
+    void rehash(size_type capacity) {
+        auto memory = static_cast<details::byte_type*>(::operator new(sizeof(entry) * capacity + capacity + group_size));
+        auto entries = reinterpret_cast<entry*>(memory);
+        auto ctrl = memory + sizeof(entry) * capacity;
+        std::memset(ctrl, details::ctrl_empty, capacity + group_size);
+
+        auto old_entries = xed::exchange(entries_, entries);
+        auto old_ctrl = xed::exchange(ctrl_, ctrl);
+        const auto old_capacity = xed::exchange(capacity_, capacity);
+        growth_left_ = capacity * 7 / 8 - size_;
+
+        for (size_type i = 0; i < old_capacity; i++) {
+            if ((old_ctrl[i] & 0x80) != 0)
+                continue;
+
+            auto& old = old_entries[i];
+            const auto hash = hash_(string_view(old.key));
+            const auto index = find_free(hash);
+            new (&entries_[index]) entry{ xed::move(old.key), xed::move(old.value) };
+            set_ctrl(index, tag_of(hash));
+            old.~entry();
+        }
+
+        if (old_capacity != 0)
+            ::operator delete(old_entries);
+    }
+
+    void destroy() noexcept {
+        if (capacity_ == 0)
+            return;
+
+        for (size_type i = 0; i < capacity_; i++) {
+            if ((ctrl_[i] & 0x80) == 0)
+                entries_[i].~entry();
+        }
+        ::operator delete(entries_);
+    }
+private:
+    entry* entries_ = nullptr;
+    details::byte_type* ctrl_ = nullptr;
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type growth_left_ = 0;
+    NO_UNIQUE_ADDRESS allocator_type allocator_;
+    NO_UNIQUE_ADDRESS hasher hash_;
+    NO_UNIQUE_ADDRESS key_equal equal_;
+};
+
+template<typename Value, typename Allocator = allocator<char>>
+using flat_string_map = basic_flat_string_map<Value, char, Allocator>;
+template<typename Value, typename Allocator = allocator<wchar_t>>
+using wflat_string_map = basic_flat_string_map<Value, wchar_t, Allocator>;
+template<typename Value, typename Allocator = allocator<char8_t>>
+using u8flat_string_map = basic_flat_string_map<Value, char8_t, Allocator>;
+template<typename Value, typename Allocator = allocator<char16_t>>
+using u16flat_string_map = basic_flat_string_map<Value, char16_t, Allocator>;
+template<typename Value, typename Allocator = allocator<char32_t>>
+using u32flat_string_map = basic_flat_string_map<Value, char32_t, Allocator>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_FLAT_STRING_MAP_HPP
@@ -0,0 +1,339 @@
+#pragma once
+#ifndef XED_FORMAT_HPP
+#define XED_FORMAT_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "charconv.hpp"
+#include "string_builder.hpp"
+#include "has_attributes.hpp"
+
+// "{}" formatting into a basic_string. the format string is taken apart at compile time,
+// so a wrong number of arguments or a spec that doesn't fit its argument doesn't compile.
+// before writing, every argument says how long it can get at most, the string grows
+// once to fit all of it and everything is written straight into it.
+//
+//     xed::format_to(line, "{} {} took {:.3}ms\n", method, path, elapsed);
+//
+// specs: "{}" for anything, "{:x}" and "{:X}" for integers in hex, "{:.N}" for floating
+// point numbers with N significant digits. "{{" and "}}" are literal braces.
+
+namespace xed {
+
+namespace details {
+
+enum class format_kind : unsigned char {
+    integer,
+    boolean,
+    character,
+    floating,
+    string,
+    unsupported,
+};
+
+enum class format_spec : unsigned char {
+    none,
+    hex,
+    upper_hex,
+    precision,
+};
+
+// an argument and the literal text in front of it, as offsets into the format string.
+struct format_field {
+    std::size_t literal_begin_ = 0;
+    std::size_t literal_end_ = 0;
+    bool escaped_ = false;
+    format_spec spec_ = format_spec::none;
+    int precision_ = 0;
+};
+
+template<typename CharType, typename T>
+constexpr NODISCARD format_kind format_kind_of() noexcept {
+    using type = std::remove_cvref_t<T>;
+    // before the conversion check, integers and characters convert to a view as well.
+    if constexpr (std::is_same_v<type, bool>)
+        return format_kind::boolean;
+    else if constexpr (std::is_same_v<type, CharType>)
+        return format_kind::character;
+    else if constexpr (std::is_integral_v<type>)
+        return format_kind::integer;
+    else if constexpr (std::is_floating_point_v<type>)
+        return format_kind::floating;
+    else if constexpr (std::is_convertible_v<const T&, basic_string_view<CharType>>)
+        return format_kind::string;
+    else
+        return format_kind::unsupported;
+}
+
+// not constexpr, calling it while parsing at compile time is what fails the build.
+inline void format_string_error(const char* what) {
+    throw std::invalid_argument(what);
+}
+
+} // namespace details
+
+// a format string checked against the arguments it is going to be used with. made
+// implicitly from a string literal, `xed::format_string<Args...>` names the char one.
+template<typename CharType, typename... Args>
+class basic_format_string {
+public:
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using pointer_type = value_type*;
+    using string_view = basic_string_view<value_type>;
+
+    static constexpr size_type argument_count = sizeof...(Args);
+private:
+    static constexpr details::format_kind kinds_[argument_count + 1] = {
+        details::format_kind_of<value_type, Args>()..., details::format_kind::unsupported
+    };
+
+    static_assert(((details::format_kind_of<value_type, Args>() != details::format_kind::unsupported) && ...),
+        "xed::format takes integers, floating point numbers, bool, characters and anything that converts to a string view");
+
+    string_view str_;
+    // one per argument and the literal after the last one.
+    details::format_field fields_[argument_count + 1] = {};
+    size_type literal_length_ = 0;
+
+    consteval void parse() {
+        const auto length = str_.length();
+        size_type pos = 0;
+        size_type field = 0;
+        size_type literal_begin = 0;
+        bool escaped = false;
+
+        while (pos < length) {
+            const auto ch = str_[pos];
+            if (ch == value_type('{') && pos + 1 < length && str_[pos + 1] == value_type('{')) {
+                escaped = true;
+                literal_length_++;
+                pos += 2;
+            }
+            else if (ch == value_type('}') && pos + 1 < length && str_[pos + 1] == value_type('}')) {
+                escaped = true;
+                literal_length_++;
+                pos += 2;
+            }
+            else if (ch == value_type('}')) {
+                details::format_string_error("xed::format: '}' without a '{', write \"}}\" for a literal one");
+            }
+            else if (ch == value_type('{')) {
+                if (field == argument_count)
+                    details::format_string_error("xed::format: more {} than arguments");
+
+                auto& current = fields_[field];
+                current.literal_begin_ = literal_begin;
+                current.literal_end_ = pos;
+                current.escaped_ = escaped;
+                pos = parse_spec(pos + 1, current, kinds_[field]);
+
+                field++;
+                literal_begin = pos;
+                escaped = false;
+            }
+            else {
+                literal_length_++;
+                pos++;
+            }
+        }
+
+        if (field != argument_count)
+            details::format_string_error("xed::format: fewer {} than arguments");
+
+        auto& last = fields_[argument_count];
+        last.literal_begin_ = literal_begin;
+        last.literal_end_ = length;
+        last.escaped_ = escaped;
+    }
+
+    // from right after the '{' to right after the '}'.
+    consteval size_type parse_spec(size_type pos, details::format_field& field, details::format_kind kind) {
+        const auto length = str_.length();
+        if (pos < length && str_[pos] == value_type(':')) {
+            pos++;
+            if (pos < length && (str_[pos] == value_type('x') || str_[pos] == value_type('X'))) {
+                if (kind != details::format_kind::integer)
+                    details::format_string_error("xed::format: {:x} is for integers");
+                field.spec_ = str_[pos] == value_type('x') ? details::format_spec::hex : details::format_spec::upper_hex;
+                pos++;
+            }
+            else if (pos < length && str_[pos] == value_type('.')) {
+                if (kind != details::format_kind::floating)
+                    details::format_string_error("xed::format: {:.N} is for floating point numbers");
+                pos++;
+                const auto first = pos;
+                int precision = 0;
+                for (; pos < length && str_[pos] >= value_type('0') && str_[pos] <= value_type('9'); pos++)
+                    precision = precision * 10 + static_cast<int>(str_[pos] - value_type('0'));
+                if (pos == first || pos - first > 2)
+                    details::format_string_error("xed::format: {:.N} takes 1 or 2 digits");
+                field.spec_ = details::format_spec::precision;
+                field.precision_ = precision;
+            }
+        }
+        if (pos >= length || str_[pos] != value_type('}'))
+            details::format_string_error("xed::format: unknown spec or a '{' without a '}'");
+        return pos + 1;
+    }
+public:
+    template<size_type N>
+    consteval basic_format_string(const value_type (&str)[N]) : str_(str, N - 1) {
+        parse();
+    }
+
+    constexpr inline NODISCARD string_view view() const noexcept { return str_; }
+
+    // the literal text without the arguments, with escaped braces counted once.
+    constexpr inline NODISCARD size_type literal_length() const noexcept { return literal_length_; }
+
+    constexpr inline NODISCARD const details::format_field& field(size_type index) const noexcept { return fields_[index]; }
+
+    // copies the literal in front of argument `index`, or after the last one for
+    // argument_count, and returns the end of what it wrote.
+    inline pointer_type write_literal(size_type index, pointer_type out) const noexcept {
+        const auto& field = fields_[index];
+        const auto data = str_.data();
+        if (!field.escaped_) {
+            const auto length = field.literal_end_ - field.literal_begin_;
+            std::memcpy(out, data + field.literal_begin_, sizeof(value_type) * length);
+            return out + length;
+        }
+        for (auto pos = field.literal_begin_; pos < field.literal_end_; pos++) {
+            *out++ = data[pos];
+            // the second brace of a pair.
+            if (data[pos] == value_type('{') || data[pos] == value_type('}'))
+                pos++;
+        }
+        return out;
+    }
+};
+
+template<typename... Args>
+using format_string = basic_format_string<char, std::type_identity_t<Args>...>;
+
+namespace details {
+
+// arguments as what gets written, strings of every kind become a view once, so their
+// length is only worked out once.
+template<typename CharType, typename T>
+inline NODISCARD decltype(auto) format_value(const T& value) noexcept {
+    if constexpr (format_kind_of<CharType, T>() == format_kind::string)
+        return basic_string_view<CharType>(value);
+    else
+        return (value);
+}
+
+template<typename CharType, typename T>
+constexpr NODISCARD std::size_t format_bound(const T& value, const format_field& field) noexcept {
+    if constexpr (std::is_same_v<T, bool>)
+        return 5;
+    else if constexpr (std::is_same_v<T, CharType>)
+        return 1;
+    else if constexpr (std::is_integral_v<T>)
+        return 21;
+    else if constexpr (std::is_floating_point_v<T>)
+        return field.spec_ == format_spec::precision ? max_float_chars_for(field.precision_) : max_float_chars;
+    else
+        return value.length();
+}
+
+template<typename Int, typename CharType>
+inline NODISCARD std::size_t format_hex(CharType* out, Int value, bool upper) noexcept {
+    using unsigned_type = std::make_unsigned_t<Int>;
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    auto magnitude = static_cast<std::uint64_t>(static_cast<unsigned_type>(value));
+    std::size_t sign = 0;
+    if constexpr (std::is_signed_v<Int>) {
+        if (value < 0) {
+            magnitude = static_cast<std::uint64_t>(static_cast<unsigned_type>(unsigned_type(0) - static_cast<unsigned_type>(value)));
+            *out = static_cast<CharType>('-');
+            sign = 1;
+        }
+    }
+
+    const auto length = (static_cast<std::size_t>(std::bit_width(magnitude | 1)) + 3) / 4;
+    auto end = out + sign + length;
+    for (std::size_t i = 0; i < length; i++, magnitude >>= 4)
+        *--end = static_cast<CharType>(digits[magnitude & 0xf]);
+    return sign + length;
+}
+
+template<typename CharType, typename T>
+inline NODISCARD CharType* format_write(CharType* out, const T& value, const format_field& field) noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+        const char* text = value ? "true" : "false";
+        const std::size_t length = value ? 4 : 5;
+        for (std::size_t i = 0; i < length; i++)
+            out[i] = static_cast<CharType>(text[i]);
+        return out + length;
+    }
+    else if constexpr (std::is_same_v<T, CharType>) {
+        *out = value;
+        return out + 1;
+    }
+    else if constexpr (std::is_integral_v<T>) {
+        if (field.spec_ == format_spec::none)
+            return out + format_int(out, value);
+        return out + format_hex(out, value, field.spec_ == format_spec::upper_hex);
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        if (field.spec_ == format_spec::precision)
+            return out + format_float(out, value, field.precision_);
+        return out + format_float(out, value);
+    }
+    else {
+        std::memcpy(out, value.data(), sizeof(CharType) * value.length());
+        return out + value.length();
+    }
+}
+
+template<typename CharType, typename Output, typename Format, typename... Values, std::size_t... Index>
+inline void format_values(Output& str, const Format& fmt, std::index_sequence<Index...>, const Values&... values) {
+    const auto bound = fmt.literal_length() + (std::size_t(0) + ... + format_bound<CharType>(values, fmt.field(Index)));
+    str.append_for_overwrite(bound, [&](CharType* first) {
+        auto out = first;
+        ((out = fmt.write_literal(Index, out), out = format_write(out, values, fmt.field(Index))), ...);
+        out = fmt.write_literal(sizeof...(Values), out);
+        return static_cast<std::size_t>(out - first);
+    });
+}
+
+} // namespace details
+
+// appends to `str`, which grows at most once. works for every character type, the
+// format string has the same one as `str`.
+template<typename CharType, typename Allocator, typename... Args>
+inline basic_string<CharType, Allocator>& format_to(basic_string<CharType, Allocator>& str,
+    std::type_identity_t<basic_format_string<CharType, Args...>> fmt, const Args&... args) {
+    details::format_values<CharType>(str, fmt, std::index_sequence_for<Args...>{}, details::format_value<CharType>(args)...);
+    return str;
+}
+
+// appends to the last chunk of `str`, or a new one if the longest it can get doesn't fit.
+template<typename CharType, typename... Args>
+inline basic_string_builder<CharType>& format_to(basic_string_builder<CharType>& str,
+    std::type_identity_t<basic_format_string<CharType, Args...>> fmt, const Args&... args) {
+    details::format_values<CharType>(str, fmt, std::index_sequence_for<Args...>{}, details::format_value<CharType>(args)...);
+    return str;
+}
+
+template<typename... Args>
+inline NODISCARD string format(format_string<Args...> fmt, const Args&... args) {
+    string str;
+    format_to(str, fmt, args...);
+    return str;
+}
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_FORMAT_HPP
@@ -0,0 +1,609 @@
+#pragma once
+#ifndef XED_GLOB_SET_HPP
+#define XED_GLOB_SET_HPP 1
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "flat_string_map.hpp"
+#include "has_attributes.hpp"
+
+// a set of shell style patterns matched against whole strings at once:
+//
+//     *       any run of characters, '/' included, the empty one too
+//     ?       any one character
+//     [abc]   one of the listed characters, [a-z] ranges, [!a-z] or [^a-z] none of them.
+//             a ']' right after the '[' (or the '!') is listed rather than closing it
+//     \c      c itself
+//
+// a '[' with no ']' after it is just a '['. the patterns are compiled to one dfa, so
+// matching a string reads every character once however many patterns there are.
+namespace xed {
+namespace details {
+
+// a growable array of trivial values for the compiler below.
+template<typename T>
+class glob_array {
+public:
+    using size_type = std::size_t;
+
+    glob_array() noexcept = default;
+
+    glob_array(const glob_array&) = delete;
+    glob_array& operator=(const glob_array&) = delete;
+
+    ~glob_array() noexcept {
+        delete[] data_;
+    }
+
+    inline NODISCARD size_type length() const noexcept { return length_; }
+    inline NODISCARD T* data() noexcept { return data_; }
+    inline NODISCARD const T* data() const noexcept { return data_; }
+    inline NODISCARD T& operator[](size_type index) noexcept { return data_[index]; }
+    inline NODISCARD const T& operator[](size_type index) const noexcept { return data_[index]; }
+
+    inline void clear() noexcept { length_ = 0; }
+    inline void truncate(size_type length) noexcept { length_ = length; }
+
+    // `length` values, the new ones left as they are.
+    void resize_for_overwrite(size_type length) {
+        reserve(length);
+        length_ = length;
+    }
+
+    inline void push_back(T value) {
+        if (length_ == capacity_)
+            reserve(capacity_ != 0 ? capacity_ * 2 : 16);
+        data_[length_++] = value;
+    }
+
+    void append(const T* values, size_type count) {
+        if (capacity_ - length_ < count)
+            reserve(length_ + count > capacity_ * 2 ? length_ + count : capacity_ * 2);
+        if (count != 0)
+            std::memcpy(data_ + length_, values, sizeof(T) * count);
+        length_ += count;
+    }
+
+    void reserve(size_type capacity) {
+        if (capacity <= capacity_)
+            return;
+        auto data = new T[capacity];
+        if (length_ != 0)
+            std::memcpy(data, data_, sizeof(T) * length_);
+        delete[] exchange(data_, data);
+        capacity_ = capacity;
+    }
+private:
+    T* data_ = nullptr;
+    size_type length_ = 0;
+    size_type capacity_ = 0;
+};
+
+// one place in a pattern: what the next character has to be, or the end of the pattern.
+struct glob_position {
+    enum kind_type : std::uint8_t { set, star, end };
+
+    kind_type kind_;
+    bool negated_;
+    // the ranges of a set, inclusive at both ends, in glob_patterns::ranges_. the pattern
+    // for an end.
+    std::uint32_t first_;
+    std::uint32_t count_;
+};
+
+struct glob_range {
+    std::uint32_t low_;
+    std::uint32_t high_;
+};
+
+// the patterns taken apart, every pattern its positions followed by an end.
+struct glob_patterns {
+    glob_array<glob_position> positions_;
+    glob_array<glob_range> ranges_;
+
+    template<typename CharType>
+    static inline NODISCARD std::uint32_t unit(CharType ch) noexcept {
+        return static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<CharType>>(ch));
+    }
+
+    template<typename CharType>
+    void parse(const CharType* pattern, std::size_t length, std::size_t index) {
+        std::size_t i = 0;
+        while (i < length) {
+            const auto ch = pattern[i];
+            if (ch == '*') {
+                // a run of stars is one star.
+                if (positions_.length() == 0 || positions_[positions_.length() - 1].kind_ != glob_position::star)
+                    positions_.push_back({ glob_position::star, false, 0, 0 });
+                i++;
+            }
+            else if (ch == '?') {
+                positions_.push_back({ glob_position::set, true, 0, 0 });
+                i++;
+            }
+            else if (ch == '[' && parse_set(pattern, length, i)) {
+            }
+            else {
+                if (ch == '\\' && i + 1 < length)
+                    i++;
+                push_char(unit(pattern[i++]));
+            }
+        }
+        positions_.push_back({ glob_position::end, false, static_cast<std::uint32_t>(index), 0 });
+    }
+private:
+    void push_char(std::uint32_t ch) {
+        positions_.push_back({ glob_position::set, false, static_cast<std::uint32_t>(ranges_.length()), 1 });
+        ranges_.push_back({ ch, ch });
+    }
+
+    // `i` is at the '['. moves it past the ']', or returns false and leaves it when there
+    // is none.
+    template<typename CharType>
+    bool parse_set(const CharType* pattern, std::size_t length, std::size_t& i) {
+        auto at = i + 1;
+        const auto negated = at < length && (pattern[at] == '!' || pattern[at] == '^');
+        if (negated)
+            at++;
+
+        const auto first = ranges_.length();
+        const auto start = at;
+        for (;;) {
+            if (at >= length) {
+                // not a set after all, forget the ranges.
+                ranges_.truncate(first);
+                return false;
+            }
+            if (pattern[at] == ']' && at != start)
+                break;
+
+            if (pattern[at] == '\\' && at + 1 < length)
+                at++;
+            const auto low = unit(pattern[at++]);
+            auto high = low;
+            if (at + 1 < length && pattern[at] == '-' && pattern[at + 1] != ']') {
+                at++;
+                if (pattern[at] == '\\' && at + 1 < length)
+                    at++;
+                high = unit(pattern[at++]);
+            }
+            ranges_.push_back({ low, high });
+        }
+
+        positions_.push_back({ glob_position::set, negated, static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(ranges_.length() - first) });
+        i = at + 1;
+        return true;
+    }
+};
+
+// the dfa. the characters are cut into classes at every end of a range, so a class is
+// all in or all out of every set and the table needs a column per class only. states
+// are sets of pattern positions while building, then merged down to the minimal dfa by
+// refining a partition by outputs until no state of a block goes somewhere else than
+// the rest of it (moore's algorithm, a few rounds for real pattern sets). states are
+// stored multiplied by the row length, a character is one load of its class and one of
+// the next state.
+class glob_automaton {
+public:
+    using size_type = std::size_t;
+    using state_type = std::uint32_t;
+
+    glob_automaton() noexcept = default;
+
+    glob_automaton(const glob_automaton&) = delete;
+    glob_automaton& operator=(const glob_automaton&) = delete;
+
+    ~glob_automaton() noexcept {
+        delete[] boundaries_;
+        delete[] table_;
+        delete[] output_begin_;
+        delete[] outputs_;
+    }
+
+    inline NODISCARD size_type state_count() const noexcept { return state_count_; }
+    inline NODISCARD size_type class_count() const noexcept { return class_count_; }
+
+    // `max_unit` is the largest character there is, 0xff for char.
+    void build(const glob_patterns& patterns, std::uint32_t max_unit) {
+        const auto& positions = patterns.positions_;
+        const auto& ranges = patterns.ranges_;
+
+        // classes, boundaries_[c] is the first character of class c.
+        glob_array<std::uint32_t> boundaries;
+        boundaries.push_back(0);
+        for (size_type r = 0; r < ranges.length(); r++) {
+            if (ranges[r].low_ > ranges[r].high_)
+                continue;
+            boundaries.push_back(ranges[r].low_);
+            if (ranges[r].high_ < max_unit)
+                boundaries.push_back(ranges[r].high_ + 1);
+        }
+        std::sort(boundaries.data(), boundaries.data() + boundaries.length());
+        boundary_count_ = static_cast<size_type>(std::unique(boundaries.data(), boundaries.data() + boundaries.length()) - boundaries.data());
+        boundaries_ = new std::uint32_t[boundary_count_];
+        std::memcpy(boundaries_, boundaries.data(), sizeof(std::uint32_t) * boundary_count_);
+        class_count_ = boundary_count_;
+        for (std::uint32_t u = 0; u < 256 && u <= max_unit; u++)
+            classes_[u] = search_class(u);
+
+        // the classes every set takes, a bit each.
+        const auto words = (class_count_ + 63) / 64;
+        glob_array<std::uint64_t> members;
+        members.resize_for_overwrite(positions.length() * words);
+        if (members.length() != 0)
+            std::memset(members.data(), 0, sizeof(std::uint64_t) * members.length());
+        for (size_type p = 0; p < positions.length(); p++) {
+            const auto& position = positions[p];
+            if (position.kind_ != glob_position::set)
+                continue;
+            auto bits = members.data() + p * words;
+            for (auto r = position.first_; r < position.first_ + position.count_; r++) {
+                if (ranges[r].low_ > ranges[r].high_)
+                    continue;
+                const auto last = search_class(ranges[r].high_);
+                for (auto c = search_class(ranges[r].low_); c <= last; c++)
+                    bits[c / 64] |= std::uint64_t(1) << (c % 64);
+            }
+            if (position.negated_) {
+                for (size_type w = 0; w < words; w++)
+                    bits[w] = ~bits[w];
+                // not the bits past the last class.
+                if (class_count_ % 64 != 0)
+                    bits[words - 1] &= (std::uint64_t(1) << (class_count_ % 64)) - 1;
+            }
+        }
+
+        // subset construction. subsets are sorted lists of positions, a star's list has
+        // the position after it as well.
+        glob_array<state_type> subsets;
+        glob_array<size_type> subset_begin;
+        glob_array<state_type> transitions;
+        flat_string_map<state_type> ids;
+        glob_array<state_type> next;
+        glob_array<state_type> stars;
+        glob_array<state_type> moves;
+        auto move_begin = new size_type[class_count_ + 1];
+        auto marks = new size_type[positions.length() + 1]();
+        size_type generation = 0;
+
+        const auto add = [&](state_type position) {
+            for (;;) {
+                if (marks[position] == generation)
+                    return;
+                marks[position] = generation;
+                next.push_back(position);
+                if (positions[position].kind_ != glob_position::star)
+                    return;
+                position++;
+            }
+        };
+        // `next` has to be sorted.
+        const auto intern = [&]() -> state_type {
+            const auto key = as_key(next);
+            if (const auto found = ids.find(key))
+                return *found;
+            const auto id = static_cast<state_type>(subset_begin.length());
+            ids.insert(key, id);
+            subset_begin.push_back(subsets.length());
+            subsets.append(next.data(), next.length());
+            return id;
+        };
+
+        try {
+            generation++;
+            for (size_type p = 0; p < positions.length(); p++) {
+                if (p == 0 || positions[p - 1].kind_ == glob_position::end)
+                    add(static_cast<state_type>(p));
+            }
+            intern();
+
+            for (size_type s = 0; s < subset_begin.length(); s++) {
+                if (static_cast<std::uint64_t>(s + 1) * class_count_ >= 0xffffffffu)
+                    throw std::length_error("from basic_glob_set: the patterns need too many states.");
+
+                // where the positions go, grouped by class. a star stays for every one.
+                stars.clear();
+                for (size_type c = 0; c <= class_count_; c++)
+                    move_begin[c] = 0;
+                const auto begin = subset_begin[s];
+                const auto end = s + 1 < subset_begin.length() ? subset_begin[s + 1] : subsets.length();
+                for (int pass = 0; pass < 2; pass++) {
+                    for (auto i = begin; i < end; i++) {
+                        const auto position = subsets[i];
+                        const auto kind = positions[position].kind_;
+                        if (kind == glob_position::star && pass == 0)
+                            stars.push_back(position);
+                        if (kind != glob_position::set)
+                            continue;
+                        const auto bits = members.data() + position * words;
+                        for (size_type w = 0; w < words; w++) {
+                            for (auto word = bits[w]; word != 0; word &= word - 1) {
+                                const auto c = w * 64 + static_cast<size_type>(std::countr_zero(word));
+                                if (pass == 0)
+                                    move_begin[c + 1]++;
+                                else
+                                    moves[move_begin[c]++] = position + 1;
+                            }
+                        }
+                    }
+                    if (pass == 0) {
+                        for (size_type c = 0; c < class_count_; c++)
+                            move_begin[c + 1] += move_begin[c];
+                        moves.resize_for_overwrite(move_begin[class_count_]);
+                    }
+                }
+
+                // the second pass left move_begin[c] at the end of class c.
+                for (size_type c = 0; c < class_count_; c++) {
+                    generation++;
+                    next.clear();
+                    // both come in order, a merge sorts them.
+                    for (size_type i = 0; i < stars.length(); i++)
+                        add(stars[i]);
+                    const auto stayed = next.length();
+                    for (auto i = c != 0 ? move_begin[c - 1] : 0; i < move_begin[c]; i++)
+                        add(moves[i]);
+                    std::inplace_merge(next.data(), next.data() + stayed, next.data() + next.length());
+                    transitions.push_back(intern());
+                }
+            }
+        }
+        catch (...) {
+            delete[] move_begin;
+            delete[] marks;
+            throw;
+        }
+        delete[] move_begin;
+        delete[] marks;
+
+        const auto subset_count = subset_begin.length();
+        subset_begin.push_back(subsets.length());
+
+        // the patterns a subset matches, its end positions, which come in pattern order.
+        const auto outputs_of = [&](size_type s, glob_array<state_type>& out) {
+            out.clear();
+            for (auto i = subset_begin[s]; i < subset_begin[s + 1]; i++) {
+                const auto& position = positions[subsets[i]];
+                if (position.kind_ == glob_position::end)
+                    out.push_back(position.first_);
+            }
+        };
+
+        // first blocks by outputs, then split until the partition stops changing.
+        auto block = new state_type[subset_count];
+        auto refined = new state_type[subset_count];
+        size_type block_count = 0;
+        {
+            flat_string_map<state_type> keys;
+            for (size_type s = 0; s < subset_count; s++) {
+                outputs_of(s, next);
+                block[s] = key_id(keys, next, block_count);
+            }
+        }
+        for (;;) {
+            flat_string_map<state_type> keys;
+            size_type count = 0;
+            for (size_type s = 0; s < subset_count; s++) {
+                next.clear();
+                next.push_back(block[s]);
+                for (size_type c = 0; c < class_count_; c++)
+                    next.push_back(block[transitions[s * class_count_ + c]]);
+                refined[s] = key_id(keys, next, count);
+            }
+            block = exchange(refined, block);
+            if (count == block_count)
+                break;
+            block_count = count;
+        }
+        delete[] refined;
+
+        // one row per block, taken from the first state in it.
+        auto first_of = new state_type[block_count];
+        for (size_type s = subset_count; s-- != 0;)
+            first_of[block[s]] = static_cast<state_type>(s);
+
+        state_count_ = block_count;
+        table_ = new state_type[block_count * class_count_];
+        for (size_type b = 0; b < block_count; b++) {
+            for (size_type c = 0; c < class_count_; c++)
+                table_[b * class_count_ + c] = static_cast<state_type>(block[transitions[first_of[b] * class_count_ + c]] * class_count_);
+        }
+        start_ = static_cast<state_type>(block[0] * class_count_);
+
+        // the empty subset can't be left, once in it nothing can match anymore.
+        dead_ = npos_state;
+        next.clear();
+        if (const auto found = ids.find(as_key(next)))
+            dead_ = static_cast<state_type>(block[*found] * class_count_);
+
+        output_begin_ = new size_type[block_count + 1];
+        size_type total = 0;
+        for (size_type b = 0; b < block_count; b++) {
+            output_begin_[b] = total;
+            outputs_of(first_of[b], next);
+            total += next.length();
+        }
+        output_begin_[block_count] = total;
+        outputs_ = new std::uint32_t[total != 0 ? total : 1];
+        for (size_type b = 0; b < block_count; b++) {
+            outputs_of(first_of[b], next);
+            if (next.length() != 0)
+                std::memcpy(outputs_ + output_begin_[b], next.data(), sizeof(state_type) * next.length());
+        }
+
+        delete[] first_of;
+        delete[] block;
+    }
+
+    // the state after the whole of `text`, npos_state when no pattern can match anymore.
+    template<typename CharType>
+    inline NODISCARD state_type run(const CharType* data, size_type length) const noexcept {
+        const auto table = table_;
+        const auto dead = dead_;
+        auto state = start_;
+        for (size_type i = 0; i < length; i++) {
+            state = table[state + class_of(data[i])];
+            if (state == dead)
+                return npos_state;
+        }
+        return state;
+    }
+
+    // the patterns `state` matches, in ascending order.
+    inline NODISCARD const std::uint32_t* outputs_begin(state_type state) const noexcept { return outputs_ + output_begin_[state / class_count_]; }
+    inline NODISCARD const std::uint32_t* outputs_end(state_type state) const noexcept { return outputs_ + output_begin_[state / class_count_ + 1]; }
+
+    constexpr static state_type npos_state = 0xffffffffu;
+private:
+    template<typename CharType>
+    inline NODISCARD std::uint32_t class_of(CharType ch) const noexcept {
+        const auto u = glob_patterns::unit(ch);
+        if constexpr (sizeof(CharType) == 1)
+            return classes_[u];
+        else
+            return u < 256 ? classes_[u] : search_class(u);
+    }
+
+    inline NODISCARD std::uint32_t search_class(std::uint32_t u) const noexcept {
+        return static_cast<std::uint32_t>(std::upper_bound(boundaries_, boundaries_ + boundary_count_, u) - boundaries_ - 1);
+    }
+
+    // a list of ids as a map key.
+    static inline NODISCARD string_view as_key(const glob_array<state_type>& list) noexcept {
+        if (list.length() == 0)
+            return string_view("", 0);
+        return string_view(reinterpret_cast<const char*>(list.data()), sizeof(state_type) * list.length());
+    }
+
+    // the id of the list of ids in `key`, a new one when it's not in `keys` yet.
+    static state_type key_id(flat_string_map<state_type>& keys, const glob_array<state_type>& key, size_type& count) {
+        const auto bytes = as_key(key);
+        if (const auto found = keys.find(bytes))
+            return *found;
+        keys.insert(bytes, static_cast<state_type>(count));
+        return static_cast<state_type>(count++);
+    }
+private:
+    std::uint32_t classes_[256] = {};
+    std::uint32_t* boundaries_ = nullptr;
+    size_type boundary_count_ = 0;
+    size_type class_count_ = 1;
+    size_type state_count_ = 0;
+    state_type* table_ = nullptr;
+    state_type start_ = 0;
+    state_type dead_ = npos_state;
+    size_type* output_begin_ = nullptr;
+    std::uint32_t* outputs_ = nullptr;
+};
+
+} // namespace details
+
+// a set of glob patterns compiled to one minimal dfa, for matching a string against
+// all of them in a single pass: routing tables, ignore lists and the like.
+//
+//     xed::glob_set routes({ "/static/*.css", "/api/v[0-9]/users/*", "*.php" });
+//     if (auto route = routes.find_first(path); route != npos) { ... }
+//
+// patterns match the whole string, the way fnmatch does without flags. matching costs
+// a table lookup per character whatever the number of patterns, and stops early once
+// no pattern can match anymore. building can take long for many patterns with stars in
+// the middle, the dfa of those can grow large; std::length_error when it would need
+// more than 2^32 table entries.
+template<typename CharType>
+class basic_glob_set {
+public:
+    using this_type = basic_glob_set;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using string_view = basic_string_view<value_type>;
+
+    basic_glob_set(const string_view* patterns, size_type count) {
+        init(patterns, count);
+    }
+
+    basic_glob_set(std::initializer_list<string_view> patterns) {
+        init(patterns.begin(), patterns.size());
+    }
+
+    basic_glob_set(const basic_glob_set&) = delete;
+    basic_glob_set& operator=(const basic_glob_set&) = delete;
+
+    inline NODISCARD size_type pattern_count() const noexcept { return count_; }
+    // the size of the dfa, its table is state_count() * class_count() entries.
+    inline NODISCARD size_type state_count() const noexcept { return automaton_.state_count(); }
+    inline NODISCARD size_type class_count() const noexcept { return automaton_.class_count(); }
+
+    // whether any pattern matches.
+    inline NODISCARD bool matches(string_view text) const noexcept {
+        const auto state = automaton_.run(text.data(), text.length());
+        return state != automaton_type::npos_state && automaton_.outputs_begin(state) != automaton_.outputs_end(state);
+    }
+
+    // the lowest pattern that matches, npos when none does.
+    inline NODISCARD size_type find_first(string_view text) const noexcept {
+        const auto state = automaton_.run(text.data(), text.length());
+        if (state == automaton_type::npos_state || automaton_.outputs_begin(state) == automaton_.outputs_end(state))
+            return npos;
+        return *automaton_.outputs_begin(state);
+    }
+
+    // fn(pattern) for every pattern that matches, in ascending order. fn can return false
+    // to stop, then this returns false.
+    template<typename Fn>
+    bool for_each_match(string_view text, Fn&& fn) const {
+        const auto state = automaton_.run(text.data(), text.length());
+        if (state == automaton_type::npos_state)
+            return true;
+        for (auto at = automaton_.outputs_begin(state); at != automaton_.outputs_end(state); ++at) {
+            const auto pattern = static_cast<size_type>(*at);
+            if constexpr (std::is_same_v<decltype(fn(pattern)), bool>) {
+                if (!fn(pattern))
+                    return false;
+            }
+            else {
+                fn(pattern);
+            }
+        }
+        return true;
+    }
+
+    // how many patterns match.
+    inline NODISCARD size_type count(string_view text) const noexcept {
+        const auto state = automaton_.run(text.data(), text.length());
+        if (state == automaton_type::npos_state)
+            return 0;
+        return static_cast<size_type>(automaton_.outputs_end(state) - automaton_.outputs_begin(state));
+    }
+private:
+    using automaton_type = details::glob_automaton;
+
+    void init(const string_view* patterns, size_type count) {
+        count_ = count;
+        details::glob_patterns parsed;
+        for (size_type p = 0; p < count; p++)
+            parsed.parse(patterns[p].data(), patterns[p].length(), p);
+        automaton_.build(parsed, sizeof(value_type) >= 4 ? 0xffffffffu : static_cast<std::uint32_t>((1ull << (8 * sizeof(value_type))) - 1));
+    }
+private:
+    size_type count_ = 0;
+    automaton_type automaton_;
+};
+
+using glob_set    = basic_glob_set<char>;
+using wglob_set   = basic_glob_set<wchar_t>;
+using u8glob_set  = basic_glob_set<char8_t>;
+using u16glob_set = basic_glob_set<char16_t>;
+using u32glob_set = basic_glob_set<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_GLOB_SET_HPP
@@ -1,7 +1,21 @@
+#if defined(_MSC_VER)
 #include <vcruntime.h>
+#else
+// no vcruntime.h outside of msvc, derive the same switches from __cplusplus.
+#ifndef _HAS_CXX17
+#define _HAS_CXX11 (__cplusplus >= 201103L)
+#define _HAS_CXX14 (__cplusplus >= 201402L)
+#define _HAS_CXX17 (__cplusplus >= 201703L)
+#define _HAS_CXX20 (__cplusplus >= 202002L)
+#define _HAS_CXX23 (__cplusplus > 202002L)
+#endif
+#endif
 
-#if _HAS_NODISCARD
+#if defined(_MSC_VER) && _HAS_NODISCARD
 #define NODISCARD [[nodiscard]]
+#elif defined(__GNUC__)
+// gcc and clang reject a standard attribute after inline/constexpr, which is where NODISCARD goes.
+#define NODISCARD __attribute__((warn_unused_result))
 #else
 #define NODISCARD
 #endif // !_HAD_NODISCARD
@@ -34,4 +48,20 @@
 #define CONSTEXPR23 constexpr
 #else 
 #define CONSTEXPR23
-#endif
\ No newline at end of file
+#endif
+
+#if defined(__AVX2__)
+#define XED_HAS_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XED_HAS_SSE2 1
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define XED_HAS_SSSE3 1
+#endif
+
+#if defined(_MSC_VER)
+#define NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
\ No newline at end of file
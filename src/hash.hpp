@@ -0,0 +1,392 @@
+#pragma once
+#ifndef XED_HASH_HPP
+#define XED_HASH_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "simd.hpp"
+#include "has_attributes.hpp"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace xed {
+
+constexpr std::size_t hash_long_threshold = 256;
+
+namespace details {
+
+constexpr std::uint64_t hash_secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+// keys for the long input path, one word per 64 bit lane and stripe offset.
+constexpr std::uint64_t hash_stripe_secret[16] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+    0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull,
+    0xcb00c391bb52283cull, 0xa32e531b8b65d088ull, 0x4ef90da297486471ull, 0xd8acdea946ef1938ull,
+    0x3f349ce33f76faa8ull, 0x1d4f0bc7c7bbdcf9ull, 0x3159b4cd4be0518aull, 0x647378d9c97e9fc8ull,
+};
+
+// 64 x 64 -> 128 bit multiply, low half into `a` and high half into `b`.
+constexpr void hash_mum(std::uint64_t& a, std::uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    const auto r = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<std::uint64_t>(r);
+    b = static_cast<std::uint64_t>(r >> 64);
+#else
+#if defined(_MSC_VER) && defined(_M_X64)
+    if (!std::is_constant_evaluated()) {
+        a = _umul128(a, b, &b);
+        return;
+    }
+#endif
+    const auto ha = a >> 32, hb = b >> 32, la = a & 0xffffffffu, lb = b & 0xffffffffu;
+    const auto rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const auto t = rl + (rm0 << 32);
+    const auto lo = t + (rm1 << 32);
+    const auto carry = static_cast<std::uint64_t>(t < rl) + static_cast<std::uint64_t>(lo < t);
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    a = lo;
+#endif
+}
+
+constexpr NODISCARD std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b) noexcept {
+    hash_mum(a, b);
+    return a ^ b;
+}
+
+// the bytes of `data_` as the hash sees them. at run time straight out of memory, in a
+// constant expression by taking the characters apart the way memory holds them, so a
+// string hashed at compile time gets the same value as at run time.
+template<typename CharType>
+struct hash_reader {
+    // the bytes are the memory at data_ as is, so the vector loop can read it directly.
+    static constexpr bool contiguous = true;
+
+    const CharType* data_;
+
+    constexpr NODISCARD byte_type byte(std::size_t offset) const noexcept {
+        if (!std::is_constant_evaluated())
+            return reinterpret_cast<const byte_type*>(data_)[offset];
+
+        using unsigned_type = std::make_unsigned_t<CharType>;
+        const auto index = offset % sizeof(CharType);
+        const auto shift = std::endian::native == std::endian::little ? index : sizeof(CharType) - 1 - index;
+        return static_cast<byte_type>(static_cast<unsigned_type>(data_[offset / sizeof(CharType)]) >> (8 * shift));
+    }
+
+    template<typename T>
+    constexpr NODISCARD T read(std::size_t offset) const noexcept {
+        T value = 0;
+        if (!std::is_constant_evaluated()) {
+            std::memcpy(&value, reinterpret_cast<const byte_type*>(data_) + offset, sizeof(value));
+            return value;
+        }
+        for (std::size_t i = 0; i < sizeof(T); i++) {
+            const auto shift = std::endian::native == std::endian::little ? i : sizeof(T) - 1 - i;
+            value |= static_cast<T>(byte(offset + i)) << (8 * shift);
+        }
+        return value;
+    }
+
+    constexpr NODISCARD std::uint64_t read8(std::size_t offset) const noexcept { return read<std::uint64_t>(offset); }
+    constexpr NODISCARD std::uint64_t read4(std::size_t offset) const noexcept { return read<std::uint32_t>(offset); }
+};
+
+// one 64 byte stripe into the 8 accumulators, the way xxh3 does it: every lane adds the
+// product of the low and high halves of data ^ key, and the raw data of its neighbour.
+template<typename Reader>
+constexpr void hash_accumulate_scalar(std::uint64_t* acc, const Reader& reader, std::size_t offset, const std::uint64_t* key) noexcept {
+    for (std::size_t i = 0; i < 8; i++) {
+        const auto data = reader.read8(offset + 8 * i);
+        const auto keyed = data ^ key[i];
+        acc[i ^ 1] += data;
+        acc[i] += (keyed & 0xffffffffu) * (keyed >> 32);
+    }
+}
+
+// `stripes` consecutive stripes, the key moves one word along with every stripe.
+inline void hash_accumulate(std::uint64_t* acc, const byte_type* ptr, std::size_t stripes, const std::uint64_t* key) noexcept {
+#if XED_HAS_AVX2
+    auto acc0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    auto acc1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4));
+    for (std::size_t s = 0; s < stripes; s++, ptr += 64) {
+        const auto data0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        const auto data1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 32));
+        const auto keyed0 = _mm256_xor_si256(data0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + s)));
+        const auto keyed1 = _mm256_xor_si256(data1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + s + 4)));
+        acc0 = _mm256_add_epi64(acc0, _mm256_mul_epu32(keyed0, _mm256_srli_epi64(keyed0, 32)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_mul_epu32(keyed1, _mm256_srli_epi64(keyed1, 32)));
+        acc0 = _mm256_add_epi64(acc0, _mm256_shuffle_epi32(data0, 0x4e));
+        acc1 = _mm256_add_epi64(acc1, _mm256_shuffle_epi32(data1, 0x4e));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), acc0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4), acc1);
+#elif XED_HAS_SSE2
+    __m128i lanes[4];
+    for (std::size_t r = 0; r < 4; r++)
+        lanes[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * r));
+    for (std::size_t s = 0; s < stripes; s++, ptr += 64) {
+        for (std::size_t r = 0; r < 4; r++) {
+            const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16 * r));
+            const auto keyed = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + s + 2 * r)));
+            lanes[r] = _mm_add_epi64(lanes[r], _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32)));
+            lanes[r] = _mm_add_epi64(lanes[r], _mm_shuffle_epi32(data, 0x4e));
+        }
+    }
+    for (std::size_t r = 0; r < 4; r++)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2 * r), lanes[r]);
+#else
+    const hash_reader<byte_type> reader{ ptr };
+    for (std::size_t s = 0; s < stripes; s++)
+        hash_accumulate_scalar(acc, reader, 64 * s, key + s);
+#endif
+}
+
+// wyhash for everything up to a few hundred bytes.
+template<typename Reader>
+constexpr NODISCARD std::uint64_t hash_short(const Reader& reader, std::size_t length, std::uint64_t seed) noexcept {
+    const auto& secret = hash_secret;
+    seed ^= hash_mix(seed ^ secret[0], secret[1]);
+
+    std::uint64_t a = 0, b = 0;
+    if (length <= 16) {
+        if (length >= 4) {
+            const auto quarter = (length >> 3) << 2;
+            a = (reader.read4(0) << 32) | reader.read4(quarter);
+            b = (reader.read4(length - 4) << 32) | reader.read4(length - 4 - quarter);
+        }
+        else if (length > 0) {
+            a = (std::uint64_t(reader.byte(0)) << 16) | (std::uint64_t(reader.byte(length >> 1)) << 8) | reader.byte(length - 1);
+        }
+    }
+    else {
+        std::size_t offset = 0;
+        auto left = length;
+        if (left > 48) {
+            auto see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(reader.read8(offset) ^ secret[1], reader.read8(offset + 8) ^ seed);
+                see1 = hash_mix(reader.read8(offset + 16) ^ secret[2], reader.read8(offset + 24) ^ see1);
+                see2 = hash_mix(reader.read8(offset + 32) ^ secret[3], reader.read8(offset + 40) ^ see2);
+                offset += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (left > 16) {
+            seed = hash_mix(reader.read8(offset) ^ secret[1], reader.read8(offset + 8) ^ seed);
+            offset += 16;
+            left -= 16;
+        }
+        a = reader.read8(offset + left - 16);
+        b = reader.read8(offset + left - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    hash_mum(a, b);
+    return hash_mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+// long inputs go through 8 independent lanes that the vector units take a stripe at a
+// time; the lanes get scrambled every 512 bytes and folded together at the end.
+template<typename Reader>
+constexpr NODISCARD std::uint64_t hash_long(const Reader& reader, std::size_t length, std::uint64_t seed) noexcept {
+    constexpr std::size_t stripe = 64;
+    constexpr std::size_t stripes_per_block = 8;
+
+    std::uint64_t key[16] = {};
+    for (std::size_t i = 0; i < 16; i++)
+        key[i] = hash_stripe_secret[i] ^ seed;
+
+    std::uint64_t acc[8] = {
+        0x00000000c2b2ae3dull, 0x9e3779b185ebca87ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull,
+        0x85ebca77c2b2ae63ull, 0x0000000085ebca77ull, 0x27d4eb2f165667c5ull, 0x000000009e3779b1ull,
+    };
+
+    const auto accumulate = [&](std::size_t offset, std::size_t stripes) {
+        if constexpr (Reader::contiguous) {
+            if (!std::is_constant_evaluated()) {
+                hash_accumulate(acc, reinterpret_cast<const byte_type*>(reader.data_) + offset, stripes, key);
+                return;
+            }
+        }
+        for (std::size_t s = 0; s < stripes; s++)
+            hash_accumulate_scalar(acc, reader, offset + stripe * s, key + s);
+    };
+
+    // the last stripe is always taken from the very end, so it may overlap the one before.
+    const auto stripes = (length - 1) / stripe;
+    const auto blocks = stripes / stripes_per_block;
+    for (std::size_t block = 0; block < blocks; block++) {
+        accumulate(block * stripe * stripes_per_block, stripes_per_block);
+        for (std::size_t i = 0; i < 8; i++)
+            acc[i] = (acc[i] ^ (acc[i] >> 47) ^ key[8 + i]) * 0x9e3779b1u;
+    }
+    accumulate(blocks * stripe * stripes_per_block, stripes - blocks * stripes_per_block);
+    hash_accumulate_scalar(acc, reader, length - stripe, key + 7);
+
+    auto hash = length * 0x9e3779b185ebca87ull;
+    for (std::size_t i = 0; i < 8; i += 2)
+        hash += hash_mix(acc[i] ^ key[i + 3], acc[i + 1] ^ key[i + 4]);
+
+    hash ^= hash >> 37;
+    hash *= 0x165667919e3779f9ull;
+    return hash ^ (hash >> 32);
+}
+
+template<typename Reader>
+constexpr NODISCARD std::uint64_t hash_any(const Reader& reader, std::size_t bytes, std::uint64_t seed) noexcept {
+    return bytes <= hash_long_threshold ? hash_short(reader, bytes, seed) : hash_long(reader, bytes, seed);
+}
+
+} // namespace details
+
+// 64 bit hash of any bytes, wyhash up to hash_long_threshold and an xxh3 style vector
+// loop past it. the result is the same whatever instruction set the loop ran on.
+inline NODISCARD std::uint64_t hash_bytes(const void* data, std::size_t bytes, std::uint64_t seed = 0) noexcept {
+    return details::hash_any(details::hash_reader<details::byte_type>{ static_cast<const details::byte_type*>(data) }, bytes, seed);
+}
+
+// the same value as hash_bytes over the characters, and usable in constant expressions.
+template<typename CharType>
+constexpr NODISCARD std::uint64_t hash_string(basic_string_view<CharType> str, std::uint64_t seed = 0) noexcept {
+    return details::hash_any(details::hash_reader<CharType>{ str.data() }, sizeof(CharType) * str.length(), seed);
+}
+
+// a basic_string that carries its hash, worked out once when it is made. there is no
+// way to change the characters in place, so the hash can't go stale; assign a new one.
+template<typename CharType, typename Allocator = allocator<CharType>>
+class basic_hashed_string {
+public:
+    using this_type = basic_hashed_string;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using allocator_type = Allocator;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+    using string_type = basic_string<value_type, allocator_type>;
+public:
+    basic_hashed_string() noexcept
+        : hash_(hash_string(string_view(str_))) {
+    }
+
+    basic_hashed_string(string_view str, const allocator_type& alloc = allocator_type())
+        : str_(str.data(), str.length(), alloc)
+        , hash_(hash_string(str)) {
+    }
+
+    basic_hashed_string(const_pointer_type str, const allocator_type& alloc = allocator_type())
+        : basic_hashed_string(string_view(str), alloc) {
+    }
+
+    explicit basic_hashed_string(string_type&& str) noexcept
+        : str_(move(str))
+        , hash_(hash_string(string_view(str_))) {
+    }
+
+    inline NODISCARD operator string_view() const noexcept { return str_; }
+    inline NODISCARD const string_type& str() const noexcept { return str_; }
+    inline NODISCARD const_pointer_type data() const noexcept { return str_.data(); }
+    inline NODISCARD size_type length() const noexcept { return str_.length(); }
+    inline NODISCARD std::uint64_t hash() const noexcept { return hash_; }
+
+    // gives the string back, the hashed string is left empty.
+    NODISCARD string_type release() noexcept {
+        hash_ = hash_string(string_view("", 0));
+        return exchange(str_, string_type());
+    }
+
+    // different hashes settle most unequal pairs without reading the characters.
+    inline NODISCARD bool operator==(const basic_hashed_string& other) const noexcept {
+        return hash_ == other.hash_ && str_ == string_view(other.str_);
+    }
+
+    inline NODISCARD bool operator!=(const basic_hashed_string& other) const noexcept {
+        return !(*this == other);
+    }
+
+    inline NODISCARD bool operator==(string_view other) const noexcept { return str_ == other; }
+    inline NODISCARD bool operator!=(string_view other) const noexcept { return str_ != other; }
+private:
+    string_type str_;
+    std::uint64_t hash_;
+};
+
+using hashed_string    = basic_hashed_string<char>;
+using whashed_string   = basic_hashed_string<wchar_t>;
+using u8hashed_string  = basic_hashed_string<char8_t>;
+using u16hashed_string = basic_hashed_string<char16_t>;
+using u32hashed_string = basic_hashed_string<char32_t>;
+
+// hasher for anything that converts to a basic_string_view<CharType>. transparent,
+// so containers can look up by view without building a string first.
+template<typename CharType = char>
+struct basic_string_hash {
+    using is_transparent = void;
+    using string_view = basic_string_view<CharType>;
+
+    std::uint64_t seed_ = 0;
+
+    inline NODISCARD std::uint64_t operator()(string_view str) const noexcept {
+        return hash_string(str, seed_);
+    }
+
+    // the cached hash is only good for the default seed.
+    template<typename Allocator>
+    inline NODISCARD std::uint64_t operator()(const basic_hashed_string<CharType, Allocator>& str) const noexcept {
+        return seed_ == 0 ? str.hash() : hash_string(string_view(str), seed_);
+    }
+};
+
+using string_hash    = basic_string_hash<char>;
+using wstring_hash   = basic_string_hash<wchar_t>;
+using u8string_hash  = basic_string_hash<char8_t>;
+using u16string_hash = basic_string_hash<char16_t>;
+using u32string_hash = basic_string_hash<char32_t>;
+
+// the equality that goes with basic_string_hash, transparent as well.
+template<typename CharType = char>
+struct basic_string_equal {
+    using is_transparent = void;
+    using string_view = basic_string_view<CharType>;
+
+    inline NODISCARD bool operator()(string_view a, string_view b) const noexcept {
+        return a == b;
+    }
+};
+
+} // namespace xed
+
+template<typename CharType>
+struct std::hash<xed::basic_string_view<CharType>> {
+    inline NODISCARD std::size_t operator()(xed::basic_string_view<CharType> str) const noexcept {
+        return static_cast<std::size_t>(xed::hash_string(str));
+    }
+};
+
+template<typename CharType, typename Allocator>
+struct std::hash<xed::basic_string<CharType, Allocator>> {
+    inline NODISCARD std::size_t operator()(const xed::basic_string<CharType, Allocator>& str) const noexcept {
+        return static_cast<std::size_t>(xed::hash_string(xed::basic_string_view<CharType>(str)));
+    }
+};
+
+template<typename CharType, typename Allocator>
+struct std::hash<xed::basic_hashed_string<CharType, Allocator>> {
+    inline NODISCARD std::size_t operator()(const xed::basic_hashed_string<CharType, Allocator>& str) const noexcept {
+        return static_cast<std::size_t>(str.hash());
+    }
+};
+
+#include "undef.hpp"
+
+#endif // !XED_HASH_HPP
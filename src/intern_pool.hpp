@@ -0,0 +1,210 @@
+#pragma once
+#ifndef XED_INTERN_POOL_HPP
+#define XED_INTERN_POOL_HPP 1
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "allocator.hpp"
+#include "hash.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+// keeps one copy of every distinct string and hands out symbols pointing at it. the
+// copies live in arenas owned by the pool and never move, so a symbol stays valid as
+// long as the pool does and two symbols from the same pool are equal exactly when
+// they point at the same copy. the table is split in shards with a lock each, the
+// shard comes from the hash, so threads interning different strings rarely meet.
+template<typename CharType>
+class basic_intern_pool {
+public:
+    using this_type = basic_intern_pool;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+
+    constexpr static size_type shard_count = 64;
+private:
+    struct entry {
+        std::uint64_t hash_;
+        size_type length_;
+    };
+
+    static inline NODISCARD const_pointer_type characters(const entry* e) noexcept {
+        return reinterpret_cast<const_pointer_type>(e + 1);
+    }
+public:
+    class symbol {
+    public:
+        symbol() noexcept = default;
+
+        inline NODISCARD operator string_view() const noexcept { return { data(), length() }; }
+        inline NODISCARD string_view view() const noexcept { return *this; }
+
+        inline NODISCARD const_pointer_type data() const noexcept {
+            return entry_ != nullptr ? characters(entry_) : empty_;
+        }
+
+        inline NODISCARD size_type length() const noexcept { return entry_ != nullptr ? entry_->length_ : 0; }
+        inline NODISCARD bool is_empty() const noexcept { return entry_ == nullptr; }
+
+        // computed once when the string was interned.
+        inline NODISCARD std::uint64_t hash() const noexcept { return entry_ != nullptr ? entry_->hash_ : 0; }
+
+        inline NODISCARD bool operator==(const symbol& other) const noexcept { return entry_ == other.entry_; }
+        inline NODISCARD bool operator!=(const symbol& other) const noexcept { return entry_ != other.entry_; }
+    private:
+        friend class basic_intern_pool;
+
+        explicit symbol(const entry* e) noexcept : entry_(e) {}
+    private:
+        const entry* entry_ = nullptr;
+
+        constexpr static value_type empty_[1] = {};
+    };
+public:
+    basic_intern_pool() noexcept = default;
+
+    basic_intern_pool(const basic_intern_pool&) = delete;
+    basic_intern_pool& operator=(const basic_intern_pool&) = delete;
+
+    ~basic_intern_pool() noexcept {
+        for (auto& shard : shards_)
+            delete[] shard.slots_;
+    }
+
+    // safe to call from any number of threads at once.
+    NODISCARD symbol intern(string_view str) {
+        if (str.length() == 0)
+            return {};
+
+        const auto hash = hash_of(str);
+        auto& shard = shard_of(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+
+        auto slot = find_slot(shard, hash, str);
+        if (*slot != nullptr)
+            return symbol(*slot);
+
+        if ((shard.size_ + 1) * 2 > shard.capacity_) {
+            grow(shard);
+            slot = find_slot(shard, hash, str);
+        }
+
+        void* memory = shard.arena_.allocate(sizeof(entry) + sizeof(value_type) * (str.length() + 1), alignof(entry));
+        auto e = new (memory) entry{ hash, str.length() };
+        auto chars = const_cast<value_type*>(characters(e));
+        std::memcpy(chars, str.data(), sizeof(value_type) * str.length());
+        chars[str.length()] = '\0';
+
+        *slot = e;
+        shard.size_++;
+        return symbol(e);
+    }
+
+    // the symbol for `str` if it was interned before, an empty one otherwise.
+    NODISCARD symbol find(string_view str) const {
+        if (str.length() == 0)
+            return {};
+
+        const auto hash = hash_of(str);
+        auto& shard = const_cast<this_type*>(this)->shard_of(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        return symbol(*find_slot(shard, hash, str));
+    }
+
+    // number of distinct strings.
+    NODISCARD size_type size() const {
+        size_type total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            total += shard.size_;
+        }
+        return total;
+    }
+
+    // what the copies and the tables take.
+    NODISCARD size_type bytes_used() const {
+        size_type total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            total += shard.arena_.bytes_allocated() + sizeof(const entry*) * shard.capacity_;
+        }
+        return total;
+    }
+private:
+    // own cache line each, so threads on different shards don't fight over the locks.
+    struct alignas(64) shard {
+        mutable std::mutex mutex_;
+        const entry** slots_ = nullptr;
+        size_type capacity_ = 0;
+        size_type size_ = 0;
+        monotonic_arena arena_;
+    };
+
+    static inline NODISCARD std::uint64_t hash_of(string_view str) noexcept {
+        return hash_string(str);
+    }
+
+    // the top bits pick the shard, the low ones the slot inside it.
+    inline NODISCARD shard& shard_of(std::uint64_t hash) noexcept {
+        return shards_[hash >> 58];
+    }
+
+    // the slot holding `str`, or the empty one where it belongs. linear probing.
+    static NODISCARD const entry** find_slot(const shard& s, std::uint64_t hash, string_view str) noexcept {
+        static const entry* none = nullptr;
+        if (s.capacity_ == 0)
+            return &none;
+
+        const auto mask = s.capacity_ - 1;
+        for (auto index = static_cast<size_type>(hash) & mask;; index = (index + 1) & mask) {
+            const auto e = s.slots_[index];
+            if (e == nullptr)
+                return &s.slots_[index];
+
+            if (e->hash_ == hash && e->length_ == str.length()
+                && std::memcmp(characters(e), str.data(), sizeof(value_type) * str.length()) == 0)
+                return &s.slots_[index];
+        }
+    }
+
+    static void grow(shard& s) {
+        const auto capacity = s.capacity_ != 0 ? s.capacity_ * 2 : 64;
+        auto slots = new const entry*[capacity]();
+
+        const auto mask = capacity - 1;
+        for (size_type i = 0; i < s.capacity_; i++) {
+            const auto e = s.slots_[i];
+            if (e == nullptr)
+                continue;
+
+            auto index = static_cast<size_type>(e->hash_) & mask;
+            while (slots[index] != nullptr)
+                index = (index + 1) & mask;
+            slots[index] = e;
+        }
+
+        delete[] exchange(s.slots_, slots);
+        s.capacity_ = capacity;
+    }
+private:
+    shard shards_[shard_count];
+};
+
+using intern_pool    = basic_intern_pool<char>;
+using wintern_pool   = basic_intern_pool<wchar_t>;
+using u8intern_pool  = basic_intern_pool<char8_t>;
+using u16intern_pool = basic_intern_pool<char16_t>;
+using u32intern_pool = basic_intern_pool<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_INTERN_POOL_HPP
@@ -0,0 +1,207 @@
+#pragma once
+#ifndef XED_MAPPED_FILE_HPP
+#define XED_MAPPED_FILE_HPP 1
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "split.hpp"
+#include "has_attributes.hpp"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xed {
+
+// a whole file mapped read only and seen as one string_view, so find, split and the
+// rest run straight on the page cache without reading the file into a string first.
+// the view is valid until the mapped_file is closed or destroyed.
+class mapped_file {
+public:
+    using size_type = std::size_t;
+    using value_type = char;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+    using record_range = basic_split_range<value_type, details::char_delimiter<value_type>>;
+
+    // what the kernel should expect, so it can read ahead or not.
+    enum class access { normal, sequential, random };
+public:
+    mapped_file() noexcept = default;
+
+    // throws std::system_error when the file can't be opened or mapped.
+    explicit mapped_file(const char* path) {
+        open(path);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : data_(exchange(other.data_, nullptr))
+        , length_(exchange(other.length_, 0))
+        , open_(exchange(other.open_, false)) {
+    }
+
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        mapped_file temp(move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~mapped_file() noexcept {
+        close();
+    }
+
+    void swap(mapped_file& other) noexcept {
+        data_ = exchange(other.data_, data_);
+        length_ = exchange(other.length_, length_);
+        open_ = exchange(other.open_, open_);
+    }
+
+    void open(const char* path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw_error(static_cast<int>(::GetLastError()), std::system_category(), path);
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file, &size)) {
+            const auto error = static_cast<int>(::GetLastError());
+            ::CloseHandle(file);
+            throw_error(error, std::system_category(), path);
+        }
+
+        // windows refuses to map an empty file, which is fine, there is nothing to see.
+        if (size.QuadPart != 0) {
+            HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const auto error = static_cast<int>(::GetLastError());
+            ::CloseHandle(file);
+            if (mapping == nullptr)
+                throw_error(error, std::system_category(), path);
+
+            void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            const auto view_error = static_cast<int>(::GetLastError());
+            ::CloseHandle(mapping);
+            if (view == nullptr)
+                throw_error(view_error, std::system_category(), path);
+
+            data_ = static_cast<const_pointer_type>(view);
+            length_ = static_cast<size_type>(size.QuadPart);
+        }
+        else {
+            ::CloseHandle(file);
+        }
+#else
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw_error(errno, std::generic_category(), path);
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw_error(error, std::generic_category(), path);
+        }
+
+        // mmap refuses a length of 0, an empty file simply has no mapping.
+        if (status.st_size != 0) {
+            void* view = ::mmap(nullptr, static_cast<size_type>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if (view == MAP_FAILED)
+                throw_error(error, std::generic_category(), path);
+
+            data_ = static_cast<const_pointer_type>(view);
+            length_ = static_cast<size_type>(status.st_size);
+        }
+        else {
+            ::close(fd);
+        }
+#endif
+        open_ = true;
+    }
+
+    void close() noexcept {
+        if (data_ != nullptr) {
+#if defined(_WIN32)
+            ::UnmapViewOfFile(data_);
+#else
+            ::munmap(const_cast<value_type*>(data_), length_);
+#endif
+        }
+        data_ = nullptr;
+        length_ = 0;
+        open_ = false;
+    }
+
+    inline NODISCARD bool is_open() const noexcept { return open_; }
+    inline NODISCARD bool is_empty() const noexcept { return length_ == 0; }
+    inline NODISCARD size_type length() const noexcept { return length_; }
+    inline NODISCARD const_pointer_type data() const noexcept { return data_ != nullptr ? data_ : ""; }
+
+    inline NODISCARD string_view view() const noexcept { return { data(), length_ }; }
+    inline NODISCARD operator string_view() const noexcept { return view(); }
+
+    // only a hint, and one windows has no equivalent of, so it is ignored there.
+    void advise(access pattern) const noexcept {
+#if !defined(_WIN32)
+        if (data_ == nullptr)
+            return;
+
+        const int advice = pattern == access::sequential ? MADV_SEQUENTIAL
+            : pattern == access::random ? MADV_RANDOM
+            : MADV_NORMAL;
+        ::madvise(const_cast<value_type*>(data_), length_, advice);
+#else
+        (void)pattern;
+#endif
+    }
+
+    // the records ending in `delimiter`, without it. a delimiter at the very end doesn't
+    // start another, empty record. tells the kernel the file is read front to back.
+    NODISCARD record_range records(value_type delimiter) const noexcept {
+        advise(access::sequential);
+
+        auto length = length_;
+        const bool empty_file = length == 0;
+        if (length != 0 && data_[length - 1] == delimiter)
+            length--;
+        return split(string_view(data(), length), delimiter, { empty_file });
+    }
+
+    // a '\r' in front of the '\n' stays part of the line.
+    inline NODISCARD record_range lines() const noexcept {
+        return records('\n');
+    }
+private:
+    [[noreturn]] static void throw_error(int error, const std::error_category& category, const char* path) {
+        throw std::system_error(error, category, std::string("from mapped_file: ") + path);
+    }
+private:
+    const_pointer_type data_ = nullptr;
+    size_type length_ = 0;
+    bool open_ = false;
+};
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_MAPPED_FILE_HPP
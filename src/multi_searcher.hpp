@@ -0,0 +1,598 @@
+#pragma once
+#ifndef XED_MULTI_SEARCHER_HPP
+#define XED_MULTI_SEARCHER_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include "xutility.hpp"
+#include "simd.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+struct multi_match {
+    // index of the pattern, in the order they were given.
+    std::size_t pattern_;
+    std::size_t position_;
+    std::size_t length_;
+};
+
+namespace details {
+
+// fn(match) may return void, or bool with false to stop the search.
+template<typename Fn>
+inline bool multi_report(Fn& fn, const multi_match& match) {
+    if constexpr (std::is_same_v<decltype(fn(match)), bool>)
+        return fn(match);
+    else {
+        fn(match);
+        return true;
+    }
+}
+
+// aho-corasick as a dfa: every state has a transition for every byte class, the
+// failure links are folded into the table while building, so the search is one load
+// per byte. bytes that occur in no pattern share a class, which keeps rows as short as
+// the patterns' alphabet. states are numbered with the matching ones last and stored
+// multiplied by the row length, so the loop is a load, an add and one compare. the
+// table is states times classes times 4 bytes, made for hundreds to a few thousand
+// patterns rather than a dictionary. std::length_error when the states, premultiplied,
+// might not fit in 32 bits.
+class multi_automaton {
+public:
+    using size_type = std::size_t;
+    using state_type = std::uint32_t;
+
+    multi_automaton() noexcept = default;
+
+    multi_automaton(const multi_automaton&) = delete;
+    multi_automaton& operator=(const multi_automaton&) = delete;
+
+    ~multi_automaton() noexcept {
+        delete[] table_;
+        delete[] output_begin_;
+        delete[] outputs_;
+    }
+
+    // `patterns` hold bytes, lengths in bytes. empty ones never match.
+    void build(const byte_type* const* patterns, const size_type* lengths, size_type count) {
+        // byte classes, 0 for every byte no pattern has.
+        size_type class_count = 1;
+        for (size_type p = 0; p < count; p++) {
+            for (size_type i = 0; i < lengths[p]; i++) {
+                if (classes_[patterns[p][i]] == 0)
+                    classes_[patterns[p][i]] = static_cast<std::uint16_t>(class_count++);
+            }
+        }
+        class_count_ = class_count;
+
+        // the trie, 0 is "no child" since nothing goes back to the root.
+        size_type max_states = 1;
+        for (size_type p = 0; p < count; p++)
+            max_states += lengths[p];
+        // every state is stored times the row length, checked against the most the trie
+        // could need so nothing is allocated for patterns that can't be built.
+        if (max_states > 0xffffffffu / class_count)
+            throw std::length_error("from basic_multi_searcher: the patterns need too many states.");
+        auto trie = new state_type[max_states * class_count]();
+        auto terminal = new size_type[max_states];
+        auto next_terminal = new size_type[count != 0 ? count : 1];
+        for (size_type s = 0; s < max_states; s++)
+            terminal[s] = npos;
+
+        size_type state_count = 1;
+        // patterns are added last to first, so each terminal list comes out by pattern.
+        for (size_type p = count; p-- != 0;) {
+            if (lengths[p] == 0)
+                continue;
+            size_type state = 0;
+            for (size_type i = 0; i < lengths[p]; i++) {
+                auto& child = trie[state * class_count + classes_[patterns[p][i]]];
+                if (child == 0)
+                    child = static_cast<state_type>(state_count++);
+                state = child;
+            }
+            next_terminal[p] = terminal[state];
+            terminal[state] = p;
+        }
+
+        // breadth first, so the failure state of everything in a level is done. missing
+        // transitions become the failure state's, outputs get the failure state's added.
+        auto fail = new state_type[state_count]();
+        auto order = new state_type[state_count];
+        auto output_count = new size_type[state_count]();
+        size_type head = 0, tail = 0;
+        order[tail++] = 0;
+        while (head < tail) {
+            const auto state = order[head++];
+            for (size_type c = 0; c < class_count; c++) {
+                auto& next = trie[state * class_count + c];
+                if (next != 0) {
+                    fail[next] = state != 0 ? trie[fail[state] * class_count + c] : 0;
+                    order[tail++] = next;
+                }
+                else {
+                    next = state != 0 ? trie[fail[state] * class_count + c] : 0;
+                }
+            }
+        }
+
+        // output lists, the state's own patterns merged with its failure state's, which
+        // keeps them sorted by pattern.
+        size_type total_outputs = 0;
+        for (size_type i = 0; i < state_count; i++) {
+            const auto state = order[i];
+            size_type own = 0;
+            for (auto p = terminal[state]; p != npos; p = next_terminal[p])
+                own++;
+            output_count[state] = own + (state != 0 ? output_count[fail[state]] : 0);
+            total_outputs += output_count[state];
+        }
+
+        // matching states last.
+        auto renumber = new state_type[state_count];
+        state_type id = 0;
+        for (size_type s = 0; s < state_count; s++) {
+            if (output_count[s] == 0)
+                renumber[s] = id++;
+        }
+        first_match_ = static_cast<state_type>(id * class_count);
+        match_states_ = state_count - id;
+        for (size_type s = 0; s < state_count; s++) {
+            if (output_count[s] != 0)
+                renumber[s] = id++;
+        }
+
+        table_ = new state_type[state_count * class_count];
+        for (size_type s = 0; s < state_count; s++) {
+            for (size_type c = 0; c < class_count; c++)
+                table_[renumber[s] * class_count + c] = static_cast<state_type>(renumber[trie[s * class_count + c]] * class_count);
+        }
+
+        // output_begin_ is indexed by match state, in their new order.
+        output_begin_ = new size_type[match_states_ + 1];
+        outputs_ = new std::uint32_t[total_outputs != 0 ? total_outputs : 1];
+        const auto first_match_index = state_count - match_states_;
+        auto by_new = new state_type[match_states_ != 0 ? match_states_ : 1];
+        for (size_type s = 0; s < state_count; s++) {
+            if (output_count[s] != 0)
+                by_new[renumber[s] - first_match_index] = static_cast<state_type>(s);
+        }
+
+        // in bfs order the failure state's list is always written before it is merged.
+        size_type written = 0;
+        for (size_type m = 0; m < match_states_; m++) {
+            output_begin_[m] = written;
+            written += output_count[by_new[m]];
+        }
+        output_begin_[match_states_] = written;
+        for (size_type i = 0; i < state_count; i++) {
+            const auto state = order[i];
+            if (output_count[state] == 0)
+                continue;
+
+            auto out = outputs_ + output_begin_[renumber[state] - first_match_index];
+            const std::uint32_t* inherited = nullptr;
+            size_type inherited_count = 0;
+            if (state != 0 && output_count[fail[state]] != 0) {
+                inherited = outputs_ + output_begin_[renumber[fail[state]] - first_match_index];
+                inherited_count = output_count[fail[state]];
+            }
+            auto own = terminal[state];
+            size_type j = 0;
+            while (own != npos || j < inherited_count) {
+                if (own != npos && (j == inherited_count || own < inherited[j])) {
+                    *out++ = static_cast<std::uint32_t>(own);
+                    own = next_terminal[own];
+                }
+                else {
+                    *out++ = inherited[j++];
+                }
+            }
+        }
+
+        delete[] by_new;
+        delete[] renumber;
+        delete[] output_count;
+        delete[] order;
+        delete[] fail;
+        delete[] next_terminal;
+        delete[] terminal;
+        delete[] trie;
+    }
+
+    // calls match(end, pattern) for every pattern that ends right before `end`, by end
+    // and then by pattern. false from match stops it and returns false.
+    template<typename Match>
+    bool run(const byte_type* data, size_type length, Match&& match) const {
+        const auto table = table_;
+        const auto first_match = first_match_;
+        state_type state = 0;
+        for (size_type i = 0; i < length; i++) {
+            state = table[state + classes_[data[i]]];
+            if (state >= first_match) {
+                const auto m = (state - first_match) / class_count_;
+                for (auto o = output_begin_[m]; o < output_begin_[m + 1]; o++) {
+                    if (!match(i + 1, static_cast<size_type>(outputs_[o])))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+private:
+    std::uint16_t classes_[256] = {};
+    size_type class_count_ = 1;
+    state_type* table_ = nullptr;
+    state_type first_match_ = 0;
+    size_type match_states_ = 0;
+    size_type* output_begin_ = nullptr;
+    std::uint32_t* outputs_ = nullptr;
+};
+
+#if XED_HAS_SIMD_BLOCK
+// a simd filter over the end positions of a block, for small sets. patterns go in 8
+// buckets, consecutive ones together, a byte of the filter has the bits of the buckets
+// that could end there and only those patterns get compared.
+//
+// with a byte shuffle it's teddy: the last three bytes of every pattern, split in
+// nibbles, go into 16 entry tables of bucket bits and one lookup per nibble and byte
+// covers the whole block. patterns shorter than three bytes match anything in the
+// missing places. without a shuffle every pattern is a bucket of its own and its last
+// two bytes are compared as they are, which pays off up to 8 patterns.
+class multi_fingerprint {
+public:
+    using size_type = std::size_t;
+    using register_type = simd_block::register_type;
+
+    constexpr static size_type bucket_count = 8;
+#if XED_HAS_SIMD_SHUFFLE
+    constexpr static size_type max_patterns = 32;
+    constexpr static size_type fingerprint_length = 3;
+#else
+    constexpr static size_type max_patterns = 8;
+    constexpr static size_type fingerprint_length = 2;
+#endif
+
+    void build(const byte_type* const* patterns, const size_type* lengths, size_type count) noexcept {
+        patterns_ = patterns;
+        lengths_ = lengths;
+        count_ = count;
+        per_bucket_ = (count + bucket_count - 1) / bucket_count;
+
+        for (size_type p = 0; p < count; p++) {
+            if (lengths[p] == 0)
+                continue;
+#if XED_HAS_SIMD_SHUFFLE
+            const auto bit = static_cast<byte_type>(1u << (p / per_bucket_));
+            for (size_type k = 0; k < fingerprint_length; k++) {
+                if (k < lengths[p]) {
+                    const auto ch = patterns[p][lengths[p] - 1 - k];
+                    low_[k][ch & 0x0f] |= bit;
+                    high_[k][ch >> 4] |= bit;
+                }
+                else {
+                    for (size_type n = 0; n < 16; n++) {
+                        low_[k][n] |= bit;
+                        high_[k][n] |= bit;
+                    }
+                }
+            }
+#else
+            for (size_type k = 0; k < fingerprint_length; k++) {
+                any_[p][k] = k >= lengths[p];
+                last_[p][k] = k < lengths[p] ? patterns[p][lengths[p] - 1 - k] : 0;
+            }
+#endif
+        }
+    }
+
+    template<typename Match>
+    bool run(const byte_type* data, size_type length, Match&& match) const {
+        constexpr auto block = simd_block::size;
+        size_type end = 0;
+        // the first positions have no full fingerprint before them.
+        for (; end < length && end < fingerprint_length - 1; end++) {
+            if (!verify(data, end, scalar_buckets(data, end), match))
+                return false;
+        }
+
+        if (length >= block + fingerprint_length - 1) {
+            registers r;
+            prepare(r);
+            const auto zero = simd_block::splat(0);
+
+            alignas(32) byte_type buckets[block];
+            for (; end + block <= length; end += block) {
+                const auto found = block_buckets(r, data + end);
+                auto candidates = ~simd_block::eq_mask(found, zero) & block_mask();
+                if (candidates == 0)
+                    continue;
+                simd_block::store(buckets, found);
+                while (candidates != 0) {
+                    const auto j = static_cast<size_type>(std::countr_zero(candidates));
+                    candidates &= candidates - 1;
+                    if (!verify(data, end + j, buckets[j], match))
+                        return false;
+                }
+            }
+        }
+
+        for (; end < length; end++) {
+            if (!verify(data, end, scalar_buckets(data, end), match))
+                return false;
+        }
+        return true;
+    }
+private:
+#if XED_HAS_SIMD_SHUFFLE
+    struct registers {
+        register_type low_[fingerprint_length];
+        register_type high_[fingerprint_length];
+        register_type nibble_;
+    };
+
+    inline void prepare(registers& r) const noexcept {
+        for (size_type k = 0; k < fingerprint_length; k++) {
+            r.low_[k] = simd_block::load_table(low_[k]);
+            r.high_[k] = simd_block::load_table(high_[k]);
+        }
+        r.nibble_ = simd_block::splat(0x0f);
+    }
+
+    // `at` is the first end position of the block, the loads reach back before it.
+    inline NODISCARD register_type block_buckets(const registers& r, const byte_type* at) const noexcept {
+        auto found = simd_block::splat(0xff);
+        for (size_type k = 0; k < fingerprint_length; k++) {
+            const auto bytes = simd_block::load(at - k);
+            const auto lo = simd_block::lookup(r.low_[k], simd_block::bit_and(bytes, r.nibble_));
+            const auto hi = simd_block::lookup(r.high_[k], simd_block::high_nibbles(bytes));
+            found = simd_block::bit_and(found, simd_block::bit_and(lo, hi));
+        }
+        return found;
+    }
+
+    inline NODISCARD byte_type scalar_buckets(const byte_type* data, size_type end) const noexcept {
+        byte_type found = 0xff;
+        for (size_type k = 0; k < fingerprint_length && k <= end; k++) {
+            const auto ch = data[end - k];
+            found &= low_[k][ch & 0x0f] & high_[k][ch >> 4];
+        }
+        return found;
+    }
+#else
+    // the last two bytes of every pattern, and its bit, splatted once per run.
+    struct registers {
+        register_type last_[max_patterns][fingerprint_length];
+        register_type bit_[max_patterns];
+    };
+
+    inline void prepare(registers& r) const noexcept {
+        for (size_type p = 0; p < count_; p++) {
+            for (size_type k = 0; k < fingerprint_length; k++)
+                r.last_[p][k] = simd_block::splat(last_[p][k]);
+            r.bit_[p] = simd_block::splat(lengths_[p] != 0 ? static_cast<byte_type>(1u << p) : 0);
+        }
+    }
+
+    inline NODISCARD register_type block_buckets(const registers& r, const byte_type* at) const noexcept {
+        const auto current = simd_block::load(at);
+        const auto previous = simd_block::load(at - 1);
+        auto found = simd_block::splat(0);
+        for (size_type p = 0; p < count_; p++) {
+            const auto current_hit = simd_block::eq(current, r.last_[p][0]);
+            const auto previous_hit = any_[p][1] ? current_hit : simd_block::eq(previous, r.last_[p][1]);
+            found = simd_block::bit_or(found, simd_block::bit_and(r.bit_[p], simd_block::bit_and(current_hit, previous_hit)));
+        }
+        return found;
+    }
+
+    inline NODISCARD byte_type scalar_buckets(const byte_type* data, size_type end) const noexcept {
+        byte_type found = 0;
+        for (size_type p = 0; p < count_; p++) {
+            bool hit = lengths_[p] != 0;
+            for (size_type k = 0; k < fingerprint_length && k <= end; k++)
+                hit = hit && (any_[p][k] || data[end - k] == last_[p][k]);
+            found |= static_cast<byte_type>(hit << p);
+        }
+        return found;
+    }
+#endif
+
+    static constexpr NODISCARD std::uint32_t block_mask() noexcept {
+        return simd_block::size == 32 ? 0xffffffffu : (1u << simd_block::size) - 1;
+    }
+
+    // the patterns of `buckets` that end at `end`, buckets and so patterns in order.
+    template<typename Match>
+    inline bool verify(const byte_type* data, size_type end, unsigned buckets, Match& match) const {
+        while (buckets != 0) {
+            const auto bucket = static_cast<size_type>(std::countr_zero(buckets));
+            buckets &= buckets - 1;
+            const auto last = (bucket + 1) * per_bucket_ < count_ ? (bucket + 1) * per_bucket_ : count_;
+            for (auto p = bucket * per_bucket_; p < last; p++) {
+                const auto len = lengths_[p];
+                if (len != 0 && len <= end + 1 && std::memcmp(data + end + 1 - len, patterns_[p], len) == 0) {
+                    if (!match(end + 1, p))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+private:
+#if XED_HAS_SIMD_SHUFFLE
+    byte_type low_[fingerprint_length][16] = {};
+    byte_type high_[fingerprint_length][16] = {};
+#else
+    byte_type last_[max_patterns][fingerprint_length] = {};
+    bool any_[max_patterns][fingerprint_length] = {};
+#endif
+    const byte_type* const* patterns_ = nullptr;
+    const size_type* lengths_ = nullptr;
+    size_type count_ = 0;
+    size_type per_bucket_ = 1;
+};
+#endif
+
+} // namespace details
+
+// finds every occurrence of any of a set of patterns in one pass over the text, instead
+// of a find per pattern. built once, searched many times, from any number of threads.
+//
+//     xed::multi_searcher blocked({ "casino", "lottery", "viagra" });
+//     blocked.for_each_match(body, [&](const xed::multi_match& m) { ... });
+//
+// small sets of one byte patterns go through a simd fingerprint of their last bytes,
+// up to 32 where the build has a byte shuffle (ssse3, avx2) and 8 with plain sse2,
+// anything else through an aho-corasick automaton. either way every match is reported,
+// overlapping ones and patterns inside other patterns included, ordered by where they
+// end and then by pattern. empty patterns never match. the patterns are copied, they
+// needn't outlive the searcher. std::length_error when the automaton would need more
+// than 2^32 table entries.
+template<typename CharType>
+class basic_multi_searcher {
+public:
+    using this_type = basic_multi_searcher;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using string_view = basic_string_view<value_type>;
+
+    basic_multi_searcher(const string_view* patterns, size_type count) {
+        init(patterns, count);
+    }
+
+    basic_multi_searcher(std::initializer_list<string_view> patterns) {
+        init(patterns.begin(), patterns.size());
+    }
+
+    basic_multi_searcher(const basic_multi_searcher&) = delete;
+    basic_multi_searcher& operator=(const basic_multi_searcher&) = delete;
+
+    ~basic_multi_searcher() noexcept {
+        delete[] characters_;
+        delete[] patterns_;
+        delete[] lengths_;
+    }
+
+    inline NODISCARD size_type pattern_count() const noexcept { return count_; }
+    // whether the simd fingerprint does the searching rather than the automaton.
+    inline NODISCARD bool uses_fingerprint() const noexcept { return uses_fingerprint_; }
+
+    // fn(const multi_match&) for every match, it can return false to stop. returns false
+    // when it was stopped.
+    template<typename Fn>
+    bool for_each_match(string_view text, Fn&& fn) const {
+        const auto data = as_bytes(text.data());
+        const auto bytes = sizeof(value_type) * text.length();
+        const auto report = [&](size_type end, size_type pattern) {
+            const auto start = end - lengths_[pattern];
+            // a match of wider characters has to start on a character.
+            if constexpr (sizeof(value_type) != 1) {
+                if (start % sizeof(value_type) != 0)
+                    return true;
+            }
+            return details::multi_report(fn, { pattern, start / sizeof(value_type), lengths_[pattern] / sizeof(value_type) });
+        };
+
+#if XED_HAS_SIMD_BLOCK
+        if (uses_fingerprint_)
+            return fingerprint_.run(data, bytes, report);
+#endif
+        return automaton_.run(data, bytes, report);
+    }
+
+    // the match that ends first, the lowest pattern when several end there. position_
+    // is npos when there is none.
+    NODISCARD multi_match find(string_view text) const {
+        multi_match found{ npos, npos, 0 };
+        for_each_match(text, [&](const multi_match& m) {
+            found = m;
+            return false;
+        });
+        return found;
+    }
+
+    inline NODISCARD bool contains_any(string_view text) const {
+        return find(text).position_ != npos;
+    }
+
+    // how many matches there are, overlapping ones included.
+    NODISCARD size_type count(string_view text) const {
+        size_type count = 0;
+        for_each_match(text, [&](const multi_match&) { count++; });
+        return count;
+    }
+private:
+    using byte_type = details::byte_type;
+
+    static inline NODISCARD const byte_type* as_bytes(const value_type* ptr) noexcept {
+        return reinterpret_cast<const byte_type*>(ptr);
+    }
+
+    void init(const string_view* patterns, size_type count) {
+        count_ = count;
+        size_type total = 0;
+        for (size_type p = 0; p < count; p++)
+            total += patterns[p].length();
+
+        characters_ = new value_type[total != 0 ? total : 1];
+        patterns_ = new const byte_type*[count != 0 ? count : 1];
+        lengths_ = new size_type[count != 0 ? count : 1];
+        size_type offset = 0;
+        for (size_type p = 0; p < count; p++) {
+            if (patterns[p].length() != 0)
+                std::memcpy(characters_ + offset, patterns[p].data(), sizeof(value_type) * patterns[p].length());
+            patterns_[p] = as_bytes(characters_ + offset);
+            lengths_[p] = sizeof(value_type) * patterns[p].length();
+            offset += patterns[p].length();
+        }
+
+#if XED_HAS_SIMD_BLOCK
+        if (sizeof(value_type) == 1 && count <= details::multi_fingerprint::max_patterns) {
+            uses_fingerprint_ = true;
+            fingerprint_.build(patterns_, lengths_, count);
+            return;
+        }
+#endif
+        try {
+            automaton_.build(patterns_, lengths_, count);
+        }
+        catch (...) {
+            // the destructor doesn't run for a constructor that throws.
+            delete[] characters_;
+            delete[] patterns_;
+            delete[] lengths_;
+            throw;
+        }
+    }
+private:
+    value_type* characters_ = nullptr;
+    const byte_type** patterns_ = nullptr;
+    // in bytes.
+    size_type* lengths_ = nullptr;
+    size_type count_ = 0;
+    bool uses_fingerprint_ = false;
+#if XED_HAS_SIMD_BLOCK
+    details::multi_fingerprint fingerprint_;
+#endif
+    details::multi_automaton automaton_;
+};
+
+using multi_searcher    = basic_multi_searcher<char>;
+using wmulti_searcher   = basic_multi_searcher<wchar_t>;
+using u8multi_searcher  = basic_multi_searcher<char8_t>;
+using u16multi_searcher = basic_multi_searcher<char16_t>;
+using u32multi_searcher = basic_multi_searcher<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_MULTI_SEARCHER_HPP
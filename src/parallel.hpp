@@ -0,0 +1,82 @@
+#pragma once
+#ifndef XED_PARALLEL_HPP
+#define XED_PARALLEL_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "xutility.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+namespace details {
+
+// 0 asks for one thread per core.
+inline NODISCARD unsigned thread_count(unsigned threads) noexcept {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    return threads != 0 ? threads : 1;
+}
+
+// calls fn(task) for every task in [0, task_count) on up to `threads` threads, the
+// calling one included. each thread takes the next task when it is done with one, in
+// order, so tasks of uneven cost still spread out. the first exception a task throws
+// comes out of here once every thread is done, the tasks not started by then are skipped.
+template<typename Fn>
+void parallel_for(unsigned threads, std::size_t task_count, Fn&& fn) {
+    if (threads > task_count)
+        threads = static_cast<unsigned>(task_count);
+    if (threads <= 1) {
+        for (std::size_t task = 0; task < task_count; task++)
+            fn(task);
+        return;
+    }
+
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+    std::mutex error_lock;
+
+    const auto work = [&] {
+        for (;;) {
+            const auto task = next.fetch_add(1, std::memory_order_relaxed);
+            if (task >= task_count || failed.load(std::memory_order_relaxed))
+                return;
+            try {
+                fn(task);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (!error)
+                    error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    auto workers = new std::thread[threads - 1];
+    unsigned started = 0;
+    try {
+        for (; started < threads - 1; started++)
+            workers[started] = std::thread(work);
+    }
+    catch (...) {
+        // no more threads to be had, the ones running and this one do the rest.
+    }
+    work();
+    for (unsigned t = 0; t < started; t++)
+        workers[t].join();
+    delete[] workers;
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace details
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_PARALLEL_HPP
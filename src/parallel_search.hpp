@@ -0,0 +1,326 @@
+#pragma once
+#ifndef XED_PARALLEL_SEARCH_HPP
+#define XED_PARALLEL_SEARCH_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "xutility.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "parallel.hpp"
+#include "has_attributes.hpp"
+
+// find, find_all and count for inputs big enough that one core scanning them is the
+// bottleneck, mapped files of many gigabytes and the like. the input is cut into chunks
+// that threads take in order; a chunk owns the matches that start inside it and reads
+// needle length - 1 characters past its end so none across a boundary get lost. matches
+// are the same non overlapping ones string_view::count sees, left to right.
+namespace xed {
+
+// positions in ascending order, what parallel_find_all returns.
+class position_list {
+public:
+    using size_type = std::size_t;
+    using const_iterator = const size_type*;
+
+    position_list() noexcept = default;
+
+    position_list(const position_list&) = delete;
+    position_list& operator=(const position_list&) = delete;
+
+    position_list(position_list&& other) noexcept
+        : data_(exchange(other.data_, nullptr))
+        , length_(exchange(other.length_, 0))
+        , capacity_(exchange(other.capacity_, 0)) {
+    }
+
+    position_list& operator=(position_list&& other) noexcept {
+        position_list temp(move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~position_list() noexcept {
+        delete[] data_;
+    }
+
+    void swap(position_list& other) noexcept {
+        data_ = exchange(other.data_, data_);
+        length_ = exchange(other.length_, length_);
+        capacity_ = exchange(other.capacity_, capacity_);
+    }
+
+    inline NODISCARD size_type length() const noexcept { return length_; }
+    inline NODISCARD bool is_empty() const noexcept { return length_ == 0; }
+    inline NODISCARD const size_type* data() const noexcept { return data_; }
+    inline NODISCARD size_type operator[](size_type index) const noexcept { return data_[index]; }
+
+    inline NODISCARD const_iterator begin() const noexcept { return data_; }
+    inline NODISCARD const_iterator end() const noexcept { return data_ + length_; }
+
+    inline void push_back(size_type position) {
+        if (length_ == capacity_)
+            reserve(capacity_ != 0 ? capacity_ * 2 : 16);
+        data_[length_++] = position;
+    }
+
+    void append(const size_type* positions, size_type count) {
+        if (count == 0)
+            return;
+        if (capacity_ - length_ < count)
+            reserve(length_ + count > capacity_ * 2 ? length_ + count : capacity_ * 2);
+        std::memcpy(data_ + length_, positions, sizeof(size_type) * count);
+        length_ += count;
+    }
+
+    void reserve(size_type capacity) {
+        if (capacity <= capacity_)
+            return;
+        auto data = new size_type[capacity];
+        if (length_ != 0)
+            std::memcpy(data, data_, sizeof(size_type) * length_);
+        delete[] exchange(data_, data);
+        capacity_ = capacity;
+    }
+private:
+    size_type* data_ = nullptr;
+    size_type length_ = 0;
+    size_type capacity_ = 0;
+};
+
+namespace details {
+
+// characters per chunk. inputs under two chunks aren't worth a thread.
+constexpr std::size_t parallel_search_chunk = 1 << 20;
+// the matches a chunk keeps for parallel_count, to line up with the one before it.
+constexpr std::size_t parallel_count_positions = 16;
+
+// one chunk's matches, found as if the input started with the chunk.
+struct search_chunk {
+    std::size_t count_ = 0;
+    // where the last match ends.
+    std::size_t end_ = 0;
+    // all of the matches, or the first few.
+    position_list positions_;
+};
+
+// the leftmost match that starts in [from, end), reading up to `limit`.
+template<typename CharType>
+inline NODISCARD std::size_t find_in_chunk(basic_string_view<CharType> text, basic_string_view<CharType> needle, std::size_t from, std::size_t end, std::size_t limit) noexcept {
+    if (from >= end)
+        return npos;
+    const auto pos = find_substring(text.data() + from, limit - from, needle.data(), needle.length());
+    return pos != npos && from + pos < end ? from + pos : npos;
+}
+
+template<typename CharType>
+struct parallel_searcher {
+    using string_view = basic_string_view<CharType>;
+
+    string_view text_;
+    string_view needle_;
+    std::size_t chunk_count_;
+
+    parallel_searcher(string_view text, string_view needle) noexcept
+        : text_(text)
+        , needle_(needle)
+        , chunk_count_((text.length() + parallel_search_chunk - 1) / parallel_search_chunk) {
+    }
+
+    inline NODISCARD std::size_t chunk_begin(std::size_t chunk) const noexcept { return chunk * parallel_search_chunk; }
+
+    inline NODISCARD std::size_t chunk_end(std::size_t chunk) const noexcept {
+        const auto end = chunk_begin(chunk) + parallel_search_chunk;
+        return end < text_.length() ? end : text_.length();
+    }
+
+    // how far the chunk reads, its own end plus what a match starting at its last
+    // character needs.
+    inline NODISCARD std::size_t chunk_limit(std::size_t chunk) const noexcept {
+        const auto end = chunk_end(chunk);
+        const auto left = text_.length() - end;
+        return end + (needle_.length() - 1 < left ? needle_.length() - 1 : left);
+    }
+
+    inline NODISCARD std::size_t find(std::size_t chunk, std::size_t from) const noexcept {
+        return find_in_chunk(text_, needle_, from, chunk_end(chunk), chunk_limit(chunk));
+    }
+
+    // the chunk's own matches, keeping up to `max_positions` of them.
+    void scan(std::size_t chunk, search_chunk& out, std::size_t max_positions) const {
+        for (auto pos = find(chunk, chunk_begin(chunk)); pos != npos; pos = find(chunk, pos + needle_.length())) {
+            if (out.count_ < max_positions)
+                out.positions_.push_back(pos);
+            out.count_++;
+            out.end_ = pos + needle_.length();
+        }
+    }
+
+    // joins the chunks in order. the matches of a chunk are only right if the one before
+    // ended before its first match; when a match of the previous chunk runs into it, the
+    // chunk is searched again from where that match ends until a match lines up with one
+    // it found itself, from there on they agree. periodic text can keep them from ever
+    // lining up, then that chunk is searched again all the way, on this thread.
+    // positions go to `out` unless it's null.
+    std::size_t join(search_chunk* chunks, position_list* out) const {
+        std::size_t total = 0;
+        std::size_t previous_end = 0;
+        for (std::size_t chunk = 0; chunk < chunk_count_; chunk++) {
+            auto& c = chunks[chunk];
+            if (c.count_ == 0)
+                continue;
+
+            const auto& own = c.positions_;
+            if (own[0] >= previous_end) {
+                if (out != nullptr)
+                    out->append(own.data(), own.length());
+                total += c.count_;
+                previous_end = c.end_;
+                continue;
+            }
+
+            for (auto pos = find(chunk, previous_end); pos != npos; pos = find(chunk, previous_end)) {
+                const auto at = lower_bound(own, pos);
+                if (at < own.length() && own[at] == pos) {
+                    if (out != nullptr)
+                        out->append(own.data() + at, own.length() - at);
+                    total += c.count_ - at;
+                    previous_end = c.end_;
+                    break;
+                }
+                if (out != nullptr)
+                    out->push_back(pos);
+                total++;
+                previous_end = pos + needle_.length();
+            }
+        }
+        return total;
+    }
+
+    static inline NODISCARD std::size_t lower_bound(const position_list& list, std::size_t pos) noexcept {
+        std::size_t low = 0, high = list.length();
+        while (low < high) {
+            const auto mid = low + (high - low) / 2;
+            if (list[mid] < pos)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+};
+
+} // namespace details
+
+// the first match, like find, using up to `threads` threads, 0 for one per core. chunks
+// are taken front to back, so once a match turns up only the chunks before it are
+// still searched.
+template<typename CharType>
+NODISCARD std::size_t parallel_find(basic_string_view<CharType> text, basic_string_view<CharType> needle, unsigned threads = 0) {
+    if (needle.length() == 0 || text.length() < 2 * details::parallel_search_chunk)
+        return text.find(needle);
+
+    const details::parallel_searcher<CharType> searcher(text, needle);
+    std::atomic<std::size_t> first{ npos };
+    details::parallel_for(details::thread_count(threads), searcher.chunk_count_, [&](std::size_t chunk) {
+        if (searcher.chunk_begin(chunk) >= first.load(std::memory_order_relaxed))
+            return;
+        const auto pos = searcher.find(chunk, searcher.chunk_begin(chunk));
+        if (pos == npos)
+            return;
+        auto current = first.load(std::memory_order_relaxed);
+        while (pos < current && !first.compare_exchange_weak(current, pos, std::memory_order_relaxed)) {
+        }
+    });
+    return first.load(std::memory_order_relaxed);
+}
+
+inline NODISCARD std::size_t parallel_find(string_view text, string_view needle, unsigned threads = 0) {
+    return parallel_find<char>(text, needle, threads);
+}
+
+// every match, non overlapping like count sees them, in ascending order.
+template<typename CharType>
+NODISCARD position_list parallel_find_all(basic_string_view<CharType> text, basic_string_view<CharType> needle, unsigned threads = 0) {
+    position_list ret;
+    if (needle.length() == 0)
+        return ret;
+
+    if (text.length() < 2 * details::parallel_search_chunk) {
+        for (auto pos = text.find(needle); pos != npos; pos = text.find(needle, pos + needle.length()))
+            ret.push_back(pos);
+        return ret;
+    }
+
+    const details::parallel_searcher<CharType> searcher(text, needle);
+
+    auto chunks = new details::search_chunk[searcher.chunk_count_];
+    try {
+        details::parallel_for(details::thread_count(threads), searcher.chunk_count_, [&](std::size_t chunk) {
+            searcher.scan(chunk, chunks[chunk], npos);
+        });
+
+        std::size_t total = 0;
+        for (std::size_t chunk = 0; chunk < searcher.chunk_count_; chunk++)
+            total += chunks[chunk].count_;
+        ret.reserve(total);
+        searcher.join(chunks, &ret);
+    }
+    catch (...) {
+        delete[] chunks;
+        throw;
+    }
+    delete[] chunks;
+    return ret;
+}
+
+inline NODISCARD position_list parallel_find_all(string_view text, string_view needle, unsigned threads = 0) {
+    return parallel_find_all<char>(text, needle, threads);
+}
+
+// the number of non overlapping matches, the same as count.
+template<typename CharType>
+NODISCARD std::size_t parallel_count(basic_string_view<CharType> text, basic_string_view<CharType> needle, unsigned threads = 0) {
+    if (needle.length() == 0 || text.length() < 2 * details::parallel_search_chunk)
+        return text.count(needle);
+
+    const details::parallel_searcher<CharType> searcher(text, needle);
+    const auto thread_count = details::thread_count(threads);
+
+    // single characters can't overlap, every chunk just counts.
+    if (needle.length() == 1) {
+        std::atomic<std::size_t> total{ 0 };
+        details::parallel_for(thread_count, searcher.chunk_count_, [&](std::size_t chunk) {
+            const auto begin = searcher.chunk_begin(chunk);
+            const auto count = details::count_char(text.data() + begin, searcher.chunk_end(chunk) - begin, needle[0]);
+            total.fetch_add(count, std::memory_order_relaxed);
+        });
+        return total.load(std::memory_order_relaxed);
+    }
+
+    auto chunks = new details::search_chunk[searcher.chunk_count_];
+    std::size_t total = 0;
+    try {
+        details::parallel_for(thread_count, searcher.chunk_count_, [&](std::size_t chunk) {
+            searcher.scan(chunk, chunks[chunk], details::parallel_count_positions);
+        });
+        total = searcher.join(chunks, nullptr);
+    }
+    catch (...) {
+        delete[] chunks;
+        throw;
+    }
+    delete[] chunks;
+    return total;
+}
+
+inline NODISCARD std::size_t parallel_count(string_view text, string_view needle, unsigned threads = 0) {
+    return parallel_count<char>(text, needle, threads);
+}
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_PARALLEL_SEARCH_HPP
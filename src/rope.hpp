@@ -0,0 +1,415 @@
+#pragma once
+#ifndef XED_ROPE_HPP
+#define XED_ROPE_HPP 1
+
+#include <cstdint>
+#include <cstring>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+// text for large documents that keep being edited. the characters live in chunks of
+// at most chunk_capacity, the chunks are the nodes of a treap ordered by position and
+// every node knows how many characters its subtree holds, so finding a position,
+// inserting and erasing all take O(log n) whatever the document size is.
+template<typename CharType>
+class rope {
+public:
+    using this_type = rope;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using pointer_type = value_type*;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+
+    constexpr static size_type chunk_capacity = 1024 / sizeof(value_type);
+private:
+    struct node {
+        node* left_ = nullptr;
+        node* right_ = nullptr;
+        std::uint32_t priority_;
+        size_type length_ = 0;
+        size_type total_ = 0;
+        value_type data_[chunk_capacity];
+
+        explicit node(std::uint32_t priority) noexcept : priority_(priority) {}
+    };
+public:
+    // walks the chunks in order. each step is a descent from the root, so a full walk is
+    // O(chunks * log n); for_each_chunk does the same walk in O(chunks).
+    class chunk_iterator {
+    public:
+        chunk_iterator(const rope* owner, size_type position) noexcept
+            : owner_(owner)
+            , position_(position) {
+        }
+
+        inline NODISCARD string_view operator*() const noexcept {
+            size_type offset = position_;
+            const node* n = find_node(owner_->root_, offset);
+            return { n->data_ + offset, n->length_ - offset };
+        }
+
+        chunk_iterator& operator++() noexcept {
+            position_ += (**this).length();
+            return *this;
+        }
+
+        inline NODISCARD bool operator==(const chunk_iterator& other) const noexcept { return position_ == other.position_; }
+        inline NODISCARD bool operator!=(const chunk_iterator& other) const noexcept { return position_ != other.position_; }
+
+        inline NODISCARD size_type position() const noexcept { return position_; }
+    private:
+        const rope* owner_;
+        size_type position_;
+    };
+
+    struct chunk_range {
+        chunk_iterator begin_;
+        chunk_iterator end_;
+
+        inline NODISCARD chunk_iterator begin() const noexcept { return begin_; }
+        inline NODISCARD chunk_iterator end() const noexcept { return end_; }
+    };
+public:
+    rope() noexcept = default;
+
+    rope(string_view str) {
+        insert(0, str);
+    }
+
+    rope(const rope& other) {
+        other.for_each_chunk([this](string_view chunk) { append(chunk); });
+    }
+
+    rope(rope&& other) noexcept
+        : root_(exchange(other.root_, nullptr))
+        , seed_(other.seed_) {
+    }
+
+    rope& operator=(const rope& other) {
+        rope temp(other);
+        this->swap(temp);
+        return *this;
+    }
+
+    rope& operator=(rope&& other) noexcept {
+        rope temp(move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~rope() noexcept {
+        destroy(root_);
+    }
+
+    void swap(rope& other) noexcept {
+        root_ = exchange(other.root_, root_);
+        seed_ = exchange(other.seed_, seed_);
+    }
+
+    inline NODISCARD size_type length() const noexcept { return total_of(root_); }
+    inline NODISCARD bool is_empty() const noexcept { return root_ == nullptr; }
+
+    inline NODISCARD value_type operator[](size_type index) const noexcept {
+        const node* n = find_node(root_, index);
+        return n->data_[index];
+    }
+
+    inline NODISCARD value_type at(size_type index) const {
+        if (index >= length())
+            throw std::out_of_range("from rope<>::at method.");
+
+        return (*this)[index];
+    }
+
+    rope& insert(size_type offset, string_view str) {
+        if (str.length() == 0)
+            return *this;
+
+        if (offset > length())
+            offset = length();
+
+        // the common small edit fits into the chunk it lands in.
+        if (insert_in_place(root_, offset, str))
+            return *this;
+
+        node* left;
+        node* right;
+        split(root_, offset, left, right);
+        root_ = join(join(left, build(str)), right);
+        return *this;
+    }
+
+    inline rope& append(string_view str) {
+        return insert(length(), str);
+    }
+
+    rope& erase(size_type offset, size_type amount = 1) {
+        const auto len = length();
+        if (offset >= len || amount == 0)
+            return *this;
+
+        if (amount > len - offset)
+            amount = len - offset;
+
+        if (erase_in_place(root_, offset, amount))
+            return *this;
+
+        node* left;
+        node* middle;
+        node* right;
+        split(root_, offset, left, right);
+        split(right, amount, middle, right);
+        destroy(middle);
+        root_ = join(left, right);
+        return *this;
+    }
+
+    inline rope& replace(size_type offset, size_type amount, string_view with) {
+        erase(offset, amount);
+        return insert(offset, with);
+    }
+
+    void clear() noexcept {
+        destroy(exchange(root_, nullptr));
+    }
+
+    // calls fn(string_view) for every chunk, in order.
+    template<typename Fn>
+    void for_each_chunk(Fn&& fn) const {
+        for_each_chunk(root_, fn);
+    }
+
+    inline NODISCARD chunk_range chunks() const noexcept {
+        return { chunk_iterator(this, 0), chunk_iterator(this, length()) };
+    }
+
+    // one allocation for the whole document.
+    template<typename Allocator = allocator<value_type>>
+    NODISCARD basic_string<value_type, Allocator> str(const Allocator& alloc = Allocator()) const {
+        basic_string<value_type, Allocator> ret(alloc);
+        ret.reserve(length() + 1);
+        for_each_chunk([&ret](string_view chunk) { ret += chunk; });
+        return ret;
+    }
+private:
+    static inline NODISCARD size_type total_of(const node* n) noexcept { return n ? n->total_ : 0; }
+
+    static inline void update(node* n) noexcept {
+        n->total_ = total_of(n->left_) + n->length_ + total_of(n->right_);
+    }
+
+    // returns the node holding `index` and turns `index` into an offset inside it.
+    static NODISCARD const node* find_node(const node* n, size_type& index) noexcept {
+        for (;;) {
+            const auto left_total = total_of(n->left_);
+            if (index < left_total) {
+                n = n->left_;
+            }
+            else if (index - left_total < n->length_) {
+                index -= left_total;
+                return n;
+            }
+            else {
+                index -= left_total + n->length_;
+                n = n->right_;
+            }
+        }
+    }
+
+    inline NODISCARD std::uint32_t next_priority() noexcept {
+        // xorshift32, the priorities only have to look random to the shape of the tree.
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    inline NODISCARD node* make_node(const_pointer_type str, size_type length) {
+        node* n = new node(next_priority());
+        std::memcpy(n->data_, str, sizeof(value_type) * length);
+        n->length_ = length;
+        n->total_ = length;
+        return n;
+    }
+
+    static void destroy(node* n) noexcept {
+        while (n != nullptr) {
+            destroy(n->left_);
+            delete exchange(n, n->right_);
+        }
+    }
+
+    static node* merge(node* left, node* right) noexcept {
+        if (left == nullptr)
+            return right;
+        if (right == nullptr)
+            return left;
+
+        if (left->priority_ > right->priority_) {
+            left->right_ = merge(left->right_, right);
+            update(left);
+            return left;
+        }
+        right->left_ = merge(left, right->left_);
+        update(right);
+        return right;
+    }
+
+    // `left` gets the first `offset` characters, `right` the rest. an offset inside a
+    // chunk cuts it in two, the second half keeps the priority so the heap order holds.
+    void split(node* n, size_type offset, node*& left, node*& right) {
+        if (n == nullptr) {
+            left = right = nullptr;
+            return;
+        }
+
+        const auto left_total = total_of(n->left_);
+        if (offset <= left_total) {
+            split(n->left_, offset, left, n->left_);
+            update(n);
+            right = n;
+            return;
+        }
+
+        if (offset >= left_total + n->length_) {
+            split(n->right_, offset - left_total - n->length_, n->right_, right);
+            update(n);
+            left = n;
+            return;
+        }
+
+        const auto cut = offset - left_total;
+        node* tail = make_node(n->data_ + cut, n->length_ - cut);
+        tail->priority_ = n->priority_;
+        tail->right_ = exchange(n->right_, nullptr);
+        n->length_ = cut;
+        update(tail);
+        update(n);
+        left = n;
+        right = tail;
+    }
+
+    // merges and, when the two chunks meeting at the seam fit into one, folds the first
+    // chunk of `right` into the last one of `left` so edits don't leave slivers behind.
+    node* join(node* left, node* right) {
+        if (left == nullptr || right == nullptr)
+            return merge(left, right);
+
+        const node* first = right;
+        while (first->left_ != nullptr)
+            first = first->left_;
+
+        if (last_length(left) + first->length_ <= chunk_capacity) {
+            node* head;
+            split(right, first->length_, head, right);
+            append_to_last(left, { head->data_, head->length_ });
+            destroy(head);
+        }
+        return merge(left, right);
+    }
+
+    static NODISCARD size_type last_length(const node* n) noexcept {
+        while (n->right_ != nullptr)
+            n = n->right_;
+        return n->length_;
+    }
+
+    static void append_to_last(node* n, string_view str) noexcept {
+        for (; n->right_ != nullptr; n = n->right_)
+            n->total_ += str.length();
+
+        std::memcpy(n->data_ + n->length_, str.data(), sizeof(value_type) * str.length());
+        n->length_ += str.length();
+        n->total_ += str.length();
+    }
+
+    // finds the chunk `offset` lands in, at its end when it sits on a boundary, and
+    // inserts there if it has room, fixing the totals on the way back up.
+    static bool insert_in_place(node* n, size_type offset, string_view str) noexcept {
+        if (n == nullptr)
+            return false;
+
+        const auto left_total = total_of(n->left_);
+        bool inserted;
+        if (offset < left_total) {
+            inserted = insert_in_place(n->left_, offset, str);
+        }
+        else if (offset - left_total <= n->length_) {
+            inserted = n->length_ + str.length() <= chunk_capacity;
+            if (inserted) {
+                const auto at = offset - left_total;
+                std::memmove(n->data_ + at + str.length(), n->data_ + at, sizeof(value_type) * (n->length_ - at));
+                std::memcpy(n->data_ + at, str.data(), sizeof(value_type) * str.length());
+                n->length_ += str.length();
+            }
+        }
+        else {
+            inserted = insert_in_place(n->right_, offset - left_total - n->length_, str);
+        }
+
+        if (inserted)
+            n->total_ += str.length();
+        return inserted;
+    }
+
+    // same idea for a range that sits inside a single chunk and leaves some of it.
+    static bool erase_in_place(node* n, size_type offset, size_type amount) noexcept {
+        if (n == nullptr)
+            return false;
+
+        const auto left_total = total_of(n->left_);
+        bool erased;
+        if (offset < left_total) {
+            erased = erase_in_place(n->left_, offset, amount);
+        }
+        else if (offset - left_total < n->length_) {
+            const auto at = offset - left_total;
+            erased = at + amount <= n->length_ && amount < n->length_;
+            if (erased) {
+                std::memmove(n->data_ + at, n->data_ + at + amount, sizeof(value_type) * (n->length_ - at - amount));
+                n->length_ -= amount;
+            }
+        }
+        else {
+            erased = erase_in_place(n->right_, offset - left_total - n->length_, amount);
+        }
+
+        if (erased)
+            n->total_ -= amount;
+        return erased;
+    }
+
+    // a run of full chunks for a large insert.
+    node* build(string_view str) {
+        node* root = nullptr;
+        for (size_type done = 0; done < str.length(); done += chunk_capacity) {
+            const auto length = str.length() - done < chunk_capacity ? str.length() - done : chunk_capacity;
+            root = merge(root, make_node(str.data() + done, length));
+        }
+        return root;
+    }
+
+    template<typename Fn>
+    static void for_each_chunk(const node* n, Fn& fn) {
+        while (n != nullptr) {
+            for_each_chunk(n->left_, fn);
+            if (n->length_ != 0)
+                fn(string_view(n->data_, n->length_));
+            n = n->right_;
+        }
+    }
+private:
+    node* root_ = nullptr;
+    std::uint32_t seed_ = 0x9e3779b9u;
+};
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_ROPE_HPP
@@ -0,0 +1,162 @@
+#pragma once
+#ifndef XED_SHARED_STRING_HPP
+#define XED_SHARED_STRING_HPP 1
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+// immutable string for handing the same payload to many threads. the reference count,
+// the length and the characters share one allocation, copying only bumps the count and
+// the characters never change, so any number of threads can read them without locks.
+// to modify one, take a basic_string copy with to_string().
+template<typename CharType>
+class basic_shared_string {
+public:
+    using this_type = basic_shared_string;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using const_pointer_type = const value_type*;
+    using const_reference_type = const value_type&;
+    using string_view = basic_string_view<value_type>;
+    using const_iterator = const_pointer_type;
+public:
+    basic_shared_string() noexcept = default;
+
+    basic_shared_string(string_view str) {
+        if (str.length() == 0)
+            return;
+
+        void* memory = ::operator new(sizeof(header) + sizeof(value_type) * (str.length() + 1));
+        header_ = new (memory) header{ { 1 }, str.length() };
+
+        auto chars = const_cast<value_type*>(characters(header_));
+        std::memcpy(chars, str.data(), sizeof(value_type) * str.length());
+        chars[str.length()] = '\0';
+    }
+
+    basic_shared_string(const_pointer_type str)
+        : basic_shared_string(string_view(str)) {
+    }
+
+    basic_shared_string(const basic_shared_string& other) noexcept
+        : header_(other.header_) {
+        // relaxed is enough, whoever copies already holds a reference keeping it alive.
+        if (header_ != nullptr)
+            header_->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    basic_shared_string(basic_shared_string&& other) noexcept
+        : header_(exchange(other.header_, nullptr)) {
+    }
+
+    basic_shared_string& operator=(const basic_shared_string& other) noexcept {
+        basic_shared_string temp(other);
+        this->swap(temp);
+        return *this;
+    }
+
+    basic_shared_string& operator=(basic_shared_string&& other) noexcept {
+        basic_shared_string temp(move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~basic_shared_string() noexcept {
+        // the last owner has to see every other owner's reads finished before it frees.
+        if (header_ != nullptr && header_->count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            header_->~header();
+            ::operator delete(header_);
+        }
+    }
+
+    void swap(basic_shared_string& other) noexcept {
+        header_ = exchange(other.header_, header_);
+    }
+
+    inline NODISCARD operator string_view() const noexcept {
+        return { data(), length() };
+    }
+
+    inline NODISCARD const_pointer_type data() const noexcept {
+        return header_ != nullptr ? characters(header_) : empty_;
+    }
+
+    inline NODISCARD size_type length() const noexcept { return header_ != nullptr ? header_->length_ : 0; }
+    inline NODISCARD bool is_empty() const noexcept { return header_ == nullptr; }
+
+    // only a snapshot when other threads copy or drop the same string at the same time.
+    inline NODISCARD size_type use_count() const noexcept {
+        return header_ != nullptr ? header_->count_.load(std::memory_order_relaxed) : 0;
+    }
+
+    inline NODISCARD const_reference_type operator[](size_type index) const noexcept {
+        return data()[index];
+    }
+
+    inline NODISCARD const_iterator begin() const noexcept { return data(); }
+    inline NODISCARD const_iterator end() const noexcept { return data() + length(); }
+
+    inline NODISCARD bool operator==(string_view other) const noexcept {
+        return length() == other.length() && std::memcmp(data(), other.data(), sizeof(value_type) * length()) == 0;
+    }
+
+    inline NODISCARD bool operator!=(string_view other) const noexcept {
+        return !(*this == other);
+    }
+
+    inline NODISCARD bool operator==(const_pointer_type other) const noexcept {
+        return *this == string_view(other);
+    }
+
+    inline NODISCARD bool operator!=(const_pointer_type other) const noexcept {
+        return !(*this == other);
+    }
+
+    // two handles to the same allocation compare equal without looking at the characters.
+    inline NODISCARD bool operator==(const basic_shared_string& other) const noexcept {
+        return header_ == other.header_ || *this == string_view(other);
+    }
+
+    inline NODISCARD bool operator!=(const basic_shared_string& other) const noexcept {
+        return !(*this == other);
+    }
+
+    // copy on write, the mutable copy is the caller's own and the shared one stays as it is.
+    template<typename Allocator = allocator<value_type>>
+    NODISCARD basic_string<value_type, Allocator> to_string(const Allocator& alloc = Allocator()) const {
+        return { data(), length(), alloc };
+    }
+private:
+    struct header {
+        std::atomic<size_type> count_;
+        size_type length_;
+    };
+
+    static inline NODISCARD const_pointer_type characters(const header* h) noexcept {
+        return reinterpret_cast<const_pointer_type>(h + 1);
+    }
+private:
+    header* header_ = nullptr;
+
+    constexpr static value_type empty_[1] = {};
+};
+
+using shared_string    = basic_shared_string<char>;
+using wshared_string   = basic_shared_string<wchar_t>;
+using u8shared_string  = basic_shared_string<char8_t>;
+using u16shared_string = basic_shared_string<char16_t>;
+using u32shared_string = basic_shared_string<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_SHARED_STRING_HPP
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef XED_SIMD_HPP
+#define XED_SIMD_HPP 1
+
+#include <cstdint>
+#include "has_attributes.hpp"
+
+#if XED_HAS_AVX2
+#include <immintrin.h>
+#elif XED_HAS_SSSE3
+#include <tmmintrin.h>
+#elif XED_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace xed {
+namespace details {
+
+using byte_type = unsigned char;
+
+// one vector register worth of bytes. every kernel is written against this so
+// the same loop runs 32 bytes at a time with avx2 and 16 with plain sse2. the 16 entry
+// table lookups need a byte shuffle, ssse3 or better, XED_HAS_SIMD_SHUFFLE says so.
+#if XED_HAS_AVX2
+#define XED_HAS_SIMD_BLOCK 1
+#define XED_HAS_SIMD_SHUFFLE 1
+struct simd_block {
+    using register_type = __m256i;
+    constexpr static std::size_t size = 32;
+
+    static inline NODISCARD register_type splat(byte_type value) noexcept {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    }
+    static inline NODISCARD register_type load(const byte_type* ptr) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    }
+    static inline NODISCARD std::uint32_t eq_mask(register_type a, register_type b) noexcept {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    }
+    static inline NODISCARD register_type eq(register_type a, register_type b) noexcept {
+        return _mm256_cmpeq_epi8(a, b);
+    }
+    static inline NODISCARD std::uint32_t mask(register_type value) noexcept {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(value));
+    }
+    static inline NODISCARD register_type bit_or(register_type a, register_type b) noexcept {
+        return _mm256_or_si256(a, b);
+    }
+    static inline void store(byte_type* ptr, register_type value) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value);
+    }
+    static inline NODISCARD register_type add(register_type a, register_type b) noexcept {
+        return _mm256_add_epi8(a, b);
+    }
+    // signed byte compare, 0xff where a < b.
+    static inline NODISCARD register_type less(register_type a, register_type b) noexcept {
+        return _mm256_cmpgt_epi8(b, a);
+    }
+    static inline NODISCARD register_type bit_and(register_type a, register_type b) noexcept {
+        return _mm256_and_si256(a, b);
+    }
+    static inline NODISCARD register_type bit_xor(register_type a, register_type b) noexcept {
+        return _mm256_xor_si256(a, b);
+    }
+    // a 16 byte table in every lane, for lookup.
+    static inline NODISCARD register_type load_table(const byte_type* table) noexcept {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+    }
+    // table[index] for every byte, the index bytes have to be 0 to 15.
+    static inline NODISCARD register_type lookup(register_type table, register_type index) noexcept {
+        return _mm256_shuffle_epi8(table, index);
+    }
+    static inline NODISCARD register_type high_nibbles(register_type value) noexcept {
+        return _mm256_and_si256(_mm256_srli_epi16(value, 4), _mm256_set1_epi8(0x0f));
+    }
+};
+#elif XED_HAS_SSE2
+#define XED_HAS_SIMD_BLOCK 1
+#if XED_HAS_SSSE3
+#define XED_HAS_SIMD_SHUFFLE 1
+#endif
+struct simd_block {
+    using register_type = __m128i;
+    constexpr static std::size_t size = 16;
+
+    static inline NODISCARD register_type splat(byte_type value) noexcept {
+        return _mm_set1_epi8(static_cast<char>(value));
+    }
+    static inline NODISCARD register_type load(const byte_type* ptr) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    }
+    static inline NODISCARD std::uint32_t eq_mask(register_type a, register_type b) noexcept {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    }
+    static inline NODISCARD register_type eq(register_type a, register_type b) noexcept {
+        return _mm_cmpeq_epi8(a, b);
+    }
+    static inline NODISCARD std::uint32_t mask(register_type value) noexcept {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(value));
+    }
+    static inline NODISCARD register_type bit_or(register_type a, register_type b) noexcept {
+        return _mm_or_si128(a, b);
+    }
+    static inline void store(byte_type* ptr, register_type value) noexcept {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+    }
+    static inline NODISCARD register_type add(register_type a, register_type b) noexcept {
+        return _mm_add_epi8(a, b);
+    }
+    // signed byte compare, 0xff where a < b.
+    static inline NODISCARD register_type less(register_type a, register_type b) noexcept {
+        return _mm_cmplt_epi8(a, b);
+    }
+    static inline NODISCARD register_type bit_and(register_type a, register_type b) noexcept {
+        return _mm_and_si128(a, b);
+    }
+    static inline NODISCARD register_type bit_xor(register_type a, register_type b) noexcept {
+        return _mm_xor_si128(a, b);
+    }
+#if XED_HAS_SSSE3
+    static inline NODISCARD register_type load_table(const byte_type* table) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+    }
+    static inline NODISCARD register_type lookup(register_type table, register_type index) noexcept {
+        return _mm_shuffle_epi8(table, index);
+    }
+    static inline NODISCARD register_type high_nibbles(register_type value) noexcept {
+        return _mm_and_si128(_mm_srli_epi16(value, 4), _mm_set1_epi8(0x0f));
+    }
+#endif
+};
+#endif
+
+} // namespace details
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_SIMD_HPP
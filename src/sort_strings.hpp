@@ -0,0 +1,398 @@
+#pragma once
+#ifndef XED_SORT_STRINGS_HPP
+#define XED_SORT_STRINGS_HPP 1
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include "xutility.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "parallel.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+namespace details {
+
+template<typename T>
+struct sort_char_type;
+
+template<typename CharType, typename Allocator>
+struct sort_char_type<basic_string<CharType, Allocator>> {
+    using type = CharType;
+};
+
+// a key while it is being sorted: the next 8 bytes worth of characters from where its
+// group agrees so far, and where the key is. the sort moves these around, not the keys.
+struct sort_record {
+    std::uint64_t cache_;
+    std::uint32_t index_;
+    // clamped, a key longer than that never counts as finished, which is right for any
+    // key a basic_string can hold.
+    std::uint32_t length_;
+};
+
+inline NODISCARD std::uint64_t to_big_endian(std::uint64_t value) noexcept {
+    if constexpr (std::endian::native == std::endian::big) {
+        return value;
+    }
+    else {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_bswap64(value);
+#else
+        std::uint64_t swapped = 0;
+        for (int i = 0; i < 8; i++, value >>= 8)
+            swapped = (swapped << 8) | (value & 0xff);
+        return swapped;
+#endif
+    }
+}
+
+// the characters of `str` from `depth` on, as many as fit in 64 bits, the first in the
+// top bits and zero past the end, so comparing two caches compares those characters.
+template<typename CharType>
+inline NODISCARD std::uint64_t sort_cache(basic_string_view<CharType> str, std::size_t depth) noexcept {
+    using unsigned_type = std::make_unsigned_t<CharType>;
+    constexpr std::size_t per_cache = 8 / sizeof(CharType);
+    constexpr std::size_t bits = 8 * sizeof(CharType);
+
+    if (depth >= str.length())
+        return 0;
+
+    const auto data = str.data() + depth;
+    const auto left = str.length() - depth;
+    if constexpr (sizeof(CharType) == 1) {
+        if (left >= 8) {
+            std::uint64_t word;
+            std::memcpy(&word, data, 8);
+            return to_big_endian(word);
+        }
+    }
+
+    std::uint64_t cache = 0;
+    const auto count = left < per_cache ? left : per_cache;
+    for (std::size_t i = 0; i < count; i++)
+        cache |= static_cast<std::uint64_t>(static_cast<unsigned_type>(data[i])) << (64 - bits * (i + 1));
+    return cache;
+}
+
+// tasks go onto the queue of the worker that made them and are taken from the back,
+// so a worker keeps going depth first on what is still in its cache; idle workers steal
+// from the front of someone else's queue, where the big ranges are.
+class sort_pool {
+public:
+    struct task {
+        sort_record* records_;
+        std::size_t count_;
+        std::size_t depth_;
+        unsigned budget_;
+    };
+
+    explicit sort_pool(unsigned workers)
+        : queues_(new queue[workers])
+        , workers_(workers) {
+    }
+
+    sort_pool(const sort_pool&) = delete;
+    sort_pool& operator=(const sort_pool&) = delete;
+
+    ~sort_pool() noexcept {
+        for (unsigned i = 0; i < workers_; i++)
+            delete[] queues_[i].tasks_;
+        delete[] queues_;
+    }
+
+    inline NODISCARD unsigned workers() const noexcept { return workers_; }
+
+    void push(unsigned worker, const task& t) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        auto& q = queues_[worker];
+        std::lock_guard<std::mutex> guard(q.lock_);
+        if (q.tail_ == q.capacity_) {
+            const auto count = q.tail_ - q.head_;
+            const auto capacity = count * 2 > 16 ? count * 2 : 16;
+            auto tasks = new task[capacity];
+            if (count != 0)
+                std::memcpy(tasks, q.tasks_ + q.head_, sizeof(task) * count);
+            delete[] exchange(q.tasks_, tasks);
+            q.capacity_ = capacity;
+            q.head_ = 0;
+            q.tail_ = count;
+        }
+        q.tasks_[q.tail_++] = t;
+    }
+
+    // runs tasks on `worker` until there are none left anywhere.
+    template<typename Fn>
+    void run(unsigned worker, Fn&& fn) {
+        task t;
+        for (;;) {
+            if (pop(worker, t) || steal(worker, t)) {
+                fn(worker, t);
+                pending_.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            else if (pending_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+private:
+    struct alignas(64) queue {
+        std::mutex lock_;
+        task* tasks_ = nullptr;
+        std::size_t head_ = 0;
+        std::size_t tail_ = 0;
+        std::size_t capacity_ = 0;
+    };
+
+    bool pop(unsigned worker, task& t) {
+        auto& q = queues_[worker];
+        std::lock_guard<std::mutex> guard(q.lock_);
+        if (q.head_ == q.tail_)
+            return false;
+        t = q.tasks_[--q.tail_];
+        if (q.head_ == q.tail_)
+            q.head_ = q.tail_ = 0;
+        return true;
+    }
+
+    bool steal(unsigned worker, task& t) {
+        for (unsigned i = 1; i < workers_; i++) {
+            auto& q = queues_[(worker + i) % workers_];
+            std::lock_guard<std::mutex> guard(q.lock_);
+            if (q.head_ == q.tail_)
+                continue;
+            t = q.tasks_[q.head_++];
+            if (q.head_ == q.tail_)
+                q.head_ = q.tail_ = 0;
+            return true;
+        }
+        return false;
+    }
+private:
+    queue* queues_;
+    unsigned workers_;
+    std::atomic<std::size_t> pending_{ 0 };
+};
+
+// multikey quicksort over the records: partition three ways on the cached characters,
+// the smaller and larger parts keep their depth, the equal part moves 8 bytes further
+// in and refills its caches. the keys themselves are only read to refill caches.
+template<typename Key, typename CharType>
+class string_sorter {
+public:
+    using size_type = std::size_t;
+    using string_view = basic_string_view<CharType>;
+
+    constexpr static size_type per_cache = 8 / sizeof(CharType);
+    constexpr static size_type insertion_limit = 16;
+    // ranges shorter than this aren't worth a task of their own.
+    constexpr static size_type task_limit = 1 << 14;
+
+    string_sorter(const Key* keys, sort_pool* pool) noexcept
+        : keys_(keys)
+        , pool_(pool) {
+    }
+
+    inline NODISCARD string_view key(const sort_record& r) const noexcept {
+        return string_view(keys_[r.index_]);
+    }
+
+    void sort(unsigned worker, sort_record* records, size_type count, size_type depth, unsigned budget) {
+        for (;;) {
+            if (count < insertion_limit) {
+                insertion_sort(records, count, depth);
+                return;
+            }
+            // a run of bad pivots, the rest gets a plain comparison sort.
+            if (budget == 0) {
+                std::sort(records, records + count, [this, depth](const sort_record& a, const sort_record& b) { return less(a, b, depth); });
+                return;
+            }
+            budget--;
+
+            const auto pivot = median(records[0].cache_, records[count / 2].cache_, records[count - 1].cache_);
+            size_type lt = 0, i = 0, gt = count;
+            while (i < gt) {
+                const auto cache = records[i].cache_;
+                if (cache < pivot)
+                    std::swap(records[lt++], records[i++]);
+                else if (cache > pivot)
+                    std::swap(records[i], records[--gt]);
+                else
+                    i++;
+            }
+
+            sort_part(worker, records, lt, depth, budget);
+            sort_part(worker, records + gt, count - gt, depth, budget);
+
+            // the keys that end inside the cache go first: the caches are equal, so each
+            // is the start of every longer one in the group.
+            auto equal = records + lt;
+            const auto equal_count = gt - lt;
+            const auto next = depth + per_cache;
+            size_type finished = 0;
+            for (size_type j = 0; j < equal_count; j++) {
+                if (equal[j].length_ <= next)
+                    std::swap(equal[finished++], equal[j]);
+            }
+            if (finished > 1)
+                std::sort(equal, equal + finished, [](const sort_record& a, const sort_record& b) { return a.length_ < b.length_; });
+
+            records = equal + finished;
+            count = equal_count - finished;
+            depth = next;
+            for (size_type j = 0; j < count; j++)
+                records[j].cache_ = sort_cache(key(records[j]), depth);
+        }
+    }
+private:
+    static inline NODISCARD std::uint64_t median(std::uint64_t a, std::uint64_t b, std::uint64_t c) noexcept {
+        if (a < b)
+            return b < c ? b : a < c ? c : a;
+        return a < c ? a : b < c ? c : b;
+    }
+
+    void sort_part(unsigned worker, sort_record* records, size_type count, size_type depth, unsigned budget) {
+        if (count < 2)
+            return;
+        if (pool_ != nullptr && count >= task_limit)
+            pool_->push(worker, { records, count, depth, budget });
+        else
+            sort(worker, records, count, depth, budget);
+    }
+
+    // equal caches and one key ending inside them make the shorter one the smaller,
+    // otherwise the keys decide from where the caches stop.
+    inline NODISCARD bool less(const sort_record& a, const sort_record& b, size_type depth) const noexcept {
+        if (a.cache_ != b.cache_)
+            return a.cache_ < b.cache_;
+
+        const auto next = depth + per_cache;
+        if (a.length_ <= next || b.length_ <= next)
+            return a.length_ < b.length_;
+
+        const auto x = key(a);
+        const auto y = key(b);
+        return details::compare_chars(x.data() + next, x.length() - next, y.data() + next, y.length() - next) < 0;
+    }
+
+    void insertion_sort(sort_record* records, size_type count, size_type depth) const noexcept {
+        for (size_type i = 1; i < count; i++) {
+            const auto r = records[i];
+            auto j = i;
+            for (; j > 0 && less(r, records[j - 1], depth); j--)
+                records[j] = records[j - 1];
+            records[j] = r;
+        }
+    }
+private:
+    const Key* keys_;
+    sort_pool* pool_;
+};
+
+// runs fn(begin, end) over `count` items in blocks, on up to `threads` threads.
+template<typename Fn>
+void sort_parallel_for(unsigned threads, std::size_t count, Fn&& fn) {
+    constexpr std::size_t block = 1 << 16;
+    parallel_for(threads, (count + block - 1) / block, [&](std::size_t task) {
+        const auto begin = task * block;
+        fn(begin, count - begin < block ? count : begin + block);
+    });
+}
+
+} // namespace details
+
+// sorts basic_strings in the order compare gives them, characters as unsigned values and
+// a prefix first. the leading characters of every key get cached in an array of 16 byte
+// records, the records are sorted with a multikey quicksort and only then are the keys
+// moved, through a buffer, into their place. big ranges become tasks for a pool of
+// `threads` workers that steal from each other, 0 means one per core.
+template<typename Key>
+void sort_strings(Key* first, Key* last, unsigned threads = 0) {
+    using char_type = typename details::sort_char_type<std::remove_cv_t<Key>>::type;
+    using string_view = basic_string_view<char_type>;
+    using sorter_type = details::string_sorter<Key, char_type>;
+
+    const auto count = static_cast<std::size_t>(last - first);
+    if (count < 2)
+        return;
+
+    // more keys than the records can count, the plain way.
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+        std::sort(first, last, [](const Key& a, const Key& b) { return string_view(a) < string_view(b); });
+        return;
+    }
+
+    threads = details::thread_count(threads);
+    if (count < 2 * sorter_type::task_limit)
+        threads = 1;
+
+    auto records = new details::sort_record[count];
+    details::sort_parallel_for(threads, count, [&](std::size_t begin, std::size_t end) {
+        constexpr std::size_t max_length = std::numeric_limits<std::uint32_t>::max();
+        for (auto i = begin; i < end; i++) {
+            const string_view str(first[i]);
+            records[i].cache_ = details::sort_cache(str, 0);
+            records[i].index_ = static_cast<std::uint32_t>(i);
+            records[i].length_ = static_cast<std::uint32_t>(str.length() < max_length ? str.length() : max_length);
+        }
+    });
+
+    // past about 2 log2 n levels of bad pivots a range gets std::sort instead.
+    const auto budget = 2 * static_cast<unsigned>(std::bit_width(count)) + 16;
+    if (threads == 1) {
+        sorter_type sorter(first, nullptr);
+        sorter.sort(0, records, count, 0, budget);
+    }
+    else {
+        details::sort_pool pool(threads);
+        sorter_type sorter(first, &pool);
+        pool.push(0, { records, count, 0, budget });
+
+        const auto work = [&](unsigned worker, const details::sort_pool::task& t) {
+            sorter.sort(worker, t.records_, t.count_, t.depth_, t.budget_);
+        };
+        auto workers = new std::thread[threads - 1];
+        for (unsigned t = 1; t < threads; t++)
+            workers[t - 1] = std::thread([&pool, &work, t] { pool.run(t, work); });
+        pool.run(0, work);
+        for (unsigned t = 1; t < threads; t++)
+            workers[t - 1].join();
+        delete[] workers;
+    }
+
+    // gathers the keys in order into a buffer and moves them back. the reads are random
+    // but independent of each other, following the cycles of the permutation instead
+    // waits on every load in turn.
+    auto sorted = static_cast<Key*>(::operator new(sizeof(Key) * count));
+    details::sort_parallel_for(threads, count, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++)
+            ::new (static_cast<void*>(sorted + i)) Key(move(first[records[i].index_]));
+    });
+    details::sort_parallel_for(threads, count, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            first[i] = move(sorted[i]);
+            sorted[i].~Key();
+        }
+    });
+    ::operator delete(sorted);
+    delete[] records;
+}
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_SORT_STRINGS_HPP
@@ -0,0 +1,341 @@
+#pragma once
+#ifndef XED_SPLIT_HPP
+#define XED_SPLIT_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include "xutility.hpp"
+#include "type_traits.hpp"
+#include "string_view.hpp"
+#include "string_search.hpp"
+#include "basic_string.hpp"
+#include "simd.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+
+struct split_options {
+    bool skip_empty = false;
+    // at most this many splits, the rest of the input is the last field.
+    std::size_t max_split = npos;
+};
+
+// a set of delimiter characters, any one of them ends a field.
+template<typename CharType>
+struct any_of {
+    basic_string_view<CharType> set_;
+
+    constexpr any_of(basic_string_view<CharType> set) noexcept : set_(set) {}
+
+    template<std::size_t N>
+    constexpr any_of(const CharType (&set)[N]) noexcept : set_(set, N - 1) {}
+};
+
+template<typename CharType, std::size_t N>
+any_of(const CharType (&)[N]) -> any_of<CharType>;
+
+namespace details {
+
+constexpr std::size_t split_block = 64;
+
+// the delimiters of a whole 64 character block as one bitmask, so the iterator does
+// one vector pass per block however many fields it holds and then just pops bits.
+template<typename CharType, typename Match>
+inline NODISCARD std::uint64_t split_scalar_mask(const CharType* data, std::size_t count, const Match& match) noexcept {
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i < count; i++)
+        mask |= std::uint64_t(match(data[i])) << i;
+    return mask;
+}
+
+template<typename CharType>
+struct char_delimiter {
+    constexpr static bool uses_mask = true;
+
+    CharType ch_;
+
+    inline NODISCARD std::size_t length() const noexcept { return 1; }
+
+    inline NODISCARD bool matches_at(const CharType* data, std::size_t length, std::size_t pos) const noexcept {
+        return pos < length && data[pos] == ch_;
+    }
+
+    inline NODISCARD std::uint64_t block_mask(const CharType* data, std::size_t count) const noexcept {
+#if XED_HAS_SIMD_BLOCK
+        if constexpr (sizeof(CharType) == 1) {
+            if (count == split_block) {
+                const auto needle = simd_block::splat(static_cast<byte_type>(ch_));
+                std::uint64_t mask = 0;
+                for (std::size_t i = 0; i < split_block; i += simd_block::size)
+                    mask |= std::uint64_t(simd_block::eq_mask(simd_block::load(as_bytes(data) + i), needle)) << i;
+                return mask;
+            }
+        }
+#endif
+        return split_scalar_mask(data, count, [this](CharType c) { return c == ch_; });
+    }
+};
+
+template<typename CharType>
+struct set_delimiter {
+    constexpr static bool uses_mask = true;
+    // up to this many delimiters are compared with vectors, more go through the table.
+    constexpr static std::size_t max_simd_set = 8;
+
+    const CharType* set_;
+    std::size_t set_length_;
+    bool table_[256] = {};
+
+    set_delimiter(basic_string_view<CharType> set) noexcept
+        : set_(set.data())
+        , set_length_(set.length()) {
+        if constexpr (sizeof(CharType) == 1) {
+            for (std::size_t i = 0; i < set_length_; i++)
+                table_[static_cast<byte_type>(set_[i])] = true;
+        }
+    }
+
+    inline NODISCARD std::size_t length() const noexcept { return 1; }
+
+    inline NODISCARD bool contains(CharType c) const noexcept {
+        if constexpr (sizeof(CharType) == 1) {
+            return table_[static_cast<byte_type>(c)];
+        }
+        else {
+            for (std::size_t i = 0; i < set_length_; i++) {
+                if (set_[i] == c)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    inline NODISCARD bool matches_at(const CharType* data, std::size_t length, std::size_t pos) const noexcept {
+        return pos < length && contains(data[pos]);
+    }
+
+    inline NODISCARD std::uint64_t block_mask(const CharType* data, std::size_t count) const noexcept {
+#if XED_HAS_SIMD_BLOCK
+        if constexpr (sizeof(CharType) == 1) {
+            if (count == split_block && set_length_ <= max_simd_set) {
+                simd_block::register_type needles[max_simd_set];
+                for (std::size_t j = 0; j < set_length_; j++)
+                    needles[j] = simd_block::splat(static_cast<byte_type>(set_[j]));
+
+                std::uint64_t mask = 0;
+                for (std::size_t i = 0; i < split_block; i += simd_block::size) {
+                    const auto block = simd_block::load(as_bytes(data) + i);
+                    std::uint32_t hits = 0;
+                    for (std::size_t j = 0; j < set_length_; j++)
+                        hits |= simd_block::eq_mask(block, needles[j]);
+                    mask |= std::uint64_t(hits) << i;
+                }
+                return mask;
+            }
+        }
+#endif
+        return split_scalar_mask(data, count, [this](CharType c) { return contains(c); });
+    }
+};
+
+// a delimiter longer than one character, found with the substring search. matches
+// don't overlap, "a,,,b" split on ",," is "a" and ",b".
+template<typename CharType>
+struct string_delimiter {
+    constexpr static bool uses_mask = false;
+
+    const CharType* delimiter_;
+    std::size_t length_;
+
+    inline NODISCARD std::size_t length() const noexcept { return length_; }
+
+    inline NODISCARD bool matches_at(const CharType* data, std::size_t length, std::size_t pos) const noexcept {
+        return length_ != 0 && length_ <= length && pos <= length - length_
+            && std::memcmp(data + pos, delimiter_, sizeof(CharType) * length_) == 0;
+    }
+
+    // an empty delimiter never matches, the whole input is one field.
+    inline NODISCARD std::size_t find(const CharType* data, std::size_t length, std::size_t from) const noexcept {
+        if (length_ == 0)
+            return npos;
+
+        const auto pos = find_substring(data + from, length - from, delimiter_, length_);
+        return pos == npos ? npos : pos + from;
+    }
+};
+
+} // namespace details
+
+// the fields of a string_view between delimiters, worked out one at a time while
+// iterating. every field is a view into the input, nothing gets allocated or copied,
+// so the input has to outlive the range.
+template<typename CharType, typename Delimiter>
+class basic_split_range {
+public:
+    using this_type = basic_split_range;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using string_view = basic_string_view<value_type>;
+
+    class iterator {
+    public:
+        iterator() noexcept = default;
+
+        explicit iterator(const basic_split_range* owner) noexcept
+            : owner_(owner) {
+            advance();
+        }
+
+        inline NODISCARD string_view operator*() const noexcept {
+            return { owner_->data_ + start_, end_ - start_ };
+        }
+
+        iterator& operator++() noexcept {
+            advance();
+            return *this;
+        }
+
+        // every finished iterator is the end one.
+        inline NODISCARD bool operator==(const iterator& other) const noexcept {
+            return done_ == other.done_ && (done_ || start_ == other.start_);
+        }
+        inline NODISCARD bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+
+        // where the current field starts in the input.
+        inline NODISCARD size_type position() const noexcept { return start_; }
+    private:
+        friend class basic_split_range;
+
+        void advance() noexcept {
+            const auto& delimiter = owner_->delimiter_;
+            const auto data = owner_->data_;
+            const auto length = owner_->length_;
+            const auto& options = owner_->options_;
+
+            for (;;) {
+                if (last_) {
+                    done_ = true;
+                    return;
+                }
+                start_ = next_;
+
+                if (splits_ == options.max_split) {
+                    if (options.skip_empty) {
+                        while (delimiter.matches_at(data, length, start_))
+                            start_ += delimiter.length();
+                    }
+                    end_ = length;
+                    last_ = true;
+                }
+                else {
+                    const auto pos = next_delimiter(start_);
+                    if (pos == npos) {
+                        end_ = length;
+                        last_ = true;
+                    }
+                    else {
+                        end_ = pos;
+                        next_ = pos + delimiter.length();
+                    }
+                }
+
+                if (end_ != start_ || !options.skip_empty) {
+                    splits_ += !last_;
+                    return;
+                }
+            }
+        }
+
+        NODISCARD size_type next_delimiter(size_type from) noexcept {
+            const auto& delimiter = owner_->delimiter_;
+            const auto data = owner_->data_;
+            const auto length = owner_->length_;
+
+            if constexpr (!Delimiter::uses_mask) {
+                return from <= length ? delimiter.find(data, length, from) : npos;
+            }
+            else {
+                while (from < length) {
+                    if (from >= block_ + details::split_block || !loaded_) {
+                        block_ = from & ~(details::split_block - 1);
+                        const auto count = length - block_ < details::split_block ? length - block_ : details::split_block;
+                        mask_ = delimiter.block_mask(data + block_, count);
+                        loaded_ = true;
+                    }
+
+                    const auto mask = mask_ & (~std::uint64_t(0) << (from - block_));
+                    if (mask != 0)
+                        return block_ + std::countr_zero(mask);
+                    from = block_ + details::split_block;
+                }
+                return npos;
+            }
+        }
+    private:
+        const basic_split_range* owner_ = nullptr;
+        size_type start_ = 0;
+        size_type end_ = 0;
+        size_type next_ = 0;
+        size_type splits_ = 0;
+        size_type block_ = 0;
+        std::uint64_t mask_ = 0;
+        bool loaded_ = false;
+        bool last_ = false;
+        bool done_ = false;
+    };
+public:
+    basic_split_range(string_view str, const Delimiter& delimiter, split_options options) noexcept
+        : data_(str.data())
+        , length_(str.length())
+        , delimiter_(delimiter)
+        , options_(options) {
+    }
+
+    inline NODISCARD iterator begin() const noexcept { return iterator(this); }
+    inline NODISCARD iterator end() const noexcept { return end_iterator(); }
+private:
+    static inline NODISCARD iterator end_iterator() noexcept {
+        iterator it;
+        it.done_ = true;
+        return it;
+    }
+private:
+    const value_type* data_;
+    size_type length_;
+    Delimiter delimiter_;
+    split_options options_;
+};
+
+template<typename CharType>
+inline NODISCARD basic_split_range<CharType, details::char_delimiter<CharType>>
+split(basic_string_view<CharType> str, type_identity_t<CharType> delimiter, split_options options = {}) noexcept {
+    return { str, { delimiter }, options };
+}
+
+template<typename CharType>
+inline NODISCARD basic_split_range<CharType, details::string_delimiter<CharType>>
+split(basic_string_view<CharType> str, type_identity_t<basic_string_view<CharType>> delimiter, split_options options = {}) noexcept {
+    return { str, { delimiter.data(), delimiter.length() }, options };
+}
+
+template<typename CharType>
+inline NODISCARD basic_split_range<CharType, details::set_delimiter<CharType>>
+split(basic_string_view<CharType> str, any_of<CharType> delimiters, split_options options = {}) noexcept {
+    return { str, { delimiters.set_ }, options };
+}
+
+template<typename CharType, typename Allocator, typename Delimiter>
+inline NODISCARD auto split(const basic_string<CharType, Allocator>& str, const Delimiter& delimiter, split_options options = {}) noexcept {
+    return split(basic_string_view<CharType>(str), delimiter, options);
+}
+
+// the fields would point into a string that is gone by the time they are read.
+template<typename CharType, typename Allocator, typename Delimiter>
+void split(const basic_string<CharType, Allocator>&& str, const Delimiter& delimiter, split_options options = {}) = delete;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_SPLIT_HPP
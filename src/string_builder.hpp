@@ -0,0 +1,267 @@
+#pragma once
+#ifndef XED_STRING_BUILDER_HPP
+#define XED_STRING_BUILDER_HPP 1
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "has_attributes.hpp"
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
+namespace xed {
+
+#if defined(_WIN32)
+// the same fields as the posix iovec, for code that hands them to its own scatter/gather.
+struct io_segment {
+    void* iov_base;
+    std::size_t iov_len;
+};
+#else
+using io_segment = ::iovec;
+#endif
+
+// builds a large string out of many pieces without ever moving what is already there.
+// copied pieces go into a chain of chunks, big pieces can be referenced where they are
+// instead, and the result comes out as a list of segments for writev,
+//
+//     xed::string_builder response;
+//     xed::format_to(response, "HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n", body.length());
+//     response.append_ref(body);
+//     ::writev(fd, response.segments(), static_cast<int>(response.segment_count()));
+//
+// or as one string with to_string(). segments are in bytes, the way writev counts, and
+// writev takes at most IOV_MAX of them per call.
+template<typename CharType>
+class basic_string_builder {
+public:
+    using this_type = basic_string_builder;
+    using size_type = std::size_t;
+    using value_type = CharType;
+    using pointer_type = value_type*;
+    using const_pointer_type = const value_type*;
+    using string_view = basic_string_view<value_type>;
+
+    constexpr static size_type default_chunk_size = 4096 / sizeof(value_type);
+    // append_ref copies anything shorter, a segment costs writev more than that copy.
+    constexpr static size_type min_ref_length = 256 / sizeof(value_type);
+private:
+    struct chunk {
+        chunk* next_;
+        size_type capacity_;
+    };
+
+    static inline NODISCARD pointer_type characters(chunk* c) noexcept {
+        return reinterpret_cast<pointer_type>(c + 1);
+    }
+public:
+    explicit basic_string_builder(size_type chunk_size = default_chunk_size) noexcept
+        : chunk_size_(chunk_size) {
+    }
+
+    basic_string_builder(const basic_string_builder&) = delete;
+    basic_string_builder& operator=(const basic_string_builder&) = delete;
+
+    basic_string_builder(basic_string_builder&& other) noexcept
+        : chunks_(exchange(other.chunks_, nullptr))
+        , current_(exchange(other.current_, nullptr))
+        , write_(exchange(other.write_, nullptr))
+        , end_(exchange(other.end_, nullptr))
+        , segments_(exchange(other.segments_, nullptr))
+        , segment_count_(exchange(other.segment_count_, 0))
+        , segment_capacity_(exchange(other.segment_capacity_, 0))
+        , length_(exchange(other.length_, 0))
+        , chunk_size_(other.chunk_size_) {
+    }
+
+    basic_string_builder& operator=(basic_string_builder&& other) noexcept {
+        basic_string_builder temp(move(other));
+        this->swap(temp);
+        return *this;
+    }
+
+    ~basic_string_builder() noexcept {
+        while (chunks_ != nullptr)
+            ::operator delete(exchange(chunks_, chunks_->next_));
+        delete[] segments_;
+    }
+
+    void swap(basic_string_builder& other) noexcept {
+        chunks_ = exchange(other.chunks_, chunks_);
+        current_ = exchange(other.current_, current_);
+        write_ = exchange(other.write_, write_);
+        end_ = exchange(other.end_, end_);
+        segments_ = exchange(other.segments_, segments_);
+        segment_count_ = exchange(other.segment_count_, segment_count_);
+        segment_capacity_ = exchange(other.segment_capacity_, segment_capacity_);
+        length_ = exchange(other.length_, length_);
+        chunk_size_ = exchange(other.chunk_size_, chunk_size_);
+    }
+
+    inline NODISCARD size_type length() const noexcept { return length_; }
+    inline NODISCARD bool is_empty() const noexcept { return length_ == 0; }
+
+    inline NODISCARD const io_segment* segments() const noexcept { return segments_; }
+    inline NODISCARD size_type segment_count() const noexcept { return segment_count_; }
+
+    // copies `str` into the chunks.
+    basic_string_builder& append(string_view str) {
+        auto data = str.data();
+        auto left = str.length();
+        while (left != 0) {
+            if (write_ == end_)
+                next_chunk(left);
+
+            const auto room = static_cast<size_type>(end_ - write_);
+            const auto amount = left < room ? left : room;
+            std::memcpy(write_, data, sizeof(value_type) * amount);
+            add_segment(write_, amount);
+            write_ += amount;
+            data += amount;
+            left -= amount;
+        }
+        length_ += str.length();
+        return *this;
+    }
+
+    inline basic_string_builder& append(value_type ch) {
+        if (write_ == end_)
+            next_chunk(1);
+        *write_ = ch;
+        add_segment(write_++, 1);
+        length_++;
+        return *this;
+    }
+
+    inline basic_string_builder& operator+=(string_view str) { return append(str); }
+    inline basic_string_builder& operator+=(value_type ch) { return append(ch); }
+
+    // `str` becomes a segment of its own and isn't copied, it has to stay alive and
+    // unchanged as long as the builder is used. short ones are copied all the same.
+    basic_string_builder& append_ref(string_view str) {
+        if (str.length() < min_ref_length)
+            return append(str);
+
+        add_segment(str.data(), str.length());
+        length_ += str.length();
+        return *this;
+    }
+
+    // writer(pointer_type) gets room for `max_amount` characters in a chunk and returns
+    // how many it wrote.
+    template<typename Writer>
+    inline basic_string_builder& append_for_overwrite(size_type max_amount, Writer&& writer) {
+        if (static_cast<size_type>(end_ - write_) < max_amount)
+            next_chunk(max_amount);
+
+        const size_type written = writer(write_);
+        if (written != 0) {
+            add_segment(write_, written);
+            write_ += written;
+            length_ += written;
+        }
+        return *this;
+    }
+
+    // calls fn(string_view) for every segment, in order.
+    template<typename Fn>
+    void for_each_segment(Fn&& fn) const {
+        for (size_type i = 0; i < segment_count_; i++) {
+            const auto& segment = segments_[i];
+            fn(string_view(static_cast<const_pointer_type>(segment.iov_base), segment.iov_len / sizeof(value_type)));
+        }
+    }
+
+    // one allocation for the whole content.
+    template<typename Allocator = allocator<value_type>>
+    NODISCARD basic_string<value_type, Allocator> to_string(const Allocator& alloc = Allocator()) const {
+        basic_string<value_type, Allocator> ret(alloc);
+        ret.resize_for_overwrite(length_);
+        auto out = ret.data();
+        for (size_type i = 0; i < segment_count_; i++) {
+            std::memcpy(out, segments_[i].iov_base, segments_[i].iov_len);
+            out += segments_[i].iov_len / sizeof(value_type);
+        }
+        return ret;
+    }
+
+    // empties the builder but keeps its chunks for what gets built next.
+    void clear() noexcept {
+        current_ = nullptr;
+        write_ = nullptr;
+        end_ = nullptr;
+        segment_count_ = 0;
+        length_ = 0;
+    }
+private:
+    // moves on to a chunk with room for at least `min_size` characters, the next one
+    // in the chain if an earlier build left one that big.
+    void next_chunk(size_type min_size) {
+        chunk* next = current_ != nullptr ? current_->next_ : chunks_;
+        if (next == nullptr || next->capacity_ < min_size) {
+            const auto capacity = min_size > chunk_size_ ? min_size : chunk_size_;
+            auto c = static_cast<chunk*>(::operator new(sizeof(chunk) + sizeof(value_type) * capacity));
+            c->capacity_ = capacity;
+            c->next_ = next;
+            if (current_ != nullptr)
+                current_->next_ = c;
+            else
+                chunks_ = c;
+            next = c;
+        }
+
+        current_ = next;
+        write_ = characters(next);
+        end_ = write_ + next->capacity_;
+    }
+
+    // grows the last segment when `data` carries on right where it ends.
+    void add_segment(const_pointer_type data, size_type length) {
+        const auto bytes = sizeof(value_type) * length;
+        if (segment_count_ != 0) {
+            auto& last = segments_[segment_count_ - 1];
+            if (static_cast<const unsigned char*>(last.iov_base) + last.iov_len == reinterpret_cast<const unsigned char*>(data)) {
+                last.iov_len += bytes;
+                return;
+            }
+        }
+
+        if (segment_count_ == segment_capacity_) {
+            const auto capacity = segment_capacity_ != 0 ? segment_capacity_ * 2 : 16;
+            auto segments = new io_segment[capacity];
+            if (segment_count_ != 0)
+                std::memcpy(segments, segments_, sizeof(io_segment) * segment_count_);
+            delete[] exchange(segments_, segments);
+            segment_capacity_ = capacity;
+        }
+        segments_[segment_count_++] = { const_cast<pointer_type>(data), bytes };
+    }
+private:
+    // every chunk ever allocated, in the order they are filled in.
+    chunk* chunks_ = nullptr;
+    chunk* current_ = nullptr;
+    pointer_type write_ = nullptr;
+    pointer_type end_ = nullptr;
+    io_segment* segments_ = nullptr;
+    size_type segment_count_ = 0;
+    size_type segment_capacity_ = 0;
+    size_type length_ = 0;
+    size_type chunk_size_;
+};
+
+using string_builder    = basic_string_builder<char>;
+using wstring_builder   = basic_string_builder<wchar_t>;
+using u8string_builder  = basic_string_builder<char8_t>;
+using u16string_builder = basic_string_builder<char16_t>;
+using u32string_builder = basic_string_builder<char32_t>;
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_STRING_BUILDER_HPP
@@ -0,0 +1,369 @@
+#pragma once
+#ifndef XED_STRING_SEARCH_HPP
+#define XED_STRING_SEARCH_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "xutility.hpp"
+#include "simd.hpp"
+#include "has_attributes.hpp"
+
+namespace xed {
+namespace details {
+
+// byte kernels. these are what every 1 byte character type ends up in, wider
+// character types take the scalar loops in the generic wrappers further down.
+
+inline NODISCARD std::size_t find_byte(const byte_type* data, std::size_t length, byte_type ch) noexcept {
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    const auto needle = simd_block::splat(ch);
+    // four blocks per round and a single movemask for all of them while nothing matches.
+    constexpr auto unrolled = 4 * simd_block::size;
+    for (; i + unrolled <= length; i += unrolled) {
+        const auto a = simd_block::eq(simd_block::load(data + i), needle);
+        const auto b = simd_block::eq(simd_block::load(data + i + simd_block::size), needle);
+        const auto c = simd_block::eq(simd_block::load(data + i + 2 * simd_block::size), needle);
+        const auto d = simd_block::eq(simd_block::load(data + i + 3 * simd_block::size), needle);
+        if (simd_block::mask(simd_block::bit_or(simd_block::bit_or(a, b), simd_block::bit_or(c, d))) == 0)
+            continue;
+
+        const std::uint32_t masks[] = { simd_block::mask(a), simd_block::mask(b), simd_block::mask(c), simd_block::mask(d) };
+        for (std::size_t j = 0; j < 4; j++) {
+            if (masks[j] != 0)
+                return i + j * simd_block::size + std::countr_zero(masks[j]);
+        }
+    }
+    for (; i + simd_block::size <= length; i += simd_block::size) {
+        const auto mask = simd_block::eq_mask(simd_block::load(data + i), needle);
+        if (mask != 0)
+            return i + std::countr_zero(mask);
+    }
+#endif
+    for (; i < length; i++) {
+        if (data[i] == ch)
+            return i;
+    }
+    return npos;
+}
+
+inline NODISCARD std::size_t rfind_byte(const byte_type* data, std::size_t length, byte_type ch) noexcept {
+    std::size_t end = length;
+#if XED_HAS_SIMD_BLOCK
+    const auto needle = simd_block::splat(ch);
+    while (end >= simd_block::size) {
+        end -= simd_block::size;
+        const auto mask = simd_block::eq_mask(simd_block::load(data + end), needle);
+        if (mask != 0)
+            return end + (31 - std::countl_zero(mask));
+    }
+#endif
+    while (end != 0) {
+        if (data[--end] == ch)
+            return end;
+    }
+    return npos;
+}
+
+inline NODISCARD std::size_t count_byte(const byte_type* data, std::size_t length, byte_type ch) noexcept {
+    std::size_t i = 0;
+    std::size_t count = 0;
+#if XED_HAS_SIMD_BLOCK
+    const auto needle = simd_block::splat(ch);
+    for (; i + simd_block::size <= length; i += simd_block::size)
+        count += std::popcount(simd_block::eq_mask(simd_block::load(data + i), needle));
+#endif
+    for (; i < length; i++)
+        count += data[i] == ch;
+    return count;
+}
+
+// candidates are the offsets where both the first and the last byte of the needle
+// match, only those get a memcmp of the middle part.
+inline NODISCARD std::size_t find_bytes(const byte_type* data, std::size_t length, const byte_type* needle, std::size_t needle_length) noexcept {
+    if (needle_length == 0)
+        return 0;
+    if (needle_length > length)
+        return npos;
+    if (needle_length == 1)
+        return find_byte(data, length, needle[0]);
+
+    const auto last = needle_length - 1;
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    const auto first_byte = simd_block::splat(needle[0]);
+    const auto last_byte = simd_block::splat(needle[last]);
+    // two blocks per round, the common no candidate case costs one movemask.
+    for (; i + last + 2 * simd_block::size <= length; i += 2 * simd_block::size) {
+        const auto a = simd_block::bit_and(
+            simd_block::eq(simd_block::load(data + i), first_byte),
+            simd_block::eq(simd_block::load(data + i + last), last_byte));
+        const auto b = simd_block::bit_and(
+            simd_block::eq(simd_block::load(data + i + simd_block::size), first_byte),
+            simd_block::eq(simd_block::load(data + i + simd_block::size + last), last_byte));
+        if (simd_block::mask(simd_block::bit_or(a, b)) == 0)
+            continue;
+
+        const std::uint32_t masks[] = { simd_block::mask(a), simd_block::mask(b) };
+        for (std::size_t j = 0; j < 2; j++) {
+            auto mask = masks[j];
+            while (mask != 0) {
+                const auto offset = i + j * simd_block::size + std::countr_zero(mask);
+                if (std::memcmp(data + offset + 1, needle + 1, last - 1) == 0)
+                    return offset;
+                mask &= mask - 1;
+            }
+        }
+    }
+    for (; i + last + simd_block::size <= length; i += simd_block::size) {
+        auto mask =
+            simd_block::eq_mask(simd_block::load(data + i), first_byte)
+            & simd_block::eq_mask(simd_block::load(data + i + last), last_byte);
+
+        while (mask != 0) {
+            const auto offset = i + std::countr_zero(mask);
+            if (std::memcmp(data + offset + 1, needle + 1, last - 1) == 0)
+                return offset;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + last < length; i++) {
+        if (data[i] == needle[0] && data[i + last] == needle[last] && std::memcmp(data + i + 1, needle + 1, last - 1) == 0)
+            return i;
+    }
+    return npos;
+}
+
+inline NODISCARD std::size_t rfind_bytes(const byte_type* data, std::size_t length, const byte_type* needle, std::size_t needle_length) noexcept {
+    if (needle_length == 0)
+        return length;
+    if (needle_length > length)
+        return npos;
+    if (needle_length == 1)
+        return rfind_byte(data, length, needle[0]);
+
+    const auto last = needle_length - 1;
+    // one past the last offset a match can start at.
+    std::size_t end = length - last;
+#if XED_HAS_SIMD_BLOCK
+    const auto first_byte = simd_block::splat(needle[0]);
+    const auto last_byte = simd_block::splat(needle[last]);
+    while (end >= simd_block::size) {
+        end -= simd_block::size;
+        auto mask =
+            simd_block::eq_mask(simd_block::load(data + end), first_byte)
+            & simd_block::eq_mask(simd_block::load(data + end + last), last_byte);
+
+        while (mask != 0) {
+            const auto bit = 31 - std::countl_zero(mask);
+            if (std::memcmp(data + end + bit + 1, needle + 1, last - 1) == 0)
+                return end + bit;
+            mask &= ~(std::uint32_t(1) << bit);
+        }
+    }
+#endif
+    while (end != 0) {
+        --end;
+        if (data[end] == needle[0] && data[end + last] == needle[last] && std::memcmp(data + end + 1, needle + 1, last - 1) == 0)
+            return end;
+    }
+    return npos;
+}
+
+inline NODISCARD std::size_t find_first_of_bytes(const byte_type* data, std::size_t length, const byte_type* set, std::size_t set_length) noexcept {
+    std::size_t i = 0;
+#if XED_HAS_SIMD_BLOCK
+    // a handful of compares per block beats the table below, past that it doesn't.
+    constexpr std::size_t max_simd_set = 4;
+    if (set_length <= max_simd_set && set_length != 0) {
+        simd_block::register_type needles[max_simd_set];
+        for (std::size_t j = 0; j < set_length; j++)
+            needles[j] = simd_block::splat(set[j]);
+
+        for (; i + simd_block::size <= length; i += simd_block::size) {
+            const auto block = simd_block::load(data + i);
+            std::uint32_t mask = 0;
+            for (std::size_t j = 0; j < set_length; j++)
+                mask |= simd_block::eq_mask(block, needles[j]);
+            if (mask != 0)
+                return i + std::countr_zero(mask);
+        }
+    }
+#endif
+    bool table[256] = {};
+    for (std::size_t j = 0; j < set_length; j++)
+        table[set[j]] = true;
+
+    for (; i < length; i++) {
+        if (table[data[i]])
+            return i;
+    }
+    return npos;
+}
+
+template<typename CharType>
+inline NODISCARD const byte_type* as_bytes(const CharType* ptr) noexcept {
+    return reinterpret_cast<const byte_type*>(ptr);
+}
+
+// generic entry points, all of them return an offset relative to `data` or npos. they
+// also work in constant expressions, where the byte kernels and memcmp can't run and the
+// scalar loops take over.
+
+template<typename CharType>
+constexpr NODISCARD std::size_t string_length(const CharType* str) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return std::strlen(reinterpret_cast<const char*>(str));
+    }
+    std::size_t length = 0;
+    while (str[length] != CharType())
+        length++;
+    return length;
+}
+
+template<typename CharType>
+constexpr NODISCARD bool equal_chars(const CharType* a, const CharType* b, std::size_t length) noexcept {
+    if (!std::is_constant_evaluated())
+        return std::memcmp(a, b, sizeof(CharType) * length) == 0;
+
+    for (std::size_t i = 0; i < length; i++) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// -1, 0 or 1 the way the characters compare as unsigned values, a shorter
+// string is less than a longer one it is the start of.
+template<typename CharType>
+constexpr NODISCARD int compare_chars(const CharType* a, std::size_t a_length, const CharType* b, std::size_t b_length) noexcept {
+    const auto length = a_length < b_length ? a_length : b_length;
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated()) {
+            const auto result = length != 0 ? std::memcmp(a, b, length) : 0;
+            if (result != 0)
+                return result < 0 ? -1 : 1;
+            return a_length < b_length ? -1 : a_length > b_length ? 1 : 0;
+        }
+    }
+
+    using unsigned_type = std::make_unsigned_t<CharType>;
+    for (std::size_t i = 0; i < length; i++) {
+        if (a[i] != b[i])
+            return static_cast<unsigned_type>(a[i]) < static_cast<unsigned_type>(b[i]) ? -1 : 1;
+    }
+    return a_length < b_length ? -1 : a_length > b_length ? 1 : 0;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t find_char(const CharType* data, std::size_t length, CharType ch) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return find_byte(as_bytes(data), length, static_cast<byte_type>(ch));
+    }
+    for (std::size_t i = 0; i < length; i++) {
+        if (data[i] == ch)
+            return i;
+    }
+    return npos;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t rfind_char(const CharType* data, std::size_t length, CharType ch) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return rfind_byte(as_bytes(data), length, static_cast<byte_type>(ch));
+    }
+    while (length != 0) {
+        if (data[--length] == ch)
+            return length;
+    }
+    return npos;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t count_char(const CharType* data, std::size_t length, CharType ch) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return count_byte(as_bytes(data), length, static_cast<byte_type>(ch));
+    }
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < length; i++)
+        count += data[i] == ch;
+    return count;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t find_substring(const CharType* data, std::size_t length, const CharType* needle, std::size_t needle_length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return find_bytes(as_bytes(data), length, as_bytes(needle), needle_length);
+    }
+    if (needle_length == 0)
+        return 0;
+    for (std::size_t i = 0; i + needle_length <= length; i++) {
+        if (data[i] == needle[0] && equal_chars(data + i, needle, needle_length))
+            return i;
+    }
+    return npos;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t rfind_substring(const CharType* data, std::size_t length, const CharType* needle, std::size_t needle_length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return rfind_bytes(as_bytes(data), length, as_bytes(needle), needle_length);
+    }
+    if (needle_length > length)
+        return npos;
+    for (std::size_t i = length - needle_length + 1; i != 0; i--) {
+        if (equal_chars(data + i - 1, needle, needle_length))
+            return i - 1;
+    }
+    return npos;
+}
+
+template<typename CharType>
+constexpr NODISCARD std::size_t find_first_of(const CharType* data, std::size_t length, const CharType* set, std::size_t set_length) noexcept {
+    if constexpr (sizeof(CharType) == 1) {
+        if (!std::is_constant_evaluated())
+            return find_first_of_bytes(as_bytes(data), length, as_bytes(set), set_length);
+    }
+    for (std::size_t i = 0; i < length; i++) {
+        for (std::size_t j = 0; j < set_length; j++) {
+            if (data[i] == set[j])
+                return i;
+        }
+    }
+    return npos;
+}
+
+// non overlapping occurrences, like replacing every match would see them.
+template<typename CharType>
+constexpr NODISCARD std::size_t count_substring(const CharType* data, std::size_t length, const CharType* needle, std::size_t needle_length) noexcept {
+    if (needle_length == 0)
+        return 0;
+    if (needle_length == 1)
+        return count_char(data, length, needle[0]);
+
+    std::size_t count = 0;
+    std::size_t offset = 0;
+    for (;;) {
+        const auto pos = find_substring(data + offset, length - offset, needle, needle_length);
+        if (pos == npos)
+            return count;
+        count++;
+        offset += pos + needle_length;
+    }
+}
+
+} // namespace details
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_STRING_SEARCH_HPP
@@ -0,0 +1,311 @@
+#pragma once
+#ifndef XED_STRING_STATS_HPP
+#define XED_STRING_STATS_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include "has_attributes.hpp"
+
+// build with XED_STRING_STATS defined to 1 (cmake -DXED_STRING_STATS=ON) and every
+// basic_string counts its heap traffic into counters of its own thread. without it the
+// hooks are empty inline functions and string_stats_snapshot() returns zeros.
+#if !defined(XED_STRING_STATS)
+#define XED_STRING_STATS 0
+#endif
+
+#if XED_STRING_STATS
+#include <atomic>
+#include <mutex>
+#endif
+
+namespace xed {
+
+constexpr bool string_stats_enabled = XED_STRING_STATS != 0;
+
+// what basic_string did with the heap. sizes are in bytes. the histograms are filled in
+// when a string is destroyed: lengths for every non empty string, inline or not, which
+// is what sso_capacity should be sized from (empty ones are left out, every move leaves
+// one behind), and how much of its buffer a heap string ended up using, by tenths.
+struct string_stats {
+    constexpr static std::size_t length_buckets = 33;
+    constexpr static std::size_t usage_buckets = 11;
+
+    // heap buffers allocated and given back.
+    std::uint64_t allocations = 0;
+    std::uint64_t allocated_bytes = 0;
+    std::uint64_t deallocations = 0;
+    // a string's characters moved to a new buffer, and how many of those were growth
+    // picked by calc_growth rather than reserve, shrink_to_fit or resize_for_overwrite.
+    std::uint64_t reallocations = 0;
+    std::uint64_t growths = 0;
+    // characters copied or moved with memcpy and memmove.
+    std::uint64_t copied_bytes = 0;
+    std::uint64_t inline_strings = 0;
+    std::uint64_t heap_strings = 0;
+    // bucket 0 is length 1, bucket i lengths [2^i, 2^(i + 1)), the last one all the rest.
+    std::uint64_t length_histogram[length_buckets] = {};
+    // bucket i is length / (capacity - 1) in [i / 10, (i + 1) / 10), the last one full.
+    std::uint64_t usage_histogram[usage_buckets] = {};
+
+    string_stats& operator+=(const string_stats& other) noexcept {
+        allocations += other.allocations;
+        allocated_bytes += other.allocated_bytes;
+        deallocations += other.deallocations;
+        reallocations += other.reallocations;
+        growths += other.growths;
+        copied_bytes += other.copied_bytes;
+        inline_strings += other.inline_strings;
+        heap_strings += other.heap_strings;
+        for (std::size_t i = 0; i < length_buckets; i++)
+            length_histogram[i] += other.length_histogram[i];
+        for (std::size_t i = 0; i < usage_buckets; i++)
+            usage_histogram[i] += other.usage_histogram[i];
+        return *this;
+    }
+
+    // what happened since `before` was taken, both from the same thread or both totals.
+    string_stats& operator-=(const string_stats& before) noexcept {
+        allocations -= before.allocations;
+        allocated_bytes -= before.allocated_bytes;
+        deallocations -= before.deallocations;
+        reallocations -= before.reallocations;
+        growths -= before.growths;
+        copied_bytes -= before.copied_bytes;
+        inline_strings -= before.inline_strings;
+        heap_strings -= before.heap_strings;
+        for (std::size_t i = 0; i < length_buckets; i++)
+            length_histogram[i] -= before.length_histogram[i];
+        for (std::size_t i = 0; i < usage_buckets; i++)
+            usage_histogram[i] -= before.usage_histogram[i];
+        return *this;
+    }
+
+    inline NODISCARD string_stats operator-(const string_stats& before) const noexcept {
+        string_stats ret = *this;
+        ret -= before;
+        return ret;
+    }
+
+    static inline NODISCARD std::size_t length_bucket(std::size_t length) noexcept {
+        const auto bucket = static_cast<std::size_t>(std::bit_width(length)) - 1;
+        return bucket < length_buckets ? bucket : length_buckets - 1;
+    }
+};
+
+namespace details {
+
+#if XED_STRING_STATS
+// the counters of one thread. only that thread writes them, so a plain load and store
+// is enough to add, the atomics are there for string_stats_snapshot() reading along.
+struct string_stats_counters {
+    using counter = std::atomic<std::uint64_t>;
+
+    counter allocations{ 0 };
+    counter allocated_bytes{ 0 };
+    counter deallocations{ 0 };
+    counter reallocations{ 0 };
+    counter growths{ 0 };
+    counter copied_bytes{ 0 };
+    counter inline_strings{ 0 };
+    counter heap_strings{ 0 };
+    counter length_histogram[string_stats::length_buckets] = {};
+    counter usage_histogram[string_stats::usage_buckets] = {};
+
+    static inline void add(counter& c, std::uint64_t amount) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void read(string_stats& out) const noexcept {
+        out.allocations = allocations.load(std::memory_order_relaxed);
+        out.allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+        out.deallocations = deallocations.load(std::memory_order_relaxed);
+        out.reallocations = reallocations.load(std::memory_order_relaxed);
+        out.growths = growths.load(std::memory_order_relaxed);
+        out.copied_bytes = copied_bytes.load(std::memory_order_relaxed);
+        out.inline_strings = inline_strings.load(std::memory_order_relaxed);
+        out.heap_strings = heap_strings.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < string_stats::length_buckets; i++)
+            out.length_histogram[i] = length_histogram[i].load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < string_stats::usage_buckets; i++)
+            out.usage_histogram[i] = usage_histogram[i].load(std::memory_order_relaxed);
+    }
+};
+
+struct string_stats_thread;
+
+// every live thread's counters, plus the totals of the threads that are gone.
+struct string_stats_registry {
+    std::mutex lock_;
+    string_stats_thread* threads_ = nullptr;
+    string_stats retired_;
+
+    static inline NODISCARD string_stats_registry& get() noexcept {
+        static string_stats_registry registry;
+        return registry;
+    }
+};
+
+struct string_stats_thread {
+    string_stats_counters counters_;
+    string_stats_thread* prev_ = nullptr;
+    string_stats_thread* next_ = nullptr;
+
+    string_stats_thread() noexcept {
+        auto& registry = string_stats_registry::get();
+        std::lock_guard<std::mutex> guard(registry.lock_);
+        next_ = registry.threads_;
+        if (next_ != nullptr)
+            next_->prev_ = this;
+        registry.threads_ = this;
+    }
+
+    string_stats_thread(const string_stats_thread&) = delete;
+    string_stats_thread& operator=(const string_stats_thread&) = delete;
+
+    ~string_stats_thread() noexcept {
+        auto& registry = string_stats_registry::get();
+        std::lock_guard<std::mutex> guard(registry.lock_);
+        string_stats last;
+        counters_.read(last);
+        registry.retired_ += last;
+        if (prev_ != nullptr)
+            prev_->next_ = next_;
+        else
+            registry.threads_ = next_;
+        if (next_ != nullptr)
+            next_->prev_ = prev_;
+    }
+
+    static inline NODISCARD string_stats_counters& current() noexcept {
+        thread_local string_stats_thread thread;
+        return thread.counters_;
+    }
+};
+#endif
+
+// the hooks basic_string calls, nothing at all unless XED_STRING_STATS is on.
+inline void string_stats_allocated(std::size_t bytes) noexcept {
+#if XED_STRING_STATS
+    auto& c = string_stats_thread::current();
+    string_stats_counters::add(c.allocations, 1);
+    string_stats_counters::add(c.allocated_bytes, bytes);
+#else
+    (void)bytes;
+#endif
+}
+
+inline void string_stats_deallocated() noexcept {
+#if XED_STRING_STATS
+    string_stats_counters::add(string_stats_thread::current().deallocations, 1);
+#endif
+}
+
+inline void string_stats_reallocated() noexcept {
+#if XED_STRING_STATS
+    string_stats_counters::add(string_stats_thread::current().reallocations, 1);
+#endif
+}
+
+inline void string_stats_grew() noexcept {
+#if XED_STRING_STATS
+    string_stats_counters::add(string_stats_thread::current().growths, 1);
+#endif
+}
+
+inline void string_stats_copied(std::size_t bytes) noexcept {
+#if XED_STRING_STATS
+    string_stats_counters::add(string_stats_thread::current().copied_bytes, bytes);
+#else
+    (void)bytes;
+#endif
+}
+
+// `capacity` counts the terminator, 0 for a string that is inline.
+inline void string_stats_destroyed(std::size_t length, std::size_t capacity) noexcept {
+#if XED_STRING_STATS
+    if (length == 0 && capacity == 0)
+        return;
+
+    auto& c = string_stats_thread::current();
+    if (length != 0)
+        string_stats_counters::add(c.length_histogram[string_stats::length_bucket(length)], 1);
+    if (capacity == 0) {
+        string_stats_counters::add(c.inline_strings, 1);
+        return;
+    }
+    string_stats_counters::add(c.heap_strings, 1);
+    const auto usable = capacity > 1 ? capacity - 1 : 1;
+    const auto bucket = length >= usable ? string_stats::usage_buckets - 1 : length * 10 / usable;
+    string_stats_counters::add(c.usage_histogram[bucket], 1);
+#else
+    (void)length;
+    (void)capacity;
+#endif
+}
+
+} // namespace details
+
+// the counters of the calling thread.
+inline NODISCARD string_stats thread_string_stats() noexcept {
+    string_stats ret;
+#if XED_STRING_STATS
+    details::string_stats_thread::current().read(ret);
+#endif
+    return ret;
+}
+
+// the counters of every thread, the ones that already exited included. other threads
+// keep counting while this adds them up, so it's a close picture, not an atomic one.
+inline NODISCARD string_stats string_stats_snapshot() {
+    string_stats ret;
+#if XED_STRING_STATS
+    auto& registry = details::string_stats_registry::get();
+    std::lock_guard<std::mutex> guard(registry.lock_);
+    ret = registry.retired_;
+    for (auto thread = registry.threads_; thread != nullptr; thread = thread->next_) {
+        string_stats one;
+        thread->counters_.read(one);
+        ret += one;
+    }
+#endif
+    return ret;
+}
+
+// a plain text table of `stats`, for logs and for eyeballing.
+inline void print_string_stats(const string_stats& stats, std::FILE* out = stdout) {
+    const auto u = [](std::uint64_t value) { return static_cast<unsigned long long>(value); };
+
+    std::fprintf(out, "allocations     %llu (%llu bytes)\n", u(stats.allocations), u(stats.allocated_bytes));
+    std::fprintf(out, "deallocations   %llu\n", u(stats.deallocations));
+    std::fprintf(out, "reallocations   %llu (%llu growths)\n", u(stats.reallocations), u(stats.growths));
+    std::fprintf(out, "copied bytes    %llu\n", u(stats.copied_bytes));
+    std::fprintf(out, "destroyed       %llu inline, %llu heap\n", u(stats.inline_strings), u(stats.heap_strings));
+
+    std::fprintf(out, "length\n");
+    for (std::size_t i = 0; i < string_stats::length_buckets; i++) {
+        if (stats.length_histogram[i] == 0)
+            continue;
+        const auto first = 1ull << i;
+        if (i + 1 == string_stats::length_buckets)
+            std::fprintf(out, "  %10llu -            %llu\n", first, u(stats.length_histogram[i]));
+        else
+            std::fprintf(out, "  %10llu - %-10llu %llu\n", first, 2 * first - 1, u(stats.length_histogram[i]));
+    }
+
+    std::fprintf(out, "capacity used\n");
+    for (std::size_t i = 0; i < string_stats::usage_buckets; i++) {
+        if (stats.usage_histogram[i] == 0)
+            continue;
+        if (i + 1 == string_stats::usage_buckets)
+            std::fprintf(out, "        100%%           %llu\n", u(stats.usage_histogram[i]));
+        else
+            std::fprintf(out, "  %3zu%% - %3zu%%          %llu\n", i * 10, i * 10 + 9, u(stats.usage_histogram[i]));
+    }
+}
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_STRING_STATS_HPP
@@ -2,6 +2,9 @@
 #ifndef XED_BASIC_STRING_VIEW_HPP
 #define XED_BASIC_STRING_VIEW_HPP 1
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "string_search.hpp"
 #include "has_attributes.hpp"
 namespace xed {
 template<typename CharType>
@@ -91,10 +94,9 @@ public:
 
 public:
 
-    constexpr basic_string_view(value_type ch) noexcept
-        : data_(&ch)
-        , length_(1) {
-    }
+    // a view of one character would point at the parameter, gone once the call returns.
+    // the string functions that take a character have overloads of their own.
+    basic_string_view(value_type ch) = delete;
 
     basic_string_view(std::nullptr_t) = delete;
     basic_string_view(std::nullptr_t,size_type) = delete;
@@ -102,7 +104,7 @@ public:
 
     constexpr basic_string_view(const_pointer_type str) noexcept
         : data_(str)
-        , length_(std::strlen(str)) {
+        , length_(details::string_length(str)) {
     }
 
     constexpr basic_string_view(const_pointer_type str, size_type length) noexcept
@@ -118,8 +120,8 @@ public:
     constexpr basic_string_view& operator=(basic_string_view&&) noexcept = default;
 
 
-    constexpr inline [[nodiscard]] auto length() const noexcept { return length_; }
-    constexpr inline [[nodiscard]] auto data() const noexcept   { return data_; }
+    constexpr inline NODISCARD auto length() const noexcept { return length_; }
+    constexpr inline NODISCARD auto data() const noexcept   { return data_; }
     
     constexpr inline const_reference_type at(size_type index) const {
         if (index >= length_)
@@ -142,6 +144,72 @@ public:
     }
 
 
+    constexpr inline NODISCARD size_type find(this_type str, size_type from_index = 0) const noexcept {
+        if (from_index > length_)
+            return npos;
+
+        const auto pos = details::find_substring(data_ + from_index, length_ - from_index, str.data(), str.length());
+        return pos == npos ? npos : pos + from_index;
+    }
+
+    constexpr inline NODISCARD size_type find(value_type ch, size_type from_index = 0) const noexcept {
+        if (from_index >= length_)
+            return npos;
+
+        const auto pos = details::find_char(data_ + from_index, length_ - from_index, ch);
+        return pos == npos ? npos : pos + from_index;
+    }
+
+    // last match starting at or before from_index.
+    constexpr inline NODISCARD size_type rfind(this_type str, size_type from_index = npos) const noexcept {
+        if (str.length() > length_)
+            return npos;
+
+        const auto last_start = length_ - str.length();
+        const auto limit = (from_index < last_start ? from_index : last_start) + str.length();
+        return details::rfind_substring(data_, limit, str.data(), str.length());
+    }
+
+    constexpr inline NODISCARD size_type rfind(value_type ch, size_type from_index = npos) const noexcept {
+        if (length_ == 0)
+            return npos;
+
+        const auto limit = (from_index < length_ - 1 ? from_index : length_ - 1) + 1;
+        return details::rfind_char(data_, limit, ch);
+    }
+
+    constexpr inline NODISCARD size_type find_first_of(this_type set, size_type from_index = 0) const noexcept {
+        if (from_index >= length_)
+            return npos;
+
+        const auto pos = details::find_first_of(data_ + from_index, length_ - from_index, set.data(), set.length());
+        return pos == npos ? npos : pos + from_index;
+    }
+
+    // non overlapping matches.
+    constexpr inline NODISCARD size_type count(this_type str) const noexcept {
+        return details::count_substring(data_, length_, str.data(), str.length());
+    }
+
+    constexpr inline NODISCARD size_type count(value_type ch) const noexcept {
+        return details::count_char(data_, length_, ch);
+    }
+
+    // lexicographic over the characters as unsigned values, a prefix is less than
+    // the longer string. negative, zero or positive like strcmp.
+    constexpr inline NODISCARD int compare(this_type other) const noexcept {
+        return details::compare_chars(data_, length_, other.data_, other.length_);
+    }
+
+    constexpr inline NODISCARD bool operator==(this_type other) const noexcept {
+        return length_ == other.length_ && details::equal_chars(data_, other.data_, length_);
+    }
+    constexpr inline NODISCARD bool operator!=(this_type other) const noexcept { return !(*this == other); }
+    constexpr inline NODISCARD bool operator<(this_type other) const noexcept { return compare(other) < 0; }
+    constexpr inline NODISCARD bool operator>(this_type other) const noexcept { return compare(other) > 0; }
+    constexpr inline NODISCARD bool operator<=(this_type other) const noexcept { return compare(other) <= 0; }
+    constexpr inline NODISCARD bool operator>=(this_type other) const noexcept { return compare(other) >= 0; }
+
     inline NODISCARD const_iterator begin() const noexcept { return data_ + 0; }
     inline NODISCARD const_iterator end() const noexcept { return data_ + length_ + 1; }
     inline NODISCARD const_reverse_iterator rbegin() const noexcept { return (data_ + length_) - 1; }
@@ -189,4 +257,4 @@ inline NODISCARD u32string_view operator""_sv(const char32_t* str, std::size_t l
 } // namespace xed
 
 #include "undef.hpp"
-#endif // !BASIC_STRING_VIEW_HPP
\ No newline at end of file
+#endif // !BASIC_STRING_VIEW_HPP
\ No newline at end of file
@@ -46,6 +46,12 @@ template<typename T> struct is_same<T, T>       : true_type  {};
 
 template<typename T,typename U>
 constexpr static bool is_same_v = is_same<T, U>::value;
+
+// keeps a parameter out of template argument deduction.
+template<typename T> struct type_identity { using type = T; };
+
+template<typename T>
+using type_identity_t = typename type_identity<T>::type;
 } // namespace xed
 
 
@@ -5,4 +5,8 @@
 #undef CONSTEXPR20
 #undef CONSTEXPR17
 #undef CONSTEXPR14
-#undef CONSTEXPR11
\ No newline at end of file
+#undef CONSTEXPR11
+#undef NO_UNIQUE_ADDRESS
+#undef XED_HAS_AVX2
+#undef XED_HAS_SSE2
+#undef XED_HAS_SSSE3
\ No newline at end of file
@@ -0,0 +1,791 @@
+#pragma once
+#ifndef XED_UTF_HPP
+#define XED_UTF_HPP 1
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "xutility.hpp"
+#include "string_view.hpp"
+#include "basic_string.hpp"
+#include "simd.hpp"
+#include "has_attributes.hpp"
+
+// utf-8 validation, length counting and transcoding between utf-8, utf-16 and utf-32.
+// validation finds every ill formed sequence the standard names: overlong forms,
+// surrogates, code points past U+10FFFF, stray and missing continuation bytes.
+// the to_ functions validate first and throw std::range_error on bad input, then
+// convert without checking into a string that was sized up front by the length
+// functions, so the output is allocated exactly once.
+
+namespace xed {
+namespace details {
+
+inline NODISCARD bool is_utf8_continuation(byte_type c) noexcept {
+    return (c & 0xc0) == 0x80;
+}
+
+// how many bytes the well formed sequence at `data` takes, 0 when it is ill formed.
+inline NODISCARD std::size_t utf8_sequence_length(const byte_type* data, std::size_t left) noexcept {
+    const auto lead = data[0];
+    if (lead < 0x80)
+        return 1;
+    if (lead < 0xc2)
+        return 0;
+    if (lead < 0xe0)
+        return left >= 2 && is_utf8_continuation(data[1]) ? 2 : 0;
+
+    // the second byte has a narrower range after the leads that could start an
+    // overlong form, a surrogate or something past U+10FFFF.
+    if (lead < 0xf0) {
+        if (left < 3)
+            return 0;
+        const byte_type low = lead == 0xe0 ? 0xa0 : 0x80;
+        const byte_type high = lead == 0xed ? 0x9f : 0xbf;
+        return data[1] >= low && data[1] <= high && is_utf8_continuation(data[2]) ? 3 : 0;
+    }
+    if (lead < 0xf5) {
+        if (left < 4)
+            return 0;
+        const byte_type low = lead == 0xf0 ? 0x90 : 0x80;
+        const byte_type high = lead == 0xf4 ? 0x8f : 0xbf;
+        return data[1] >= low && data[1] <= high && is_utf8_continuation(data[2]) && is_utf8_continuation(data[3]) ? 4 : 0;
+    }
+    return 0;
+}
+
+// plain ascii goes by a word at a time, everything else a sequence at a time.
+inline NODISCARD std::size_t find_invalid_utf8_scalar(const byte_type* data, std::size_t length) noexcept {
+    std::size_t pos = 0;
+    while (pos < length) {
+        while (pos + 8 <= length) {
+            std::uint64_t word;
+            std::memcpy(&word, data + pos, sizeof(word));
+            if ((word & 0x8080808080808080ull) != 0)
+                break;
+            pos += 8;
+        }
+        if (pos == length)
+            break;
+
+        const auto sequence = utf8_sequence_length(data + pos, length - pos);
+        if (sequence == 0)
+            return pos;
+        pos += sequence;
+    }
+    return npos;
+}
+
+#if XED_HAS_AVX2
+// the lookup algorithm of Keiser and Lemire: three nibble lookups over every byte and
+// the byte before it give the errors that two bytes can show, one more check covers
+// the third and fourth bytes of longer sequences. 32 bytes per step and no branches
+// past the one that skips all ascii blocks.
+class utf8_checker {
+public:
+    // the input ends with a full zero block, so a sequence cut off by the end shows up
+    // as one followed by ascii.
+    inline void check(__m256i input) noexcept {
+        if (_mm256_movemask_epi8(input) == 0) {
+            error_ = _mm256_or_si256(error_, prev_incomplete_);
+            prev_incomplete_ = _mm256_setzero_si256();
+        }
+        else {
+            const auto prev1 = previous<1>(input);
+            const auto special = special_cases(input, prev1);
+            error_ = _mm256_or_si256(error_, multibyte_lengths(input, special));
+            prev_incomplete_ = _mm256_subs_epu8(input, _mm256_setr_epi8(
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xf0 - 1), char(0xe0 - 1), char(0xc0 - 1)));
+        }
+        prev_input_ = input;
+    }
+
+    inline NODISCARD bool has_error() const noexcept {
+        return !_mm256_testz_si256(error_, error_);
+    }
+
+    inline NODISCARD bool finish() noexcept {
+        error_ = _mm256_or_si256(error_, prev_incomplete_);
+        return !has_error();
+    }
+private:
+    static constexpr char too_short = 1 << 0;
+    static constexpr char too_long = 1 << 1;
+    static constexpr char overlong_3 = 1 << 2;
+    static constexpr char too_large = 1 << 3;
+    static constexpr char surrogate = 1 << 4;
+    static constexpr char overlong_2 = 1 << 5;
+    static constexpr char too_large_1000 = 1 << 6;
+    static constexpr char overlong_4 = 1 << 6;
+    static constexpr char two_continuations = char(1 << 7);
+    static constexpr char carry = too_short | too_long | two_continuations;
+
+    // the bytes of `input` shifted along by N, with the end of the previous block in front.
+    template<int N>
+    inline NODISCARD __m256i previous(__m256i input) const noexcept {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input_, input, 0x21), 16 - N);
+    }
+
+    static inline NODISCARD __m256i high_nibbles(__m256i value) noexcept {
+        return _mm256_and_si256(_mm256_srli_epi16(value, 4), _mm256_set1_epi8(0x0f));
+    }
+
+    static inline NODISCARD __m256i special_cases(__m256i input, __m256i prev1) noexcept {
+        const auto byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            two_continuations, two_continuations, two_continuations, two_continuations,
+            too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+            too_short | too_large | too_large_1000 | overlong_4,
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            two_continuations, two_continuations, two_continuations, two_continuations,
+            too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+            too_short | too_large | too_large_1000 | overlong_4), high_nibbles(prev1));
+
+        const auto byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+            carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+            carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000),
+            _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)));
+
+        const auto byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            too_short, too_short, too_short, too_short,
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            too_short, too_short, too_short, too_short), high_nibbles(input));
+
+        return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    }
+
+    // two continuations in a row are only right as the third or fourth byte of a
+    // sequence, which is what the byte two or three back tells.
+    inline NODISCARD __m256i multibyte_lengths(__m256i input, __m256i special) const noexcept {
+        const auto third = _mm256_subs_epu8(previous<2>(input), _mm256_set1_epi8(char(0xe0 - 0x80)));
+        const auto fourth = _mm256_subs_epu8(previous<3>(input), _mm256_set1_epi8(char(0xf0 - 0x80)));
+        const auto must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+        return _mm256_xor_si256(must_continue, special);
+    }
+private:
+    __m256i error_ = _mm256_setzero_si256();
+    __m256i prev_input_ = _mm256_setzero_si256();
+    __m256i prev_incomplete_ = _mm256_setzero_si256();
+};
+#endif
+
+// the offset of the lead byte of the first ill formed sequence, or npos.
+inline NODISCARD std::size_t find_invalid_utf8(const byte_type* data, std::size_t length) noexcept {
+#if XED_HAS_AVX2
+    constexpr std::size_t block = 32;
+    utf8_checker checker;
+    std::size_t pos = 0;
+    for (; pos + block <= length; pos += block) {
+        checker.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos)));
+        if (checker.has_error())
+            break;
+    }
+
+    if (!checker.has_error()) {
+        byte_type tail[block] = {};
+        std::memcpy(tail, data + pos, length - pos);
+        checker.check(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)));
+        if (checker.finish())
+            return npos;
+    }
+    // only bad input gets here, the scalar pass pins down where it goes wrong.
+    return find_invalid_utf8_scalar(data, length);
+#elif XED_HAS_SIMD_BLOCK
+    // no byte shuffles in plain sse2, so only the ascii runs go by vector.
+    std::size_t pos = 0;
+    while (pos < length) {
+        while (pos + simd_block::size <= length && simd_block::mask(simd_block::load(data + pos)) == 0)
+            pos += simd_block::size;
+
+        const auto stop = pos + simd_block::size < length ? pos + simd_block::size : length;
+        while (pos < stop) {
+            const auto sequence = utf8_sequence_length(data + pos, length - pos);
+            if (sequence == 0)
+                return pos;
+            pos += sequence;
+        }
+    }
+    return npos;
+#else
+    return find_invalid_utf8_scalar(data, length);
+#endif
+}
+
+// every byte that doesn't continue a sequence starts a code point, and the ones that
+// start 4 byte sequences need a surrogate pair in utf-16. the input has to be valid.
+inline NODISCARD std::size_t count_utf8(const byte_type* data, std::size_t length, bool surrogates) noexcept {
+    std::size_t count = 0;
+    std::size_t pos = 0;
+#if XED_HAS_SIMD_BLOCK
+    // as signed bytes continuations are -128 to -65 and 4 byte leads -16 to -1.
+    const auto continuation_end = simd_block::splat(0xc0);
+    const auto long_lead = simd_block::splat(0xf0);
+    const auto zero = simd_block::splat(0);
+    for (; pos + simd_block::size <= length; pos += simd_block::size) {
+        const auto block = simd_block::load(data + pos);
+        count += simd_block::size - std::popcount(simd_block::mask(simd_block::less(block, continuation_end)));
+        if (surrogates) {
+            const auto negative = simd_block::mask(simd_block::less(block, zero));
+            count += std::popcount(negative & ~simd_block::mask(simd_block::less(block, long_lead)));
+        }
+    }
+#endif
+    for (; pos < length; pos++) {
+        count += !is_utf8_continuation(data[pos]);
+        count += surrogates && data[pos] >= 0xf0;
+    }
+    return count;
+}
+
+// decodes the valid sequence at `data` and moves past it.
+inline NODISCARD char32_t decode_utf8(const byte_type*& data) noexcept {
+    const char32_t lead = data[0];
+    if (lead < 0x80) {
+        data += 1;
+        return lead;
+    }
+    if (lead < 0xe0) {
+        const auto code = ((lead & 0x1f) << 6) | (data[1] & 0x3f);
+        data += 2;
+        return code;
+    }
+    if (lead < 0xf0) {
+        const auto code = ((lead & 0x0f) << 12) | ((data[1] & 0x3f) << 6) | (data[2] & 0x3f);
+        data += 3;
+        return code;
+    }
+    const auto code = ((lead & 0x07) << 18) | ((data[1] & 0x3f) << 12) | ((data[2] & 0x3f) << 6) | (data[3] & 0x3f);
+    data += 4;
+    return code;
+}
+
+template<typename CharType>
+inline NODISCARD CharType* encode_utf8(char32_t code, CharType* out) noexcept {
+    if (code < 0x80) {
+        *out++ = static_cast<CharType>(code);
+    }
+    else if (code < 0x800) {
+        *out++ = static_cast<CharType>(0xc0 | (code >> 6));
+        *out++ = static_cast<CharType>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000) {
+        *out++ = static_cast<CharType>(0xe0 | (code >> 12));
+        *out++ = static_cast<CharType>(0x80 | ((code >> 6) & 0x3f));
+        *out++ = static_cast<CharType>(0x80 | (code & 0x3f));
+    }
+    else {
+        *out++ = static_cast<CharType>(0xf0 | (code >> 18));
+        *out++ = static_cast<CharType>(0x80 | ((code >> 12) & 0x3f));
+        *out++ = static_cast<CharType>(0x80 | ((code >> 6) & 0x3f));
+        *out++ = static_cast<CharType>(0x80 | (code & 0x3f));
+    }
+    return out;
+}
+
+inline NODISCARD char16_t* encode_utf16(char32_t code, char16_t* out) noexcept {
+    if (code < 0x10000) {
+        *out++ = static_cast<char16_t>(code);
+    }
+    else {
+        code -= 0x10000;
+        *out++ = static_cast<char16_t>(0xd800 | (code >> 10));
+        *out++ = static_cast<char16_t>(0xdc00 | (code & 0x3ff));
+    }
+    return out;
+}
+
+inline NODISCARD char32_t decode_utf16(const char16_t*& data) noexcept {
+    const char32_t unit = *data++;
+    if ((unit & 0xfc00) != 0xd800)
+        return unit;
+    return 0x10000 + ((unit - 0xd800) << 10) + (*data++ - 0xdc00);
+}
+
+// the ascii start of a block goes out by vector. returns how many characters of
+// `data` were plain ascii and got written, a multiple of the vector size.
+template<typename OutType>
+inline NODISCARD std::size_t widen_ascii(const byte_type* data, std::size_t length, OutType* out) noexcept {
+    std::size_t pos = 0;
+#if XED_HAS_SIMD_BLOCK
+    for (; pos + 16 <= length; pos += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        if (_mm_movemask_epi8(bytes) != 0)
+            break;
+
+        const auto zero = _mm_setzero_si128();
+        const auto low = _mm_unpacklo_epi8(bytes, zero);
+        const auto high = _mm_unpackhi_epi8(bytes, zero);
+        auto target = reinterpret_cast<__m128i*>(out + pos);
+        if constexpr (sizeof(OutType) == 2) {
+            _mm_storeu_si128(target, low);
+            _mm_storeu_si128(target + 1, high);
+        }
+        else {
+            _mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
+        }
+    }
+#else
+    (void)data;
+    (void)length;
+    (void)out;
+#endif
+    return pos;
+}
+
+#if XED_HAS_AVX2
+// shuffles for the transcoder below, worked out at compile time. a 12 bit mask of where
+// code points end picks how the next few code points get moved into 16 or 32 bit lanes
+// with one byte shuffle: 6 code points of 1 or 2 bytes, or 4 of up to 3 bytes. anything
+// else, 4 byte sequences, goes one code point at a time.
+struct utf8_shuffle_entry {
+    std::uint8_t kind_;
+    std::uint8_t consumed_;
+    std::uint8_t index_;
+};
+
+struct utf8_shuffle_tables {
+    static constexpr std::uint8_t two_byte = 0;
+    static constexpr std::uint8_t three_byte = 1;
+    static constexpr std::uint8_t one_by_one = 2;
+
+    utf8_shuffle_entry entry_[1 << 12] = {};
+    alignas(16) std::uint8_t two_byte_[64][16] = {};
+    alignas(16) std::uint8_t three_byte_[81][16] = {};
+};
+
+constexpr NODISCARD utf8_shuffle_tables make_utf8_shuffle_tables() noexcept {
+    constexpr std::uint8_t zero = 0x80;
+    utf8_shuffle_tables tables;
+
+    // lane j holds the last byte of code point j, then the one before it and so on.
+    for (std::size_t index = 0; index < 64; index++) {
+        std::uint8_t pos = 0;
+        for (std::size_t j = 0; j < 8; j++) {
+            const std::uint8_t length = j < 6 ? 1 + ((index >> j) & 1) : 0;
+            tables.two_byte_[index][2 * j] = length != 0 ? pos + length - 1 : zero;
+            tables.two_byte_[index][2 * j + 1] = length == 2 ? pos : zero;
+            pos += length;
+        }
+    }
+    for (std::size_t index = 0; index < 81; index++) {
+        std::uint8_t pos = 0;
+        auto digits = index;
+        for (std::size_t j = 0; j < 4; j++, digits /= 3) {
+            const std::uint8_t length = 1 + digits % 3;
+            tables.three_byte_[index][4 * j] = pos + length - 1;
+            tables.three_byte_[index][4 * j + 1] = length >= 2 ? pos + length - 2 : zero;
+            tables.three_byte_[index][4 * j + 2] = length == 3 ? pos : zero;
+            tables.three_byte_[index][4 * j + 3] = zero;
+            pos += length;
+        }
+    }
+
+    for (std::size_t mask = 0; mask < (1 << 12); mask++) {
+        std::size_t lengths[12] = {};
+        std::size_t count = 0;
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < 12; i++) {
+            if ((mask >> i) & 1) {
+                lengths[count++] = i + 1 - start;
+                start = i + 1;
+            }
+        }
+
+        auto& entry = tables.entry_[mask];
+        entry.kind_ = utf8_shuffle_tables::one_by_one;
+
+        bool short_ones = count >= 6;
+        for (std::size_t j = 0; j < 6 && short_ones; j++)
+            short_ones = lengths[j] <= 2;
+        if (short_ones) {
+            std::size_t index = 0, consumed = 0;
+            for (std::size_t j = 0; j < 6; j++) {
+                index |= (lengths[j] - 1) << j;
+                consumed += lengths[j];
+            }
+            entry = { utf8_shuffle_tables::two_byte, static_cast<std::uint8_t>(consumed), static_cast<std::uint8_t>(index) };
+            continue;
+        }
+
+        bool up_to_three = count >= 4;
+        for (std::size_t j = 0; j < 4 && up_to_three; j++)
+            up_to_three = lengths[j] <= 3;
+        if (up_to_three) {
+            std::size_t index = 0, consumed = 0, scale = 1;
+            for (std::size_t j = 0; j < 4; j++, scale *= 3) {
+                index += (lengths[j] - 1) * scale;
+                consumed += lengths[j];
+            }
+            entry = { utf8_shuffle_tables::three_byte, static_cast<std::uint8_t>(consumed), static_cast<std::uint8_t>(index) };
+        }
+    }
+    return tables;
+}
+
+inline constexpr utf8_shuffle_tables utf8_shuffles = make_utf8_shuffle_tables();
+
+// the vector part of utf-8 to utf-16 or utf-32, after Lemire and Clausecker: 64 byte
+// windows, in each the continuation bytes give the code point ends, and every step
+// either widens 16 ascii bytes or shuffles the next code points into place. stores go
+// a few units past what a step writes, so it stops while plenty of input is left and
+// returns how far it got.
+template<typename OutType>
+inline NODISCARD std::size_t transcode_utf8_vector(const byte_type* data, std::size_t length, OutType*& out) noexcept {
+    constexpr std::size_t window = 64;
+    constexpr std::size_t step_limit = 48;
+
+    std::size_t pos = 0;
+    while (pos + window + step_limit / 3 <= length) {
+        const auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        const auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 32));
+        const auto non_ascii = std::uint64_t(std::uint32_t(_mm256_movemask_epi8(low)))
+            | (std::uint64_t(std::uint32_t(_mm256_movemask_epi8(high))) << 32);
+
+        if (non_ascii == 0) {
+            const auto widened = widen_ascii(data + pos, window, out);
+            pos += widened;
+            out += widened;
+            continue;
+        }
+
+        // as signed bytes continuations are the ones below -64.
+        const auto continuation_end = _mm256_set1_epi8(char(0xc0));
+        const auto continuations = std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(continuation_end, low))))
+            | (std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(continuation_end, high)))) << 32);
+        const auto ends = ~continuations >> 1;
+
+        std::size_t offset = 0;
+        while (offset < step_limit) {
+            const auto at = data + pos + offset;
+            if (((non_ascii >> offset) & 0xffff) == 0) {
+                out += widen_ascii(at, 16, out);
+                offset += 16;
+                continue;
+            }
+
+            const auto& entry = utf8_shuffles.entry_[(ends >> offset) & 0xfff];
+            const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+            if (entry.kind_ == utf8_shuffle_tables::two_byte) {
+                const auto shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_shuffles.two_byte_[entry.index_]));
+                const auto lanes = _mm_shuffle_epi8(input, shuffle);
+                const auto ascii = _mm_and_si128(lanes, _mm_set1_epi16(0x7f));
+                const auto lead = _mm_and_si128(lanes, _mm_set1_epi16(0x1f00));
+                const auto units = _mm_or_si128(ascii, _mm_srli_epi16(lead, 2));
+                if constexpr (sizeof(OutType) == 2)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), units);
+                else
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu16_epi32(units));
+                out += 6;
+                offset += entry.consumed_;
+            }
+            else if (entry.kind_ == utf8_shuffle_tables::three_byte) {
+                const auto shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_shuffles.three_byte_[entry.index_]));
+                const auto lanes = _mm_shuffle_epi8(input, shuffle);
+                const auto ascii = _mm_and_si128(lanes, _mm_set1_epi32(0x7f));
+                const auto middle = _mm_srli_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0x3f00)), 2);
+                const auto lead = _mm_srli_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0x0f0000)), 4);
+                const auto code_points = _mm_or_si128(_mm_or_si128(ascii, middle), lead);
+                if constexpr (sizeof(OutType) == 2)
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi32(code_points, code_points));
+                else
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), code_points);
+                out += 4;
+                offset += entry.consumed_;
+            }
+            else {
+                auto next = at;
+                const auto code = decode_utf8(next);
+                if constexpr (sizeof(OutType) == 2)
+                    out = reinterpret_cast<OutType*>(encode_utf16(code, reinterpret_cast<char16_t*>(out)));
+                else
+                    *out++ = static_cast<OutType>(code);
+                offset += static_cast<std::size_t>(next - at);
+            }
+        }
+        pos += offset;
+    }
+    return pos;
+}
+#endif
+
+// utf-8 to utf-16 or utf-32 for valid input, returns one past the last written.
+template<typename OutType>
+inline OutType* transcode_utf8(const byte_type* data, std::size_t length, OutType* out) noexcept {
+#if XED_HAS_AVX2
+    const auto done = transcode_utf8_vector(data, length, out);
+    data += done;
+    length -= done;
+#endif
+    const auto end = data + length;
+    while (data != end) {
+        const auto ascii = widen_ascii(data, static_cast<std::size_t>(end - data), out);
+        data += ascii;
+        out += ascii;
+
+        // then up to a vector's worth a character at a time before trying again.
+        const auto stop = end - data > 16 ? data + 16 : end;
+        while (data < stop) {
+            const auto code = decode_utf8(data);
+            if constexpr (sizeof(OutType) == 2)
+                out = reinterpret_cast<OutType*>(encode_utf16(code, reinterpret_cast<char16_t*>(out)));
+            else
+                *out++ = static_cast<OutType>(code);
+        }
+    }
+    return out;
+}
+
+// how many leading units of `data`, a multiple of 8, are all below `limit`.
+template<typename UnitType>
+inline NODISCARD std::size_t count_below(const UnitType* data, std::size_t length, std::uint32_t limit) noexcept {
+    std::size_t pos = 0;
+    for (; pos + 8 <= length; pos += 8) {
+        std::uint32_t any = 0;
+        for (std::size_t i = 0; i < 8; i++)
+            any |= static_cast<std::uint32_t>(data[pos + i]) >= limit;
+        if (any != 0)
+            break;
+    }
+    return pos;
+}
+
+} // namespace details
+
+// the offset of the first byte of the first ill formed sequence, or npos when the
+// whole input is valid utf-8.
+inline NODISCARD std::size_t find_invalid_utf8(u8string_view str) noexcept {
+    return details::find_invalid_utf8(details::as_bytes(str.data()), str.length());
+}
+
+inline NODISCARD std::size_t find_invalid_utf8(string_view str) noexcept {
+    return details::find_invalid_utf8(details::as_bytes(str.data()), str.length());
+}
+
+inline NODISCARD bool is_valid_utf8(u8string_view str) noexcept { return find_invalid_utf8(str) == npos; }
+inline NODISCARD bool is_valid_utf8(string_view str) noexcept { return find_invalid_utf8(str) == npos; }
+
+// surrogates have to come in high and low pairs.
+inline NODISCARD bool is_valid_utf16(u16string_view str) noexcept {
+    const auto data = str.data();
+    const auto length = str.length();
+    for (std::size_t pos = 0; pos < length; pos++) {
+        pos += details::count_below(data + pos, length - pos, 0xd800);
+        if (pos == length)
+            break;
+
+        const auto unit = data[pos];
+        if ((unit & 0xf800) != 0xd800)
+            continue;
+        if (unit >= 0xdc00 || pos + 1 == length || (data[pos + 1] & 0xfc00) != 0xdc00)
+            return false;
+        pos++;
+    }
+    return true;
+}
+
+inline NODISCARD bool is_valid_utf32(u32string_view str) noexcept {
+    std::uint32_t bad = 0;
+    for (std::size_t i = 0; i < str.length(); i++) {
+        const auto code = static_cast<std::uint32_t>(str[i]);
+        bad |= static_cast<std::uint32_t>(code > 0x10ffff) | static_cast<std::uint32_t>((code & 0xfffff800) == 0xd800);
+    }
+    return bad == 0;
+}
+
+// the lengths the to_ functions are going to produce, in code units of the target.
+// the input has to be valid.
+
+inline NODISCARD std::size_t utf16_length(u8string_view str) noexcept {
+    return details::count_utf8(details::as_bytes(str.data()), str.length(), true);
+}
+
+inline NODISCARD std::size_t utf16_length(string_view str) noexcept {
+    return details::count_utf8(details::as_bytes(str.data()), str.length(), true);
+}
+
+inline NODISCARD std::size_t utf32_length(u8string_view str) noexcept {
+    return details::count_utf8(details::as_bytes(str.data()), str.length(), false);
+}
+
+inline NODISCARD std::size_t utf32_length(string_view str) noexcept {
+    return details::count_utf8(details::as_bytes(str.data()), str.length(), false);
+}
+
+inline NODISCARD std::size_t utf8_length(u16string_view str) noexcept {
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < str.length(); i++) {
+        const auto unit = static_cast<std::uint32_t>(str[i]);
+        // each half of a surrogate pair is 2 of the 4 bytes.
+        length += 1 + (unit >= 0x80) + (unit >= 0x800) - ((unit & 0xf800) == 0xd800);
+    }
+    return length;
+}
+
+inline NODISCARD std::size_t utf8_length(u32string_view str) noexcept {
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < str.length(); i++) {
+        const auto code = static_cast<std::uint32_t>(str[i]);
+        length += 1 + (code >= 0x80) + (code >= 0x800) + (code >= 0x10000);
+    }
+    return length;
+}
+
+inline NODISCARD std::size_t utf16_length(u32string_view str) noexcept {
+    std::size_t length = str.length();
+    for (std::size_t i = 0; i < str.length(); i++)
+        length += static_cast<std::uint32_t>(str[i]) >= 0x10000;
+    return length;
+}
+
+inline NODISCARD std::size_t utf32_length(u16string_view str) noexcept {
+    std::size_t length = str.length();
+    for (std::size_t i = 0; i < str.length(); i++)
+        length -= (static_cast<std::uint32_t>(str[i]) & 0xfc00) == 0xdc00;
+    return length;
+}
+
+namespace details {
+
+[[noreturn]] inline void throw_invalid_utf(const char* message) {
+    throw std::range_error(message);
+}
+
+template<typename OutType, typename Allocator>
+inline void utf8_to(const byte_type* data, std::size_t length, basic_string<OutType, Allocator>& out, const char* message) {
+    if (find_invalid_utf8(data, length) != npos)
+        throw_invalid_utf(message);
+
+    out.resize_for_overwrite(count_utf8(data, length, sizeof(OutType) == 2));
+    transcode_utf8(data, length, out.data());
+}
+
+} // namespace details
+
+// the target string is overwritten, and sized once up front. throws std::range_error
+// when the input is not valid.
+
+template<typename Allocator>
+inline void to_utf16(u8string_view str, basic_string<char16_t, Allocator>& out) {
+    details::utf8_to(details::as_bytes(str.data()), str.length(), out, "from to_utf16: invalid utf-8");
+}
+
+template<typename Allocator>
+inline void to_utf16(string_view str, basic_string<char16_t, Allocator>& out) {
+    details::utf8_to(details::as_bytes(str.data()), str.length(), out, "from to_utf16: invalid utf-8");
+}
+
+template<typename Allocator>
+inline void to_utf32(u8string_view str, basic_string<char32_t, Allocator>& out) {
+    details::utf8_to(details::as_bytes(str.data()), str.length(), out, "from to_utf32: invalid utf-8");
+}
+
+template<typename Allocator>
+inline void to_utf32(string_view str, basic_string<char32_t, Allocator>& out) {
+    details::utf8_to(details::as_bytes(str.data()), str.length(), out, "from to_utf32: invalid utf-8");
+}
+
+// into a u8string or a plain string.
+template<typename CharType, typename Allocator>
+inline void to_utf8(u16string_view str, basic_string<CharType, Allocator>& out) {
+    static_assert(sizeof(CharType) == 1, "to_utf8 writes 1 byte characters");
+    if (!is_valid_utf16(str))
+        details::throw_invalid_utf("from to_utf8: invalid utf-16");
+
+    out.resize_for_overwrite(utf8_length(str));
+    auto data = str.data();
+    const auto end = data + str.length();
+    auto write = out.data();
+    while (data != end) {
+        const auto ascii = details::count_below(data, static_cast<std::size_t>(end - data), 0x80);
+        for (std::size_t i = 0; i < ascii; i++)
+            write[i] = static_cast<CharType>(data[i]);
+        data += ascii;
+        write += ascii;
+
+        const auto stop = end - data > 8 ? data + 8 : end;
+        while (data < stop)
+            write = details::encode_utf8(details::decode_utf16(data), write);
+    }
+}
+
+template<typename CharType, typename Allocator>
+inline void to_utf8(u32string_view str, basic_string<CharType, Allocator>& out) {
+    static_assert(sizeof(CharType) == 1, "to_utf8 writes 1 byte characters");
+    if (!is_valid_utf32(str))
+        details::throw_invalid_utf("from to_utf8: invalid utf-32");
+
+    out.resize_for_overwrite(utf8_length(str));
+    auto data = str.data();
+    const auto end = data + str.length();
+    auto write = out.data();
+    while (data != end) {
+        const auto ascii = details::count_below(data, static_cast<std::size_t>(end - data), 0x80);
+        for (std::size_t i = 0; i < ascii; i++)
+            write[i] = static_cast<CharType>(data[i]);
+        data += ascii;
+        write += ascii;
+
+        const auto stop = end - data > 8 ? data + 8 : end;
+        while (data < stop)
+            write = details::encode_utf8(*data++, write);
+    }
+}
+
+template<typename Allocator>
+inline void to_utf16(u32string_view str, basic_string<char16_t, Allocator>& out) {
+    if (!is_valid_utf32(str))
+        details::throw_invalid_utf("from to_utf16: invalid utf-32");
+
+    out.resize_for_overwrite(utf16_length(str));
+    auto write = out.data();
+    for (std::size_t i = 0; i < str.length(); i++)
+        write = details::encode_utf16(str[i], write);
+}
+
+template<typename Allocator>
+inline void to_utf32(u16string_view str, basic_string<char32_t, Allocator>& out) {
+    if (!is_valid_utf16(str))
+        details::throw_invalid_utf("from to_utf32: invalid utf-16");
+
+    out.resize_for_overwrite(utf32_length(str));
+    auto data = str.data();
+    const auto end = data + str.length();
+    auto write = out.data();
+    while (data != end)
+        *write++ = details::decode_utf16(data);
+}
+
+inline NODISCARD u16string to_utf16(u8string_view str) { u16string out; to_utf16(str, out); return out; }
+inline NODISCARD u16string to_utf16(string_view str) { u16string out; to_utf16(str, out); return out; }
+inline NODISCARD u16string to_utf16(u32string_view str) { u16string out; to_utf16(str, out); return out; }
+inline NODISCARD u32string to_utf32(u8string_view str) { u32string out; to_utf32(str, out); return out; }
+inline NODISCARD u32string to_utf32(string_view str) { u32string out; to_utf32(str, out); return out; }
+inline NODISCARD u32string to_utf32(u16string_view str) { u32string out; to_utf32(str, out); return out; }
+inline NODISCARD u8string to_utf8(u16string_view str) { u8string out; to_utf8(str, out); return out; }
+inline NODISCARD u8string to_utf8(u32string_view str) { u8string out; to_utf8(str, out); return out; }
+
+} // namespace xed
+
+#include "undef.hpp"
+
+#endif // !XED_UTF_HPP
@@ -1,6 +1,9 @@
 #pragma once
 #include "type_traits.hpp"
 #include "move.hpp"
+#include <cstddef>
+
+static constexpr std::size_t npos = -1;
 namespace xed {
 template<typename T1,typename T2>
 T1 exchange(T1& exchange_with,const T2& value) noexcept {
@@ -0,0 +1,340 @@
+#include <cstdio>
+#include <string>
+#include "basic_string.hpp"
+
+// short/long transitions of basic_string: every operation is run on strings of length
+// 0, sso_capacity - 1, sso_capacity, sso_capacity + 1 and a long one, and the result is
+// checked for where it lives, its length, its characters and the terminator.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+template<typename CharType>
+using reference_string = std::basic_string<CharType>;
+
+// `length` characters that differ from their neighbours, so a shifted copy shows.
+template<typename CharType>
+reference_string<CharType> make_text(std::size_t length, std::size_t seed = 0) {
+    reference_string<CharType> ret;
+    for (std::size_t i = 0; i < length; i++)
+        ret.push_back(static_cast<CharType>('a' + (i + seed) % 26));
+    return ret;
+}
+
+template<typename CharType>
+xed::basic_string<CharType> make_string(const reference_string<CharType>& text) {
+    return { text.data(), text.size() };
+}
+
+template<typename CharType>
+xed::basic_string_view<CharType> view(const reference_string<CharType>& text) {
+    return { text.data(), text.size() };
+}
+
+template<typename CharType>
+void report(bool condition, const char* what, std::size_t length, int line) {
+    if (!condition) {
+        std::fprintf(stderr, "%s:%d: failed: %s (char size %zu, length %zu)\n", __FILE__, line, what, sizeof(CharType), length);
+        failures++;
+    }
+}
+
+// the length of `s`, its characters and the terminator.
+template<typename CharType>
+void check_contents(const xed::basic_string<CharType>& s, const reference_string<CharType>& expected, int line) {
+    report<CharType>(s.length() == expected.size(), "length()", expected.size(), line);
+    report<CharType>(s.length() < s.capacity(), "length() < capacity()", expected.size(), line);
+    report<CharType>(reference_string<CharType>(s.data(), s.length()) == expected, "contents", expected.size(), line);
+    report<CharType>(s.data()[s.length()] == 0, "terminator", expected.size(), line);
+}
+
+// and where it lives.
+template<typename CharType>
+void check_string(const xed::basic_string<CharType>& s, const reference_string<CharType>& expected, bool is_inline, int line) {
+    report<CharType>(s.is_inline() == is_inline, "is_inline()", expected.size(), line);
+    check_contents(s, expected, line);
+}
+
+#define XED_CHECK_STRING(str, expected, is_inline) check_string((str), (expected), (is_inline), __LINE__)
+#define XED_CHECK_CONTENTS(str, expected) check_contents((str), (expected), __LINE__)
+
+template<typename CharType>
+void test_lengths() {
+    using string = xed::basic_string<CharType>;
+    constexpr auto sso = string::sso_capacity;
+    const std::size_t lengths[] = { 0, sso - 1, sso, sso + 1, 4 * sso + 7 };
+
+    for (const auto length : lengths) {
+        const auto text = make_text<CharType>(length);
+        const auto fits = length <= sso;
+
+        // construction and copy.
+        const auto constructed = make_string(text);
+        XED_CHECK_STRING(constructed, text, fits);
+        const string copied(constructed);
+        XED_CHECK_STRING(copied, text, fits);
+
+        // move leaves an empty inline string behind.
+        {
+            auto from = make_string(text);
+            string to(xed::move(from));
+            XED_CHECK_STRING(to, text, fits);
+            XED_CHECK_STRING(from, reference_string<CharType>(), true);
+
+            string assigned;
+            assigned = xed::move(to);
+            XED_CHECK_STRING(assigned, text, fits);
+            XED_CHECK_STRING(to, reference_string<CharType>(), true);
+        }
+
+        // swap with every other length, inline and heap both ways.
+        for (const auto other_length : lengths) {
+            const auto other_text = make_text<CharType>(other_length, 3);
+            auto a = make_string(text);
+            auto b = make_string(other_text);
+            a.swap(b);
+            XED_CHECK_STRING(a, other_text, other_length <= sso);
+            XED_CHECK_STRING(b, text, fits);
+        }
+
+        // reserve past the inline buffer moves to the heap, smaller is a no-op.
+        {
+            auto s = make_string(text);
+            s.reserve(length / 2);
+            XED_CHECK_STRING(s, text, fits);
+            s.reserve(length + sso + 2);
+            XED_CHECK_STRING(s, text, false);
+            XED_CHECK(s.capacity() >= length + sso + 2);
+        }
+
+        // shrink_to_fit comes back inline when the characters fit there.
+        {
+            auto s = make_string(text);
+            s.reserve(length + sso + 2);
+            s.shrink_to_fit();
+            XED_CHECK_STRING(s, text, fits);
+            if (!fits)
+                XED_CHECK(s.capacity() == length + 1);
+        }
+
+        // appends across the boundary, by view, by character and by concat.
+        {
+            const auto tail = make_text<CharType>(2, 5);
+            auto s = make_string(text);
+            s += view(tail);
+            XED_CHECK_STRING(s, text + tail, length + 2 <= sso);
+
+            auto c = make_string(text);
+            c += static_cast<CharType>('!');
+            XED_CHECK_STRING(c, text + static_cast<CharType>('!'), length + 1 <= sso);
+
+            auto concat = make_string(text);
+            concat += make_string(tail) + view(tail);
+            XED_CHECK_STRING(concat, text + tail + tail, length + 4 <= sso);
+        }
+
+        // appending the string, or a piece of it, to itself.
+        {
+            auto s = make_string(text);
+            s += s;
+            XED_CHECK_STRING(s, text + text, 2 * length <= sso);
+
+            auto piece = make_string(text);
+            piece += xed::basic_string_view<CharType>(piece.data() + length / 2, length - length / 2);
+            XED_CHECK_STRING(piece, text + text.substr(length / 2), length + (length - length / 2) <= sso);
+
+            auto concat = make_string(text);
+            concat += concat + view(text) + concat;
+            XED_CHECK_STRING(concat, text + text + text + text, 4 * length <= sso);
+        }
+
+        // erase and pop_back keep the buffer, shrink_to_fit gives it back.
+        if (length != 0) {
+            auto s = make_string(text);
+            s.pop_back();
+            XED_CHECK_STRING(s, text.substr(0, length - 1), fits);
+
+            auto e = make_string(text);
+            e.erase(0, length - length / 3);
+            XED_CHECK_STRING(e, text.substr(length - length / 3), fits);
+            e.shrink_to_fit();
+            XED_CHECK_STRING(e, text.substr(length - length / 3), length / 3 <= sso);
+        }
+
+        // a heap string erased down to this length.
+        if (length < 4 * sso) {
+            auto s = make_string(make_text<CharType>(4 * sso));
+            s.erase(length, 4 * sso - length);
+            XED_CHECK_STRING(s, text, false);
+            while (s.length() != 0) {
+                s.pop_back();
+                XED_CHECK(s.data()[s.length()] == 0);
+            }
+            s.shrink_to_fit();
+            XED_CHECK_STRING(s, reference_string<CharType>(), true);
+        }
+    }
+
+    // growing one character at a time through the boundary and back.
+    {
+        string s;
+        reference_string<CharType> expected;
+        for (std::size_t i = 0; i < sso + 3; i++) {
+            s += static_cast<CharType>('a' + i % 26);
+            expected.push_back(static_cast<CharType>('a' + i % 26));
+            XED_CHECK_STRING(s, expected, i + 1 <= sso);
+        }
+        while (expected.size() != 0) {
+            s.pop_back();
+            expected.pop_back();
+            XED_CHECK_STRING(s, expected, false);
+        }
+    }
+}
+
+// what replace_all should give, from copies of `from` and `to`.
+template<typename CharType>
+reference_string<CharType> replaced(reference_string<CharType> text, const reference_string<CharType>& from, const reference_string<CharType>& to) {
+    for (auto pos = text.find(from); pos != reference_string<CharType>::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+    return text;
+}
+
+// replace_all and the other edits with arguments that point into the string itself.
+template<typename CharType>
+void test_aliasing() {
+    using string = xed::basic_string<CharType>;
+    using string_view = xed::basic_string_view<CharType>;
+    constexpr auto sso = string::sso_capacity;
+    const std::size_t lengths[] = { 2, sso - 1, sso + 1, 4 * sso + 7 };
+
+    for (const auto length : lengths) {
+        // a few characters that repeat, so `from` matches more than once.
+        reference_string<CharType> text;
+        for (std::size_t i = 0; i < length; i++)
+            text.push_back(static_cast<CharType>('a' + i % 3));
+
+        for (std::size_t from_at = 0; from_at + 1 <= length && from_at < 3; from_at++) {
+            for (std::size_t from_length = 1; from_length <= 2 && from_at + from_length <= length; from_length++) {
+                for (std::size_t to_length = 0; to_length <= length && to_length <= 5; to_length++) {
+                    const auto from = text.substr(from_at, from_length);
+                    const auto to = text.substr(0, to_length);
+                    const auto expected = replaced(text, from, to);
+
+                    // reallocating, and in place with room to spare.
+                    for (int spare = 0; spare < 2; spare++) {
+                        auto s = make_string(text);
+                        if (spare != 0)
+                            s.reserve(4 * expected.size() + 1);
+                        s.replace_all(string_view(s.data() + from_at, from_length), string_view(s.data(), to_length));
+                        XED_CHECK_CONTENTS(s, expected);
+                    }
+                }
+            }
+        }
+
+        // the same for a single replace and insert.
+        {
+            auto s = make_string(text);
+            s.replace(string_view(s.data() + 1, 1), string_view(s.data(), length));
+            auto expected = text;
+            expected.replace(expected.find(text.substr(1, 1)), 1, text);
+            XED_CHECK_CONTENTS(s, expected);
+
+            auto i = make_string(text);
+            i.insert(1, string_view(i.data(), length));
+            XED_CHECK_CONTENTS(i, text.substr(0, 1) + text + text.substr(1));
+        }
+    }
+
+    // the case from the report.
+    {
+        auto s = make_string(make_text<CharType>(2));
+        s.replace_all(string_view(s.data() + 1, 1), string_view(s.data(), 2));
+        XED_CHECK_CONTENTS(s, make_text<CharType>(1) + make_text<CharType>(2));
+    }
+}
+
+// the overloads that take a single character.
+template<typename CharType>
+void test_characters() {
+    using string = xed::basic_string<CharType>;
+    constexpr auto sso = string::sso_capacity;
+    const std::size_t lengths[] = { 0, sso - 1, sso, 4 * sso + 7 };
+    const auto a = static_cast<CharType>('a');
+    const auto x = static_cast<CharType>('X');
+
+    for (const auto length : lengths) {
+        const auto text = make_text<CharType>(length);
+
+        auto replaced = make_string(text);
+        replaced.replace_all(a, x);
+        auto expected = text;
+        for (auto& ch : expected) {
+            if (ch == a)
+                ch = x;
+        }
+        XED_CHECK_CONTENTS(replaced, expected);
+
+        auto back = make_string(text);
+        back.push_back(x);
+        XED_CHECK_STRING(back, text + x, length + 1 <= sso);
+
+        auto front = make_string(text);
+        front.push_front(x);
+        XED_CHECK_STRING(front, x + text, length + 1 <= sso);
+
+        auto inserted = make_string(text);
+        inserted.insert(length / 2, x);
+        XED_CHECK_STRING(inserted, text.substr(0, length / 2) + x + text.substr(length / 2), length + 1 <= sso);
+    }
+}
+
+// an arena string appended to a character at a time grows in place while its chunk has
+// room, so the arena hands out well under twice the final capacity.
+void test_arena() {
+    for (const std::size_t count : { 1000, 100000, 800000 }) {
+        xed::monotonic_arena arena;
+        xed::arena_string s{ xed::arena_allocator<char>(arena) };
+        reference_string<char> expected;
+        for (std::size_t i = 0; i < count; i++) {
+            s += static_cast<char>('a' + i % 26);
+            expected.push_back(static_cast<char>('a' + i % 26));
+        }
+        XED_CHECK(s.length() == expected.size());
+        XED_CHECK(reference_string<char>(s.data(), s.length()) == expected);
+        XED_CHECK(s.data()[s.length()] == 0);
+        XED_CHECK(arena.bytes_allocated() < 2 * s.capacity());
+    }
+}
+
+} // namespace
+
+int main() {
+    test_lengths<char>();
+    test_lengths<char16_t>();
+    test_lengths<char32_t>();
+    test_aliasing<char>();
+    test_aliasing<char16_t>();
+    test_aliasing<char32_t>();
+    test_characters<char>();
+    test_characters<char16_t>();
+    test_characters<char32_t>();
+    test_arena();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
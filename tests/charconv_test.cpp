@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include "charconv.hpp"
+
+// append_int/append_float against parse_int/parse_float, the bases parse_int takes and
+// the ones it turns down.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+template<typename Int>
+void round_trip(Int value) {
+    xed::string text;
+    xed::append_int(text, value);
+    Int parsed = 0;
+    const auto result = xed::parse_int(xed::string_view(text), parsed);
+    XED_CHECK(result);
+    XED_CHECK(result.length == text.length());
+    XED_CHECK(parsed == value);
+}
+
+void test_ints() {
+    round_trip<std::int64_t>(0);
+    round_trip(std::numeric_limits<std::int64_t>::min());
+    round_trip(std::numeric_limits<std::int64_t>::max());
+    round_trip(std::numeric_limits<std::uint64_t>::max());
+    round_trip(std::numeric_limits<std::int8_t>::min());
+
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (int i = 0; i < 10000; i++) {
+        const auto bits = next(seed);
+        round_trip(static_cast<std::int64_t>(bits >> (bits % 64)));
+        round_trip(static_cast<std::int32_t>(bits));
+        round_trip(static_cast<std::uint16_t>(bits));
+    }
+
+    // one past the range is out_of_range, not a wrapped value.
+    std::int8_t small = 7;
+    XED_CHECK(xed::parse_int(xed::string_view("128", 3), small).error == xed::parse_error::out_of_range);
+    XED_CHECK(small == 7);
+    XED_CHECK(xed::parse_int(xed::string_view("-128", 4), small) && small == -128);
+}
+
+void test_bases() {
+    std::int64_t value = 0;
+    XED_CHECK(xed::parse_int(xed::string_view("ff", 2), value, 16) && value == 255);
+    XED_CHECK(xed::parse_int(xed::string_view("-101", 4), value, 2) && value == -5);
+    XED_CHECK(xed::parse_int(xed::string_view("zZ", 2), value, 36) && value == 35 * 36 + 35);
+    // digits past the base end the number.
+    const auto partial = xed::parse_int(xed::string_view("129", 3), value, 8);
+    XED_CHECK(partial && partial.length == 2 && value == 10);
+
+    const unsigned bad_bases[] = { 0, 1, 37, 100 };
+    for (const auto base : bad_bases) {
+        value = 42;
+        const auto result = xed::parse_int(xed::string_view("zz", 2), value, base);
+        XED_CHECK(result.error == xed::parse_error::invalid);
+        XED_CHECK(result.length == 0);
+        XED_CHECK(value == 42);
+
+        const auto zero = xed::parse_int(xed::string_view("0", 1), value, base);
+        XED_CHECK(zero.error == xed::parse_error::invalid);
+        XED_CHECK(value == 42);
+    }
+}
+
+void test_floats() {
+    std::uint64_t seed = 0x2545f4914f6cdd1dull;
+    for (int i = 0; i < 10000; i++) {
+        auto bits = next(seed);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value != value)
+            continue;
+
+        xed::string text;
+        xed::append_float(text, value);
+        double parsed = 0;
+        const auto result = xed::parse_float(xed::string_view(text), parsed);
+        XED_CHECK(result);
+        XED_CHECK(result.length == text.length());
+        XED_CHECK(parsed == value);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_ints();
+    test_bases();
+    test_floats();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include "flat_string_map.hpp"
+
+// basic_flat_string_map against std::unordered_map under random inserts, assignments,
+// erases and lookups: after every operation the result it returned, and every so often
+// the size and the whole contents by iteration. once with the real hash and once with
+// hashes that collide on purpose, so probes go over many groups and erases leave
+// tombstones behind. copies, moves, clear and reserve on top.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+// keeps `bits` bits of the real hash, the low 7 go into the tags and the rest pick the
+// group a probe starts at. 0 is the same hash for every key.
+template<unsigned bits>
+struct weak_hash {
+    inline std::uint64_t operator()(xed::string_view str) const noexcept {
+        if constexpr (bits == 0)
+            return 0;
+        else
+            return xed::hash_string(str) & ((std::uint64_t(1) << bits) - 1);
+    }
+};
+
+using string_map = xed::flat_string_map<std::string>;
+template<unsigned bits>
+using weak_map = xed::basic_flat_string_map<std::string, char, xed::allocator<char>, weak_hash<bits>>;
+using reference_map = std::unordered_map<std::string, std::string>;
+
+// key number `n`, some short enough to stay inline and some not.
+std::string make_key(std::uint64_t n) {
+    auto key = std::to_string(n);
+    if (n % 3 == 0)
+        key += "-a-key-that-is-too-long-for-the-inline-buffer";
+    return key;
+}
+
+template<typename Map>
+void check_contents(const Map& map, const reference_map& expected, int line) {
+    bool same = map.size() == expected.size();
+    std::size_t visited = 0;
+    for (const auto& e : map) {
+        const auto found = expected.find(std::string(e.key.data(), e.key.length()));
+        same = same && found != expected.end() && found->second == e.value;
+        visited++;
+    }
+    if (!same || visited != expected.size()) {
+        std::fprintf(stderr, "%s:%d: failed: %zu entries, %zu visited, %zu expected\n", __FILE__, line, map.size(), visited, expected.size());
+        failures++;
+    }
+}
+
+#define XED_CHECK_MAP(map, expected) check_contents((map), (expected), __LINE__)
+
+template<typename Map>
+void test_random(std::size_t key_count, std::size_t operations) {
+    Map map;
+    reference_map expected;
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull + key_count;
+
+    for (std::size_t i = 0; i < operations; i++) {
+        // half the time a key that is likely there, so hits and misses both happen.
+        const auto key = make_key(next(seed) % key_count);
+        const xed::string_view view(key.data(), key.size());
+        const auto value = std::to_string(i);
+
+        switch (next(seed) % 6) {
+        case 0: {
+            const auto inserted = map.insert(view, value);
+            XED_CHECK(inserted == expected.emplace(key, value).second);
+            break;
+        }
+        case 1:
+            // an rvalue key, which is moved into the map.
+            XED_CHECK(map.insert_or_assign(xed::string(key.data(), key.size()), value) == value);
+            expected.insert_or_assign(key, value);
+            break;
+        case 2:
+            map[view] += "x";
+            expected[key] += "x";
+            break;
+        case 3:
+        case 4:
+            XED_CHECK(map.erase(view) == (expected.erase(key) != 0));
+            break;
+        default: {
+            const auto found = map.find(view);
+            const auto reference = expected.find(key);
+            XED_CHECK((found != nullptr) == (reference != expected.end()));
+            XED_CHECK(map.contains(view) == (reference != expected.end()));
+            if (found != nullptr && reference != expected.end())
+                XED_CHECK(*found == reference->second);
+            break;
+        }
+        }
+
+        XED_CHECK(map.size() == expected.size());
+        if (i % 997 == 0)
+            XED_CHECK_MAP(map, expected);
+    }
+    XED_CHECK_MAP(map, expected);
+
+    // every key there is still found and every one erased is not.
+    for (std::size_t n = 0; n < key_count; n++) {
+        const auto key = make_key(n);
+        const auto found = map.find(xed::string_view(key.data(), key.size()));
+        const auto reference = expected.find(key);
+        XED_CHECK((found != nullptr) == (reference != expected.end()));
+    }
+
+    // copies and moves take everything along.
+    const Map copied(map);
+    XED_CHECK_MAP(copied, expected);
+    Map assigned;
+    assigned = copied;
+    XED_CHECK_MAP(assigned, expected);
+    Map moved(xed::move(assigned));
+    XED_CHECK_MAP(moved, expected);
+    XED_CHECK(assigned.size() == 0);
+
+    // erasing everything, in a different order than it went in.
+    for (std::size_t n = key_count; n-- != 0;) {
+        const auto key = make_key(n);
+        XED_CHECK(moved.erase(xed::string_view(key.data(), key.size())) == (expected.erase(key) != 0));
+    }
+    XED_CHECK(moved.is_empty());
+    XED_CHECK_MAP(moved, expected);
+
+    map.clear();
+    XED_CHECK(map.size() == 0);
+    XED_CHECK(map.begin() == map.end());
+    XED_CHECK(map.find(xed::string_view("0", 1)) == nullptr);
+}
+
+// reserve makes room up front, nothing after it rehashes until the count is reached.
+void test_reserve() {
+    xed::flat_string_map<std::string> map;
+    map.reserve(1000);
+    const auto capacity = map.capacity();
+    XED_CHECK(capacity * 7 / 8 >= 1000);
+    for (std::uint64_t n = 0; n < 1000; n++) {
+        const auto key = make_key(n);
+        XED_CHECK(map.insert(xed::string_view(key.data(), key.size()), key));
+    }
+    XED_CHECK(map.capacity() == capacity);
+    XED_CHECK(map.size() == 1000);
+}
+
+} // namespace
+
+int main() {
+    test_random<string_map>(100, 20000);
+    test_random<string_map>(5000, 100000);
+    // a handful of start groups, and then one for everything with the same tag.
+    test_random<weak_map<10>>(2000, 40000);
+    test_random<weak_map<0>>(300, 10000);
+    test_reserve();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
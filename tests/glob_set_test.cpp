@@ -0,0 +1,164 @@
+#include <fnmatch.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "glob_set.hpp"
+
+// basic_glob_set against fnmatch without flags, pattern by pattern: random sets of
+// patterns made of stars, question marks, sets, ranges, escapes and plain characters,
+// matched against random strings, for char, char16_t and char32_t with the same
+// patterns. a few cases of characters past ascii and the empty set on top.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+template<typename CharType>
+std::basic_string<CharType> widen(const std::string& str) {
+    return std::basic_string<CharType>(str.begin(), str.end());
+}
+
+// glibc reads a '[' without a ']' after it differently from the other ones, and from
+// glob_set, which takes it as a plain '['. sets with those get left out.
+bool has_open_set(const std::string& pattern) {
+    const auto open = pattern.rfind('[');
+    return open != std::string::npos && pattern.find(']', open + 1) == std::string::npos;
+}
+
+// every pattern in `patterns` that fnmatch matches `text` with, in order.
+std::vector<std::size_t> expected_matches(const std::vector<std::string>& patterns, const std::string& text) {
+    std::vector<std::size_t> matched;
+    for (std::size_t p = 0; p < patterns.size(); p++) {
+        if (fnmatch(patterns[p].c_str(), text.c_str(), 0) == 0)
+            matched.push_back(p);
+    }
+    return matched;
+}
+
+template<typename CharType>
+void check_set(const std::vector<std::string>& patterns, const std::vector<std::string>& texts) {
+    using string_view = xed::basic_string_view<CharType>;
+
+    std::vector<std::basic_string<CharType>> wide_patterns;
+    std::vector<string_view> views;
+    for (const auto& p : patterns)
+        wide_patterns.push_back(widen<CharType>(p));
+    for (const auto& p : wide_patterns)
+        views.emplace_back(p.data(), p.size());
+    const xed::basic_glob_set<CharType> set(views.data(), views.size());
+    XED_CHECK(set.pattern_count() == patterns.size());
+
+    for (const auto& text : texts) {
+        const auto expected = expected_matches(patterns, text);
+        const auto wide_text = widen<CharType>(text);
+        const string_view view(wide_text.data(), wide_text.size());
+
+        std::vector<std::size_t> found;
+        XED_CHECK(set.for_each_match(view, [&](std::size_t p) { found.push_back(p); }));
+        if (found != expected) {
+            std::fprintf(stderr, "%s:%d: failed: \"%s\" matched %zu patterns instead of %zu (char size %zu)\n",
+                __FILE__, __LINE__, text.c_str(), found.size(), expected.size(), sizeof(CharType));
+            for (std::size_t p = 0; p < patterns.size(); p++)
+                std::fprintf(stderr, "    %zu: \"%s\"\n", p, patterns[p].c_str());
+            failures++;
+        }
+
+        XED_CHECK(set.matches(view) == !expected.empty());
+        XED_CHECK(set.count(view) == expected.size());
+        XED_CHECK(set.find_first(view) == (expected.empty() ? npos : expected[0]));
+
+        // returning false stops it after the first one.
+        if (expected.size() > 1) {
+            std::size_t calls = 0;
+            XED_CHECK(!set.for_each_match(view, [&](std::size_t) { return ++calls != 1; }));
+            XED_CHECK(calls == 1);
+        }
+    }
+}
+
+template<typename CharType>
+void test_random() {
+    // the pattern characters show up in the texts too, so they get matched literally.
+    constexpr char pattern_alphabet[] = "ab/c*?[]!-\\";
+    constexpr char text_alphabet[] = "abc/-]![";
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+
+    for (int round = 0; round < 1000; round++) {
+        std::vector<std::string> patterns;
+        for (auto count = 1 + next(seed) % 12; count != 0; count--) {
+            std::string p;
+            for (auto length = next(seed) % 9; length != 0; length--)
+                p.push_back(pattern_alphabet[next(seed) % (sizeof(pattern_alphabet) - 1)]);
+            if (!has_open_set(p))
+                patterns.push_back(p);
+        }
+
+        std::vector<std::string> texts;
+        for (int t = 0; t < 40; t++) {
+            std::string text;
+            for (auto length = next(seed) % 10; length != 0; length--)
+                text.push_back(text_alphabet[next(seed) % (sizeof(text_alphabet) - 1)]);
+            texts.push_back(text);
+        }
+        check_set<CharType>(patterns, texts);
+    }
+}
+
+void test_cases() {
+    check_set<char>({ "/static/*.css", "/api/v[0-9]/users/*", "*.php", "*" },
+        { "", "/static/site.css", "/static/css", "/api/v2/users/7", "/api/vx/users/7", "/index.php", "x" });
+    check_set<char>({ "a*b*c*d", "*a*a*a*", "[!a-c]??", "\\*", "[]]", "[!]]" }, { "abcd", "aXbXcXd", "aaa", "baaab", "dxy", "*", "]", "x" });
+
+    // characters past what a byte holds, in sets, ranges and under a question mark.
+    {
+        const xed::u32glob_set set({ U"\U0001F600*", U"[à-ÿ]?x", U"[!a]" });
+        const std::u32string smiley = U"\U0001F600abc", accent = U"é\U0001F600x", other = U"一";
+        XED_CHECK(set.find_first({ smiley.data(), smiley.size() }) == 0);
+        XED_CHECK(set.find_first({ accent.data(), accent.size() }) == 1);
+        XED_CHECK(set.find_first({ other.data(), other.size() }) == 2);
+        XED_CHECK(!set.matches({ U"a", 1 }));
+    }
+    {
+        const xed::u16glob_set set({ u"*.é", u"[Ā-ǿ]" });
+        XED_CHECK(set.find_first({ u"caf.é", 5 }) == 0);
+        XED_CHECK(set.find_first({ u"Ő", 1 }) == 1);
+        XED_CHECK(!set.matches({ u"ɐ", 1 }));
+    }
+
+    // no patterns, nothing matches, not even the empty string.
+    const xed::glob_set empty(nullptr, 0);
+    XED_CHECK(!empty.matches(xed::string_view("", 0)));
+    XED_CHECK(!empty.matches(xed::string_view("x", 1)));
+    XED_CHECK(empty.find_first(xed::string_view("x", 1)) == npos);
+}
+
+} // namespace
+
+int main() {
+    test_random<char>();
+    test_random<char16_t>();
+    test_random<char32_t>();
+    test_cases();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
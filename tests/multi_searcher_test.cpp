@@ -0,0 +1,205 @@
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "multi_searcher.hpp"
+
+// basic_multi_searcher against a find of every pattern at every position: the matches
+// for_each_match reports and their order, find, count and stopping early. small sets of
+// bytes go through the simd fingerprint and bigger sets and wider characters through
+// the automaton, the test checks which one each set got and that both ran.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+// how many sets went through each path.
+std::size_t fingerprint_sets = 0;
+std::size_t automaton_sets = 0;
+
+struct match {
+    std::size_t end;
+    std::size_t pattern;
+
+    bool operator==(const match&) const = default;
+};
+
+template<typename CharType>
+void check_search(const std::vector<std::basic_string<CharType>>& patterns, const std::basic_string<CharType>& text) {
+    using string_view = xed::basic_string_view<CharType>;
+
+    std::vector<string_view> views;
+    for (const auto& p : patterns)
+        views.emplace_back(p.data(), p.size());
+    const xed::basic_multi_searcher<CharType> searcher(views.data(), views.size());
+
+#if XED_HAS_SIMD_BLOCK
+    XED_CHECK(searcher.uses_fingerprint() == (sizeof(CharType) == 1 && patterns.size() <= xed::details::multi_fingerprint::max_patterns));
+#else
+    XED_CHECK(!searcher.uses_fingerprint());
+#endif
+    (searcher.uses_fingerprint() ? fingerprint_sets : automaton_sets)++;
+
+    // by end and then by pattern, the order the searcher reports them in.
+    std::vector<match> expected;
+    for (std::size_t end = 1; end <= text.size(); end++) {
+        for (std::size_t p = 0; p < patterns.size(); p++) {
+            const auto length = patterns[p].size();
+            if (length != 0 && length <= end && text.compare(end - length, length, patterns[p]) == 0)
+                expected.push_back({ end, p });
+        }
+    }
+
+    const string_view view(text.data(), text.size());
+    std::vector<match> found;
+    XED_CHECK(searcher.for_each_match(view, [&](const xed::multi_match& m) {
+        XED_CHECK(m.length_ == patterns[m.pattern_].size());
+        found.push_back({ m.position_ + m.length_, m.pattern_ });
+    }));
+    if (found != expected) {
+        std::fprintf(stderr, "%s:%d: failed: %zu matches instead of %zu (char size %zu, %zu patterns, text length %zu)\n",
+            __FILE__, __LINE__, found.size(), expected.size(), sizeof(CharType), patterns.size(), text.size());
+        failures++;
+    }
+
+    XED_CHECK(searcher.count(view) == expected.size());
+    XED_CHECK(searcher.contains_any(view) == !expected.empty());
+    const auto first = searcher.find(view);
+    if (expected.empty()) {
+        XED_CHECK(first.position_ == npos);
+    }
+    else {
+        XED_CHECK(first.pattern_ == expected[0].pattern);
+        XED_CHECK(first.position_ + first.length_ == expected[0].end);
+    }
+
+    // returning false stops it after that match.
+    if (expected.size() > 1) {
+        std::size_t calls = 0;
+        XED_CHECK(!searcher.for_each_match(view, [&](const xed::multi_match&) { return ++calls != 2; }));
+        XED_CHECK(calls == 2);
+    }
+}
+
+// `count` patterns of up to 7 characters, and a text of `length` from the same
+// characters and one more, so there are matches, misses and near misses.
+template<typename CharType>
+void check_random(std::size_t count, std::size_t length, std::uint64_t& seed) {
+    using reference_string = std::basic_string<CharType>;
+    // a few characters, spread over the whole width so wide ones differ in every byte.
+    const auto alphabet = 2 + next(seed) % 4;
+    const auto character = [&](std::uint64_t i) {
+        return static_cast<CharType>(sizeof(CharType) == 1 ? 'a' + i : 0x0101 * (i + 1));
+    };
+
+    std::vector<reference_string> patterns;
+    for (std::size_t i = 0; i < count; i++) {
+        reference_string p;
+        for (auto n = next(seed) % 8; n != 0; n--)
+            p.push_back(character(next(seed) % alphabet));
+        patterns.push_back(p);
+    }
+    // the same pattern twice.
+    if (count > 1 && next(seed) % 4 == 0)
+        patterns.back() = patterns.front();
+
+    reference_string text;
+    for (std::size_t i = 0; i < length; i++)
+        text.push_back(character(next(seed) % (alphabet + 1)));
+    check_search(patterns, text);
+}
+
+template<typename CharType>
+void test_random() {
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    // around the most the fingerprint takes, 8 or 32, and well past it.
+    const std::size_t counts[] = { 1, 2, 5, 8, 9, 31, 32, 33, 100, 300 };
+    // shorter than a simd block, a few blocks with a tail, and a long one.
+    const std::size_t lengths[] = { 0, 1, 7, 31, 100, 4099 };
+    for (const auto count : counts) {
+        for (const auto length : lengths) {
+            for (int round = 0; round < 4; round++)
+                check_random<CharType>(count, length, seed);
+        }
+    }
+}
+
+void test_cases() {
+    using strings = std::vector<std::string>;
+    check_search<char>({ "he", "she", "his", "hers" }, "ushers and his sheep");
+    // top bit bytes and zeros.
+    check_search<char>({ std::string("\xff\x80", 2), std::string("\0a", 2), "a" }, std::string("x\xff\x80\0a\xff\x80 a", 9));
+    check_search<char>({}, "anything");
+    check_search<char>({ "", "" }, "anything");
+    check_search<char>({ "needle" }, "");
+
+    // a dictionary of words, many of them inside others.
+    strings words;
+    for (int i = 0; i < 500; i++)
+        words.push_back("word" + std::to_string(i * 7919 % 1000));
+    std::string text;
+    std::uint64_t seed = 0x2545f4914f6cdd1dull;
+    for (int i = 0; i < 2000; i++)
+        text += "word" + std::to_string(next(seed) % 1200) + " ";
+    check_search<char>(words, text);
+
+    // in wider characters a match has to start on a character, the bytes of 0x0101 also
+    // turn up across the middle of two of them.
+    check_search<char16_t>({ std::u16string(1, 0x0101), std::u16string{ 0x0001, 0x0100 } }, std::u16string{ 0x0101, 0x0101, 0x0001, 0x0100 });
+}
+
+// the automaton stores states times the row length in 32 bits, patterns that could need
+// more get a length_error before anything is built.
+void test_too_many_states() {
+    std::string bytes(1 << 20, '\0');
+    for (std::size_t i = 0; i < bytes.size(); i++)
+        bytes[i] = static_cast<char>(i * 7);
+    const xed::string_view p(bytes.data(), bytes.size());
+    // 256 classes and 40 times 2^20 states is past 2^32.
+    std::vector<xed::string_view> patterns(40, p);
+    bool thrown = false;
+    try {
+        const xed::multi_searcher searcher(patterns.data(), patterns.size());
+    }
+    catch (const std::length_error&) {
+        thrown = true;
+    }
+    XED_CHECK(thrown);
+}
+
+} // namespace
+
+int main() {
+    test_random<char>();
+    test_random<char16_t>();
+    test_random<char32_t>();
+    test_cases();
+    test_too_many_states();
+
+#if XED_HAS_SIMD_BLOCK
+    XED_CHECK(fingerprint_sets != 0);
+#endif
+    XED_CHECK(automaton_sets != 0);
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parallel_search.hpp"
+
+// parallel_find, parallel_find_all and parallel_count against one thread going left to
+// right, on text of a few chunks: matches planted across every chunk boundary at every
+// offset, periodic text where the non overlapping matches of one chunk run into the next,
+// random text with lots of matches, needles longer than a chunk, and inputs too small
+// to split. each on 1, 2, 3 and the default number of threads.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+constexpr std::size_t chunk = xed::details::parallel_search_chunk;
+
+// every non overlapping match, left to right, with std::basic_string_view.
+template<typename CharType>
+std::vector<std::size_t> expected_matches(const std::basic_string<CharType>& text, const std::basic_string<CharType>& needle) {
+    const std::basic_string_view<CharType> view(text);
+    std::vector<std::size_t> matches;
+    for (auto pos = view.find(needle); pos != view.npos; pos = view.find(needle, pos + needle.size()))
+        matches.push_back(pos);
+    return matches;
+}
+
+template<typename CharType>
+void check_search(const std::basic_string<CharType>& text, const std::basic_string<CharType>& needle, int line) {
+    using string_view = xed::basic_string_view<CharType>;
+    const string_view text_view(text.data(), text.size());
+    const string_view needle_view(needle.data(), needle.size());
+
+    const auto expected = expected_matches(text, needle);
+    const auto first = expected.empty() ? npos : expected[0];
+    // what one thread gets with string_view, which the parallel ones have to match.
+    const auto single_find = text_view.find(needle_view);
+    const auto single_count = text_view.count(needle_view);
+    if (single_find != first || single_count != expected.size()) {
+        std::fprintf(stderr, "%s:%d: failed: string_view found %zu and counted %zu, expected %zu and %zu\n",
+            __FILE__, line, single_find, single_count, first, expected.size());
+        failures++;
+    }
+
+    for (const unsigned threads : { 1u, 2u, 3u, 0u }) {
+        const auto found = xed::parallel_find(text_view, needle_view, threads);
+        const auto counted = xed::parallel_count(text_view, needle_view, threads);
+        const auto all = xed::parallel_find_all(text_view, needle_view, threads);
+        const bool same_all = all.length() == expected.size() && std::equal(all.begin(), all.end(), expected.begin());
+        if (found != single_find || counted != single_count || !same_all) {
+            std::fprintf(stderr, "%s:%d: failed: found %zu, counted %zu and listed %zu, expected %zu, %zu and %zu (char size %zu, needle length %zu, threads %u)\n",
+                __FILE__, line, found, counted, all.length(), single_find, single_count, expected.size(), sizeof(CharType), needle.size(), threads);
+            failures++;
+        }
+    }
+}
+
+#define XED_CHECK_SEARCH(text, needle) check_search((text), (needle), __LINE__)
+
+// a needle in nothing but 'x', planted so it starts `offset` characters before each
+// chunk boundary, with one at the very start and one at the very end too.
+void test_boundaries() {
+    const std::string needle = "needle";
+    for (std::size_t offset = 0; offset <= needle.size(); offset++) {
+        std::string text(3 * chunk + 1000, 'x');
+        text.replace(0, needle.size(), needle);
+        for (std::size_t boundary = chunk; boundary < text.size(); boundary += chunk)
+            text.replace(boundary - offset, needle.size(), needle);
+        text.replace(text.size() - needle.size(), needle.size(), needle);
+        XED_CHECK_SEARCH(text, needle);
+
+        // only the one across the last boundary, so find has to wait for that chunk.
+        std::string one(3 * chunk + 1000, 'x');
+        one.replace(3 * chunk - offset, needle.size(), needle);
+        XED_CHECK_SEARCH(one, needle);
+    }
+
+    // single characters, which count without looking across boundaries.
+    std::string text(2 * chunk + 3, 'x');
+    text[chunk - 1] = text[chunk] = text[2 * chunk] = 'y';
+    XED_CHECK_SEARCH(text, std::string("y"));
+    XED_CHECK_SEARCH(text, std::string("z"));
+}
+
+// in one character repeated, or a short period, where a match starts decides where the
+// next one can, so a chunk's own matches only count once they line up with the ones
+// before it. a few characters in front move the boundaries through every phase of the
+// period.
+void test_periodic() {
+    for (std::size_t shift = 0; shift < 5; shift++) {
+        const auto same = std::string(shift, 'x') + std::string(2 * chunk + 1, 'a');
+        XED_CHECK_SEARCH(same, std::string("aa"));
+        XED_CHECK_SEARCH(same, std::string("aaa"));
+        XED_CHECK_SEARCH(same, std::string(100, 'a'));
+
+        std::string period(shift, 'x');
+        while (period.size() < 3 * chunk)
+            period += "abcab";
+        XED_CHECK_SEARCH(period, std::string("abcab"));
+        XED_CHECK_SEARCH(period, std::string("cabab"));
+        XED_CHECK_SEARCH(period, std::string("bcabca"));
+        XED_CHECK_SEARCH(period, std::string("ab"));
+    }
+
+    // periodic up to a point and then not, so the chunks line up somewhere in the middle.
+    std::string mixed(3 * chunk, 'a');
+    for (std::size_t i = chunk + chunk / 2; i < mixed.size(); i += 5)
+        mixed[i] = 'b';
+    XED_CHECK_SEARCH(mixed, std::string("aaa"));
+}
+
+// a few characters at random, lots of matches everywhere, and no match at all.
+void test_random() {
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    std::string text;
+    for (std::size_t i = 0; i < 3 * chunk + 12345; i++)
+        text.push_back(static_cast<char>('a' + next(seed) % 3));
+    for (const auto needle : { "a", "ab", "abc", "aaaa", "cabbage" })
+        XED_CHECK_SEARCH(text, std::string(needle));
+    XED_CHECK_SEARCH(text, std::string("d"));
+    XED_CHECK_SEARCH(text, std::string("abcd"));
+
+    // wider characters, with a needle across a boundary.
+    std::u16string wide(2 * chunk + 100, u'ā');
+    wide.replace(chunk - 2, 4, u"ĂăĂă");
+    XED_CHECK_SEARCH(wide, std::u16string(u"Ăă"));
+    XED_CHECK_SEARCH(wide, std::u16string(u"āĂăĂ"));
+}
+
+// a needle longer than a chunk, an empty one, and text too small to be split.
+void test_edges() {
+    std::string text(3 * chunk, 'x');
+    std::string needle(chunk + 12, 'x');
+    needle.front() = needle.back() = 'y';
+    text.replace(chunk - 5, needle.size(), needle);
+    XED_CHECK_SEARCH(text, needle);
+    // twice back to back, each running over a boundary.
+    XED_CHECK_SEARCH(std::string(3 * chunk, 'x'), std::string(chunk + 100, 'x'));
+
+    XED_CHECK(xed::parallel_find(xed::string_view(text.data(), text.size()), xed::string_view("", 0), 2) == xed::string_view(text.data(), text.size()).find(xed::string_view("", 0)));
+    XED_CHECK(xed::parallel_count(xed::string_view(text.data(), text.size()), xed::string_view("", 0), 2) == xed::string_view(text.data(), text.size()).count(xed::string_view("", 0)));
+
+    const std::string small = "a small text with a small needle";
+    XED_CHECK_SEARCH(small, std::string("small"));
+    XED_CHECK_SEARCH(std::string(), std::string("x"));
+    XED_CHECK_SEARCH(std::string(2 * chunk - 1, 'x'), std::string("xx"));
+}
+
+} // namespace
+
+int main() {
+    test_boundaries();
+    test_periodic();
+    test_random();
+    test_edges();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "sort_strings.hpp"
+
+// sort_strings against std::sort of the same keys as std::basic_string, for every
+// character size, on one thread and on several, with sizes on both sides of where the
+// sort starts making tasks. the keys come in shapes that take the different paths:
+// many duplicates, long shared prefixes that go several caches deep, characters with
+// the top bit set, zeros that look like the padding past the end of a short key, empty
+// keys and input that is already in order or reversed.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+enum class shape {
+    // short keys over a few characters, lots of them equal.
+    duplicates,
+    // a long common start and then a number, so groups stay equal for several caches.
+    prefixes,
+    // any character value, the top bit included, of any length up to 40.
+    any,
+    // zeros and ones, where a key and the same key with zeros after it share caches.
+    zeros,
+    // every key the same.
+    equal,
+    // distinct keys, already sorted and then reversed.
+    sorted,
+    reversed,
+};
+
+template<typename CharType>
+std::vector<std::basic_string<CharType>> make_keys(shape kind, std::size_t count, std::uint64_t seed) {
+    using reference_string = std::basic_string<CharType>;
+    constexpr auto max_char = static_cast<std::uint64_t>(sizeof(CharType) == 1 ? 0xff : sizeof(CharType) == 2 ? 0xffff : 0x10ffff);
+
+    std::vector<reference_string> keys;
+    for (std::size_t i = 0; i < count; i++) {
+        reference_string key;
+        switch (kind) {
+        case shape::duplicates: {
+            const auto length = next(seed) % 6;
+            for (std::size_t j = 0; j < length; j++)
+                key.push_back(static_cast<CharType>('a' + next(seed) % 3));
+            break;
+        }
+        case shape::prefixes: {
+            key.assign(8 + next(seed) % 3 * 8, static_cast<CharType>('p'));
+            auto number = next(seed) % 100000;
+            do {
+                key.push_back(static_cast<CharType>('0' + number % 10));
+                number /= 10;
+            } while (number != 0);
+            break;
+        }
+        case shape::any: {
+            const auto length = next(seed) % 41;
+            for (std::size_t j = 0; j < length; j++)
+                key.push_back(static_cast<CharType>(next(seed) % (max_char + 1)));
+            break;
+        }
+        case shape::zeros: {
+            const auto length = next(seed) % 21;
+            for (std::size_t j = 0; j < length; j++)
+                key.push_back(static_cast<CharType>(next(seed) % 4 == 0));
+            break;
+        }
+        case shape::equal:
+            key.assign(20, static_cast<CharType>('e'));
+            break;
+        case shape::sorted:
+        case shape::reversed: {
+            // fixed width digits sort the same as the numbers.
+            for (std::size_t div = 1000000; div != 0; div /= 10)
+                key.push_back(static_cast<CharType>('0' + i / div % 10));
+            break;
+        }
+        }
+        keys.push_back(key);
+    }
+    if (kind == shape::reversed)
+        std::reverse(keys.begin(), keys.end());
+    return keys;
+}
+
+template<typename CharType>
+void check_sort(shape kind, std::size_t count, unsigned threads) {
+    using reference_string = std::basic_string<CharType>;
+    const auto reference = make_keys<CharType>(kind, count, 0x9e3779b97f4a7c15ull + count);
+
+    std::vector<xed::basic_string<CharType>> keys;
+    for (const auto& key : reference)
+        keys.emplace_back(key.data(), key.size());
+
+    auto expected = reference;
+    std::sort(expected.begin(), expected.end());
+    xed::sort_strings(keys.data(), keys.data() + keys.size(), threads);
+
+    XED_CHECK(keys.size() == expected.size());
+    std::size_t wrong = 0;
+    for (std::size_t i = 0; i < keys.size() && i < expected.size(); i++)
+        wrong += reference_string(keys[i].data(), keys[i].length()) != expected[i];
+    if (wrong != 0) {
+        std::fprintf(stderr, "%s:%d: failed: %zu of %zu keys out of place (char size %zu, shape %d, threads %u)\n",
+            __FILE__, __LINE__, wrong, count, sizeof(CharType), static_cast<int>(kind), threads);
+        failures++;
+    }
+}
+
+template<typename CharType>
+void test_sort() {
+    const shape shapes[] = { shape::duplicates, shape::prefixes, shape::any, shape::zeros, shape::equal, shape::sorted, shape::reversed };
+    // the last one is past the 2 * (1 << 14) keys it takes to sort on more than one thread.
+    const std::size_t counts[] = { 0, 1, 2, 15, 17, 1000, 100000 };
+    const unsigned thread_counts[] = { 1, 2, 4, 0 };
+
+    for (const auto kind : shapes) {
+        for (const auto count : counts) {
+            for (const auto threads : thread_counts)
+                check_sort<CharType>(kind, count, threads);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_sort<char>();
+    test_sort<char16_t>();
+    test_sort<char32_t>();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <cstdio>
+#include <thread>
+#include "basic_string.hpp"
+
+// the XED_STRING_STATS counters after sequences of string operations worked out by hand:
+// appends a character at a time through the inline buffer and a few growths, a reserve,
+// copies and moves, inline strings and wide ones, and a string on another thread that
+// only the snapshot sees. this target is always built with XED_STRING_STATS on.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+// what changed on this thread while `fn` ran.
+template<typename Fn>
+xed::string_stats stats_of(Fn&& fn) {
+    const auto before = xed::thread_string_stats();
+    fn();
+    return xed::thread_string_stats() - before;
+}
+
+std::uint64_t histogram_total(const std::uint64_t* buckets, std::size_t count) {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < count; i++)
+        total += buckets[i];
+    return total;
+}
+
+// 100 characters one at a time. the capacity, terminator included, goes 24 inline,
+// then times 1.5 whenever the next character wouldn't leave room for the terminator:
+// 36 at length 23, 54 at 35, 81 at 53 and 121 at 80. every step copies what there is,
+// the whole inline buffer the first time and the characters and terminator after.
+void test_appends() {
+    XED_CHECK(xed::string::sso_capacity == 23);
+
+    const auto stats = stats_of([] {
+        xed::string s;
+        for (int i = 0; i < 100; i++)
+            s += 'a';
+        XED_CHECK(s.capacity() == 121);
+    });
+
+    XED_CHECK(stats.allocations == 4);
+    XED_CHECK(stats.allocated_bytes == 36 + 54 + 81 + 121);
+    XED_CHECK(stats.reallocations == 4);
+    XED_CHECK(stats.growths == 4);
+    XED_CHECK(stats.copied_bytes == 24 + 36 + 54 + 81);
+    // three outgrown buffers and the last one when it went away.
+    XED_CHECK(stats.deallocations == 4);
+    XED_CHECK(stats.heap_strings == 1);
+    XED_CHECK(stats.inline_strings == 0);
+    // length 100 is in [64, 128), and 100 of 120 usable is in the 80% bucket.
+    XED_CHECK(stats.length_histogram[6] == 1);
+    XED_CHECK(histogram_total(stats.length_histogram, xed::string_stats::length_buckets) == 1);
+    XED_CHECK(stats.usage_histogram[8] == 1);
+    XED_CHECK(histogram_total(stats.usage_histogram, xed::string_stats::usage_buckets) == 1);
+
+    // the same in char16_t, 11 characters inline, so 12, 18, 27, 40, 60, 90 and 135
+    // units of 2 bytes each.
+    XED_CHECK(xed::u16string::sso_capacity == 11);
+    const auto wide = stats_of([] {
+        xed::u16string s;
+        for (int i = 0; i < 100; i++)
+            s += u'a';
+        XED_CHECK(s.capacity() == 135);
+    });
+    XED_CHECK(wide.allocations == 6);
+    XED_CHECK(wide.allocated_bytes == 2 * (18 + 27 + 40 + 60 + 90 + 135));
+    XED_CHECK(wide.growths == 6);
+    XED_CHECK(wide.copied_bytes == 2 * (12 + 18 + 27 + 40 + 60 + 90));
+    XED_CHECK(wide.deallocations == 6);
+    XED_CHECK(wide.length_histogram[6] == 1);
+    // 100 of 134 is in the 70% bucket.
+    XED_CHECK(wide.usage_histogram[7] == 1);
+}
+
+// a reserve is a reallocation but not growth, and an empty heap string counts as a heap
+// string with nothing in the length histogram.
+void test_reserve() {
+    const auto stats = stats_of([] {
+        xed::string s;
+        s.reserve(1000);
+    });
+    XED_CHECK(stats.allocations == 1);
+    XED_CHECK(stats.allocated_bytes == 1000);
+    XED_CHECK(stats.reallocations == 1);
+    XED_CHECK(stats.growths == 0);
+    XED_CHECK(stats.copied_bytes == 24);
+    XED_CHECK(stats.deallocations == 1);
+    XED_CHECK(stats.heap_strings == 1);
+    XED_CHECK(histogram_total(stats.length_histogram, xed::string_stats::length_buckets) == 0);
+    XED_CHECK(stats.usage_histogram[0] == 1);
+}
+
+// copies allocate exactly, moves don't touch the heap, and the strings a move leaves
+// empty aren't counted.
+void test_copies() {
+    const char text[] = "a string that is too long for the inline buffer";
+    constexpr std::size_t length = sizeof(text) - 1;
+
+    const auto stats = stats_of([&] {
+        const xed::string original(text, length);
+        const xed::string copied(original);
+        xed::string from(text, 5);
+        const xed::string moved(xed::move(from));
+    });
+    XED_CHECK(stats.allocations == 2);
+    XED_CHECK(stats.allocated_bytes == 2 * (length + 1));
+    XED_CHECK(stats.reallocations == 0);
+    XED_CHECK(stats.copied_bytes == 2 * length + 5);
+    XED_CHECK(stats.deallocations == 2);
+    XED_CHECK(stats.heap_strings == 2);
+    XED_CHECK(stats.inline_strings == 1);
+    // 5 is in [4, 8), and both heap strings are completely full.
+    XED_CHECK(stats.length_histogram[xed::string_stats::length_bucket(length)] == 2);
+    XED_CHECK(stats.length_histogram[2] == 1);
+    XED_CHECK(stats.usage_histogram[xed::string_stats::usage_buckets - 1] == 2);
+}
+
+// another thread's strings only show up in the snapshot, also after it has exited.
+void test_threads() {
+    const auto before_thread = xed::thread_string_stats();
+    const auto before = xed::string_stats_snapshot();
+    std::thread([] {
+        xed::string s;
+        s.reserve(100);
+    }).join();
+    const auto thread = xed::thread_string_stats() - before_thread;
+    const auto all = xed::string_stats_snapshot() - before;
+
+    XED_CHECK(thread.allocations == 0);
+    XED_CHECK(all.allocations == 1);
+    XED_CHECK(all.allocated_bytes == 100);
+    XED_CHECK(all.deallocations == 1);
+    XED_CHECK(all.heap_strings == 1);
+}
+
+} // namespace
+
+int main() {
+    XED_CHECK(xed::string_stats_enabled);
+    test_appends();
+    test_reserve();
+    test_copies();
+    test_threads();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "utf.hpp"
+
+// utf-8, utf-16 and utf-32 against encoders written out plainly here: every conversion
+// and length function on random text, from pure ascii to all four utf-8 lengths mixed,
+// at lengths that end inside and past the vector blocks. then ill formed input, the
+// sequences the standard names put at every offset of an ascii run and random bytes
+// broken in random text, where find_invalid_utf8 has to agree with the scalar pass and
+// the conversions have to throw. built a second time with avx2 when that is off, so
+// the avx2 validator and transcoder get checked as well as the sse2 and scalar ones.
+
+namespace {
+
+int failures = 0;
+
+#define XED_CHECK(condition)                                                         \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+std::uint64_t next(std::uint64_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+void encode(char32_t code, std::u8string& out) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char8_t>(code));
+    }
+    else if (code < 0x800) {
+        out.push_back(static_cast<char8_t>(0xc0 | code >> 6));
+        out.push_back(static_cast<char8_t>(0x80 | (code & 0x3f)));
+    }
+    else if (code < 0x10000) {
+        out.push_back(static_cast<char8_t>(0xe0 | code >> 12));
+        out.push_back(static_cast<char8_t>(0x80 | (code >> 6 & 0x3f)));
+        out.push_back(static_cast<char8_t>(0x80 | (code & 0x3f)));
+    }
+    else {
+        out.push_back(static_cast<char8_t>(0xf0 | code >> 18));
+        out.push_back(static_cast<char8_t>(0x80 | (code >> 12 & 0x3f)));
+        out.push_back(static_cast<char8_t>(0x80 | (code >> 6 & 0x3f)));
+        out.push_back(static_cast<char8_t>(0x80 | (code & 0x3f)));
+    }
+}
+
+void encode(char32_t code, std::u16string& out) {
+    if (code < 0x10000) {
+        out.push_back(static_cast<char16_t>(code));
+    }
+    else {
+        out.push_back(static_cast<char16_t>(0xd800 + ((code - 0x10000) >> 10)));
+        out.push_back(static_cast<char16_t>(0xdc00 + ((code - 0x10000) & 0x3ff)));
+    }
+}
+
+// one code point, of a utf-8 length picked by `mix`: bit n set allows n + 1 bytes.
+char32_t random_code(unsigned mix, std::uint64_t& seed) {
+    for (;;) {
+        const auto bytes = next(seed) % 4;
+        if ((mix >> bytes & 1) == 0)
+            continue;
+        switch (bytes) {
+        case 0:
+            return static_cast<char32_t>(next(seed) % 0x80);
+        case 1:
+            return static_cast<char32_t>(0x80 + next(seed) % (0x800 - 0x80));
+        case 2: {
+            const auto code = static_cast<char32_t>(0x800 + next(seed) % (0x10000 - 0x800));
+            if (code >= 0xd800 && code < 0xe000)
+                continue;
+            return code;
+        }
+        default:
+            return static_cast<char32_t>(0x10000 + next(seed) % (0x110000 - 0x10000));
+        }
+    }
+}
+
+template<typename CharType>
+xed::basic_string_view<CharType> view(const std::basic_string<CharType>& str) {
+    return { str.data(), str.size() };
+}
+
+template<typename CharType>
+std::basic_string<CharType> standard(const xed::basic_string<CharType>& str) {
+    return { str.data(), str.length() };
+}
+
+// the offset of the first ill formed sequence going by the scalar pass, which the
+// vector ones have to agree with.
+std::size_t scalar_invalid(const std::u8string& str) {
+    return xed::details::find_invalid_utf8_scalar(reinterpret_cast<const xed::details::byte_type*>(str.data()), str.size());
+}
+
+// whether fn throws the std::range_error bad input gets.
+template<typename Fn>
+bool throws_range_error(Fn&& fn) {
+    try {
+        fn();
+    }
+    catch (const std::range_error&) {
+        return true;
+    }
+    return false;
+}
+
+void check_valid(const std::u32string& codes) {
+    std::u8string utf8;
+    std::u16string utf16;
+    for (const auto code : codes) {
+        encode(code, utf8);
+        encode(code, utf16);
+    }
+
+    XED_CHECK(xed::find_invalid_utf8(view(utf8)) == npos);
+    XED_CHECK(scalar_invalid(utf8) == npos);
+    XED_CHECK(xed::is_valid_utf16(view(utf16)));
+    XED_CHECK(xed::is_valid_utf32(view(codes)));
+
+    XED_CHECK(xed::utf16_length(view(utf8)) == utf16.size());
+    XED_CHECK(xed::utf32_length(view(utf8)) == codes.size());
+    XED_CHECK(xed::utf8_length(view(utf16)) == utf8.size());
+    XED_CHECK(xed::utf8_length(view(codes)) == utf8.size());
+    XED_CHECK(xed::utf16_length(view(codes)) == utf16.size());
+    XED_CHECK(xed::utf32_length(view(utf16)) == codes.size());
+
+    XED_CHECK(standard(xed::to_utf16(view(utf8))) == utf16);
+    XED_CHECK(standard(xed::to_utf32(view(utf8))) == codes);
+    XED_CHECK(standard(xed::to_utf8(view(utf16))) == utf8);
+    XED_CHECK(standard(xed::to_utf8(view(codes))) == utf8);
+    XED_CHECK(standard(xed::to_utf16(view(codes))) == utf16);
+    XED_CHECK(standard(xed::to_utf32(view(utf16))) == codes);
+
+    // the plain string overloads, and into a string that already holds something.
+    const xed::string_view chars(reinterpret_cast<const char*>(utf8.data()), utf8.size());
+    xed::u16string out(u"something longer than the inline buffer", 39);
+    xed::to_utf16(chars, out);
+    XED_CHECK(standard(out) == utf16);
+    XED_CHECK(standard(xed::to_utf32(chars)) == codes);
+}
+
+void test_valid() {
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    // ascii only, up to 2 bytes, up to 3, all four, and no ascii at all.
+    const unsigned mixes[] = { 0x1, 0x3, 0x7, 0xf, 0xe, 0x8 };
+    for (const auto mix : mixes) {
+        // past a few 64 byte windows and tails of every length before that.
+        for (std::size_t length = 0; length < 200; length++) {
+            std::u32string codes;
+            for (std::size_t i = 0; i < length; i++)
+                codes.push_back(random_code(mix, seed));
+            check_valid(codes);
+        }
+        for (int round = 0; round < 20; round++) {
+            std::u32string codes;
+            for (auto length = 1000 + next(seed) % 3000; length != 0; length--)
+                codes.push_back(random_code(mix, seed));
+            check_valid(codes);
+        }
+    }
+
+    // long ascii runs broken up by single other characters, at every offset of a block.
+    for (std::size_t at = 0; at < 70; at++) {
+        std::u32string codes(100, U'a');
+        codes[at] = random_code(0xe, seed);
+        check_valid(codes);
+    }
+
+    // the edges of each length and of the surrogate range.
+    check_valid({ 0x0, 0x7f, 0x80, 0x7ff, 0x800, 0xd7ff, 0xe000, 0xfffd, 0xffff, 0x10000, 0x10ffff });
+}
+
+void check_invalid(const std::u8string& str, std::size_t expected, int line) {
+    const auto found = xed::find_invalid_utf8(view(str));
+    if (found != expected || scalar_invalid(str) != expected) {
+        std::fprintf(stderr, "%s:%d: failed: invalid at %zu and %zu by the scalar pass, expected %zu (length %zu)\n",
+            __FILE__, line, found, scalar_invalid(str), expected, str.size());
+        failures++;
+    }
+    XED_CHECK(!xed::is_valid_utf8(view(str)));
+
+    xed::u16string out16;
+    xed::u32string out32;
+    XED_CHECK(throws_range_error([&] { xed::to_utf16(view(str), out16); }));
+    XED_CHECK(throws_range_error([&] { xed::to_utf32(view(str), out32); }));
+}
+
+#define XED_CHECK_INVALID(str, expected) check_invalid((str), (expected), __LINE__)
+
+void test_invalid_utf8() {
+    // overlong forms, surrogates, past U+10FFFF, bytes that never appear, a stray
+    // continuation and sequences cut short, by another lead or by the end.
+    const std::u8string sequences[] = {
+        u8"\xc0\x80", u8"\xc1\xbf", u8"\xe0\x80\x80", u8"\xe0\x9f\xbf", u8"\xf0\x80\x80\x80", u8"\xf0\x8f\xbf\xbf",
+        u8"\xed\xa0\x80", u8"\xed\xbf\xbf",
+        u8"\xf4\x90\x80\x80", u8"\xf5\x80\x80\x80", u8"\xf7\xbf\xbf\xbf",
+        u8"\xf8", u8"\xfe", u8"\xff",
+        u8"\x80", u8"\xbf",
+        u8"\xc2", u8"\xe2\x82", u8"\xf0\x9f\x98", u8"\xc2\xc2\x80", u8"\xe2\x82\x41",
+    };
+    for (const auto& sequence : sequences) {
+        for (std::size_t at = 0; at < 70; at++) {
+            // in a run of ascii, and after some of each length, so it lines up with
+            // every position of a block and comes after multi byte characters too.
+            auto str = std::u8string(at, u8'a') + sequence + std::u8string(40, u8'b');
+            XED_CHECK_INVALID(str, at);
+            auto end = std::u8string(at, u8'a') + sequence;
+            XED_CHECK_INVALID(end, at);
+            const std::u8string mixed = u8"é€\U0001f600";
+            XED_CHECK_INVALID(mixed + str, mixed.size() + at);
+        }
+    }
+
+    // one random byte changed in valid text, the scalar pass says whether and where
+    // that broke it.
+    std::uint64_t seed = 0x2545f4914f6cdd1dull;
+    for (int round = 0; round < 3000; round++) {
+        std::u8string str;
+        for (auto length = next(seed) % 300; length != 0; length--)
+            encode(random_code(round % 2 == 0 ? 0xf : 0x9, seed), str);
+        if (str.empty())
+            continue;
+        str[next(seed) % str.size()] = static_cast<char8_t>(next(seed));
+        const auto expected = scalar_invalid(str);
+        if (expected != npos)
+            XED_CHECK_INVALID(str, expected);
+        else
+            XED_CHECK(xed::find_invalid_utf8(view(str)) == npos);
+    }
+}
+
+void test_invalid_utf16_32() {
+    const std::u16string bad16[] = {
+        std::u16string(1, 0xd800), std::u16string(1, 0xdc00), std::u16string{ 0xdc00, 0xd800 },
+        std::u16string{ 0xd800, u'a' }, std::u16string{ 0xdbff, 0xdbff, 0xdc00 },
+    };
+    for (const auto& bad : bad16) {
+        for (std::size_t at = 0; at < 20; at++) {
+            const auto str = std::u16string(at, u'a') + bad + std::u16string(at % 3, u'b');
+            XED_CHECK(!xed::is_valid_utf16(view(str)));
+            xed::u8string out8;
+            xed::u32string out32;
+            XED_CHECK(throws_range_error([&] { xed::to_utf8(view(str), out8); }));
+            XED_CHECK(throws_range_error([&] { xed::to_utf32(view(str), out32); }));
+        }
+    }
+
+    const char32_t bad32[] = { 0xd800, 0xdfff, 0x110000, 0xffffffff };
+    for (const auto bad : bad32) {
+        for (std::size_t at = 0; at < 20; at++) {
+            auto str = std::u32string(at + 1, U'a');
+            str[at] = bad;
+            XED_CHECK(!xed::is_valid_utf32(view(str)));
+            xed::u8string out8;
+            xed::u16string out16;
+            XED_CHECK(throws_range_error([&] { xed::to_utf8(view(str), out8); }));
+            XED_CHECK(throws_range_error([&] { xed::to_utf16(view(str), out16); }));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+#if defined(__AVX2__) && defined(__GNUC__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::puts("skipped, this machine has no avx2");
+        return 77;
+    }
+#endif
+    test_valid();
+    test_invalid_utf8();
+    test_invalid_utf16_32();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}